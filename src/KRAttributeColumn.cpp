@@ -0,0 +1,84 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#include "KRAttributeColumn.h"
+
+KRAttributeColumn::KRAttributeColumn()
+{
+	nAttributeType = KWType::Unknown;
+}
+
+KRAttributeColumn::~KRAttributeColumn()
+{
+	Clean();
+}
+
+void KRAttributeColumn::Initialize(const KWAttribute* attribute)
+{
+	require(attribute != NULL);
+	require(attribute->GetType() == KWType::Continuous or attribute->GetType() == KWType::Symbol);
+	require(attribute->GetLoaded());
+
+	Clean();
+	sAttributeName = attribute->GetName();
+	nAttributeType = attribute->GetType();
+	liLoadIndex = attribute->GetLoadIndex();
+}
+
+const ALString& KRAttributeColumn::GetAttributeName() const
+{
+	return sAttributeName;
+}
+
+int KRAttributeColumn::GetAttributeType() const
+{
+	return nAttributeType;
+}
+
+void KRAttributeColumn::AddObjectValue(const KWObject* kwoObject)
+{
+	Symbol sValue;
+	IntObject* ioValueCode;
+
+	require(kwoObject != NULL);
+	require(nAttributeType == KWType::Continuous or nAttributeType == KWType::Symbol);
+
+	// Cas Continuous: memorisation de la valeur
+	if (nAttributeType == KWType::Continuous)
+		cvValues.Add(kwoObject->GetContinuousValueAt(liLoadIndex));
+	// Cas Symbol: memorisation du code de la valeur, avec creation d'un code a la premiere apparition
+	else
+	{
+		sValue = kwoObject->GetSymbolValueAt(liLoadIndex);
+		ioValueCode = cast(IntObject*, nkdSymbolCodes.Lookup((NUMERIC)sValue.GetNumericKey()));
+		if (ioValueCode == NULL)
+		{
+			ioValueCode = new IntObject;
+			ioValueCode->SetInt(svSymbolValues.GetSize());
+			nkdSymbolCodes.SetAt((NUMERIC)sValue.GetNumericKey(), ioValueCode);
+			svSymbolValues.Add(sValue);
+		}
+		ivSymbolCodes.Add(ioValueCode->GetInt());
+	}
+}
+
+int KRAttributeColumn::GetSymbolValueNumber() const
+{
+	require(nAttributeType == KWType::Symbol);
+	return svSymbolValues.GetSize();
+}
+
+Symbol KRAttributeColumn::GetSymbolValueAt(int nCode) const
+{
+	require(nAttributeType == KWType::Symbol);
+	return svSymbolValues.GetAt(nCode);
+}
+
+void KRAttributeColumn::Clean()
+{
+	cvValues.SetSize(0);
+	ivSymbolCodes.SetSize(0);
+	svSymbolValues.SetSize(0);
+	nkdSymbolCodes.DeleteAll();
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#ifndef KRATTRIBUTECOLUMN_H
+#define KRATTRIBUTECOLUMN_H
+
+#include "Object.h"
+#include "Vector.h"
+#include "KWType.h"
+#include "KWSymbol.h"
+#include "KWObject.h"
+
+////////////////////////////////////////////////////////////////////
+// Classe KRAttributeColumn
+// Colonne des valeurs d'un attribut Continuous ou Symbol, indexee par le rang des objets (cf. KRObjectCounters)
+// La colonne est alimentee objet par objet lors de la lecture de la base, ce qui permet de detruire chaque
+// objet des sa lecture: l'optimisation des regles n'exploite que les colonnes, sans conserver les KWObject
+// Les valeurs Symbol sont codees par leur ordre de premiere apparition, avec la table des valeurs par code
+class KRAttributeColumn : public Object
+{
+public:
+	// Constructeur
+	KRAttributeColumn();
+	~KRAttributeColumn();
+
+	// Initialisation d'une colonne vide pour un attribut charge en memoire, de type Continuous ou Symbol
+	void Initialize(const KWAttribute* attribute);
+
+	// Nom et type de l'attribut
+	const ALString& GetAttributeName() const;
+	int GetAttributeType() const;
+
+	// Ajout de la valeur de l'attribut d'un objet lu, au rang suivant
+	void AddObjectValue(const KWObject* kwoObject);
+
+	// Nombre d'objets
+	int GetObjectNumber() const;
+
+	// Valeur d'un objet de rang donne (attribut Continuous)
+	Continuous GetContinuousValueAt(int nRank) const;
+
+	// Code de la valeur d'un objet de rang donne (attribut Symbol)
+	int GetSymbolCodeAt(int nRank) const;
+
+	// Nombre de valeurs distinctes, et valeur d'un code donne (attribut Symbol)
+	int GetSymbolValueNumber() const;
+	Symbol GetSymbolValueAt(int nCode) const;
+
+	// Destruction des valeurs
+	void Clean();
+
+	///////////////////////////////////////////////////////
+	///// Implementation
+protected:
+	// Specification de l'attribut
+	ALString sAttributeName;
+	int nAttributeType;
+	KWLoadIndex liLoadIndex;
+
+	// Valeurs par rang (attribut Continuous)
+	ContinuousVector cvValues;
+
+	// Codes par rang et valeurs par code (attribut Symbol), et code de chaque valeur pendant la lecture
+	IntVector ivSymbolCodes;
+	SymbolVector svSymbolValues;
+	NumericKeyDictionary nkdSymbolCodes;
+};
+
+///// Methode en inline
+
+inline int KRAttributeColumn::GetObjectNumber() const
+{
+	if (nAttributeType == KWType::Continuous)
+		return cvValues.GetSize();
+	else
+		return ivSymbolCodes.GetSize();
+}
+
+inline Continuous KRAttributeColumn::GetContinuousValueAt(int nRank) const
+{
+	require(nAttributeType == KWType::Continuous);
+	return cvValues.GetAt(nRank);
+}
+
+inline int KRAttributeColumn::GetSymbolCodeAt(int nRank) const
+{
+	require(nAttributeType == KWType::Symbol);
+	return ivSymbolCodes.GetAt(nRank);
+}
+
+#endif // KRATTRIBUTECOLUMN_H
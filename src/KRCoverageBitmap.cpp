@@ -0,0 +1,113 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#include "KRCoverageBitmap.h"
+
+KRCoverageBitmap::KRCoverageBitmap()
+{
+	pullWords = NULL;
+	nWordNumber = 0;
+	nSize = 0;
+}
+
+KRCoverageBitmap::~KRCoverageBitmap()
+{
+	if (pullWords != NULL)
+		delete[] pullWords;
+}
+
+void KRCoverageBitmap::SetSize(int nValue)
+{
+	require(nValue >= 0);
+
+	// Reallocation des mots de bits uniquement si la taille change
+	if (nValue != nSize or (pullWords == NULL and nValue > 0))
+	{
+		if (pullWords != NULL)
+			delete[] pullWords;
+		pullWords = NULL;
+		nSize = nValue;
+		nWordNumber = (nSize + nWordBitNumber - 1) / nWordBitNumber;
+		if (nWordNumber > 0)
+			pullWords = new unsigned long long[nWordNumber];
+	}
+	Reset();
+}
+
+int KRCoverageBitmap::GetSize() const
+{
+	return nSize;
+}
+
+void KRCoverageBitmap::Reset()
+{
+	if (nWordNumber > 0)
+		memset(pullWords, 0, nWordNumber * sizeof(unsigned long long));
+}
+
+void KRCoverageBitmap::CopyFrom(const KRCoverageBitmap* aSource)
+{
+	require(aSource != NULL);
+	require(aSource->GetSize() == GetSize());
+
+	if (nWordNumber > 0)
+		memcpy(pullWords, aSource->pullWords, nWordNumber * sizeof(unsigned long long));
+}
+
+void KRCoverageBitmap::SetInterval(const Continuous* pcRankValues, boolean bWithLowerBound, Continuous cLowerBound,
+				   Continuous cUpperBound)
+{
+	require(pcRankValues != NULL or nSize == 0);
+
+	KRIntervalKernel::ComputeIntervalMask(pcRankValues, nSize, bWithLowerBound, cLowerBound, cUpperBound,
+					      pullWords);
+}
+
+void KRCoverageBitmap::And(const KRCoverageBitmap* bitmap)
+{
+	int nWord;
+
+	require(bitmap != NULL);
+	require(bitmap->GetSize() == GetSize());
+
+	for (nWord = 0; nWord < nWordNumber; nWord++)
+		pullWords[nWord] &= bitmap->pullWords[nWord];
+}
+
+int KRCoverageBitmap::GetCount() const
+{
+	int nCount;
+	int nWord;
+
+	nCount = 0;
+	for (nWord = 0; nWord < nWordNumber; nWord++)
+		nCount += CountWordBits(pullWords[nWord]);
+	return nCount;
+}
+
+int KRCoverageBitmap::GetIntersectionCount(const KRCoverageBitmap* bitmap) const
+{
+	int nCount;
+	int nWord;
+
+	require(bitmap != NULL);
+	require(bitmap->GetSize() == GetSize());
+
+	nCount = 0;
+	for (nWord = 0; nWord < nWordNumber; nWord++)
+		nCount += CountWordBits(pullWords[nWord] & bitmap->pullWords[nWord]);
+	return nCount;
+}
+
+void KRCoverageBitmap::Write(ostream& ost) const
+{
+	int nRank;
+
+	ost << "Size\t" << nSize << "\tCount\t" << GetCount() << "\n";
+	for (nRank = 0; nRank < nSize; nRank++)
+	{
+		if (Contains(nRank))
+			ost << nRank << "\n";
+	}
+}
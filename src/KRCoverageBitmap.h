@@ -0,0 +1,104 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#ifndef KRCOVERAGEBITMAP_H
+#define KRCOVERAGEBITMAP_H
+
+#include "Object.h"
+#include "KRIntervalKernel.h"
+
+////////////////////////////////////////////////////////////////////
+// Classe KRCoverageBitmap
+// Ensemble d'objets indexes par leur rang (cf. KRObjectCounters), memorise sous forme de bits
+// Permet de calculer la couverture d'une regle par intersection de bitmaps de conditions,
+// et ses effectifs par classe par comptage des bits de l'intersection avec les bitmaps de classe,
+// par mots de 64 bits
+class KRCoverageBitmap : public Object
+{
+public:
+	// Constructeur
+	KRCoverageBitmap();
+	~KRCoverageBitmap();
+
+	// Nombre de rangs possibles; l'ensemble est vide apres retaillage
+	void SetSize(int nValue);
+	int GetSize() const;
+
+	// Vidage de l'ensemble
+	void Reset();
+
+	// Copie d'un ensemble de meme taille
+	void CopyFrom(const KRCoverageBitmap* aSource);
+
+	// Ajout, suppression et test d'un rang
+	void Add(int nRank);
+	void Remove(int nRank);
+	boolean Contains(int nRank) const;
+
+	// Remplacement du contenu par les rangs dont la valeur est dans un intervalle, a partir d'une colonne
+	// contigue de GetSize() valeurs par rang (cf. KRIntervalKernel)
+	void SetInterval(const Continuous* pcRankValues, boolean bWithLowerBound, Continuous cLowerBound,
+			 Continuous cUpperBound);
+
+	// Intersection avec un ensemble de meme taille
+	void And(const KRCoverageBitmap* bitmap);
+
+	// Nombre de rangs presents
+	int GetCount() const;
+
+	// Nombre de rangs presents dans l'intersection avec un ensemble de meme taille, sans la calculer
+	int GetIntersectionCount(const KRCoverageBitmap* bitmap) const;
+
+	// Affichage
+	void Write(ostream& ost) const;
+
+	///////////////////////////////////////////////////////
+	///// Implementation
+protected:
+	// Nombre de bits a 1 d'un mot
+	static int CountWordBits(unsigned long long ullWord);
+
+	// Nombre de bits par mot
+	static const int nWordBitNumber = 64;
+
+	// Mots de bits, et nombre de rangs
+	unsigned long long* pullWords;
+	int nWordNumber;
+	int nSize;
+};
+
+///// Methode en inline
+
+inline void KRCoverageBitmap::Add(int nRank)
+{
+	require(0 <= nRank and nRank < nSize);
+	pullWords[nRank / nWordBitNumber] |= (1ull << (nRank % nWordBitNumber));
+}
+
+inline void KRCoverageBitmap::Remove(int nRank)
+{
+	require(0 <= nRank and nRank < nSize);
+	pullWords[nRank / nWordBitNumber] &= ~(1ull << (nRank % nWordBitNumber));
+}
+
+inline boolean KRCoverageBitmap::Contains(int nRank) const
+{
+	require(0 <= nRank and nRank < nSize);
+	return (pullWords[nRank / nWordBitNumber] & (1ull << (nRank % nWordBitNumber))) != 0;
+}
+
+inline int KRCoverageBitmap::CountWordBits(unsigned long long ullWord)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(ullWord);
+#else
+	// Comptage par blocs de bits, portable
+	ullWord = ullWord - ((ullWord >> 1) & 0x5555555555555555ull);
+	ullWord = (ullWord & 0x3333333333333333ull) + ((ullWord >> 2) & 0x3333333333333333ull);
+	ullWord = (ullWord + (ullWord >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return (int)((ullWord * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+#endif // KRCOVERAGEBITMAP_H
@@ -0,0 +1,128 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#include "KRIntervalKernel.h"
+
+#ifdef KR_INTERVAL_KERNEL_AVX2
+#include <immintrin.h>
+#endif // KR_INTERVAL_KERNEL_AVX2
+
+boolean KRIntervalKernel::bScalarForced = false;
+
+void KRIntervalKernel::ComputeIntervalMask(const Continuous* pcValues, int nValueNumber, boolean bWithLowerBound,
+					   Continuous cLowerBound, Continuous cUpperBound, unsigned long long* pullMask)
+{
+	int nWord;
+	int nFullWordNumber;
+	boolean bAvx2;
+
+	require(pcValues != NULL or nValueNumber == 0);
+	require(nValueNumber >= 0);
+	require(pullMask != NULL or nValueNumber == 0);
+
+	// Mots complets, avec l'implementation choisie une seule fois
+	bAvx2 = IsAvx2Used();
+	nFullWordNumber = nValueNumber / nWordBitNumber;
+	for (nWord = 0; nWord < nFullWordNumber; nWord++)
+	{
+#ifdef KR_INTERVAL_KERNEL_AVX2
+		if (bAvx2)
+		{
+			pullMask[nWord] = ComputeAvx2MaskWord(&pcValues[nWord * nWordBitNumber], bWithLowerBound,
+							      cLowerBound, cUpperBound);
+			continue;
+		}
+#endif // KR_INTERVAL_KERNEL_AVX2
+		pullMask[nWord] = ComputeScalarMaskWord(&pcValues[nWord * nWordBitNumber], nWordBitNumber,
+							bWithLowerBound, cLowerBound, cUpperBound);
+	}
+
+	// Dernier mot partiel
+	if (nValueNumber % nWordBitNumber != 0)
+		pullMask[nFullWordNumber] =
+		    ComputeScalarMaskWord(&pcValues[nFullWordNumber * nWordBitNumber], nValueNumber % nWordBitNumber,
+					  bWithLowerBound, cLowerBound, cUpperBound);
+}
+
+boolean KRIntervalKernel::IsAvx2Used()
+{
+#ifdef KR_INTERVAL_KERNEL_AVX2
+	static int nAvx2Available = -1;
+
+	// Detection une seule fois du support AVX2 par le processeur
+	if (nAvx2Available == -1)
+	{
+		__builtin_cpu_init();
+		nAvx2Available = __builtin_cpu_supports("avx2") ? 1 : 0;
+	}
+	return nAvx2Available == 1 and not bScalarForced;
+#else
+	return false;
+#endif // KR_INTERVAL_KERNEL_AVX2
+}
+
+void KRIntervalKernel::SetScalarForced(boolean bValue)
+{
+	bScalarForced = bValue;
+}
+
+boolean KRIntervalKernel::GetScalarForced()
+{
+	return bScalarForced;
+}
+
+unsigned long long KRIntervalKernel::ComputeScalarMaskWord(const Continuous* pcValues, int nValueNumber,
+							   boolean bWithLowerBound, Continuous cLowerBound,
+							   Continuous cUpperBound)
+{
+	unsigned long long ullWord;
+	int nBit;
+	int nWithoutLowerBound;
+	Continuous cValue;
+
+	require(0 <= nValueNumber and nValueNumber <= nWordBitNumber);
+
+	// Evaluation sans branchement du predicat, pour chaque valeur
+	// Sans borne inf, le test de la borne inf est toujours vrai (valeurs manquantes comprises)
+	nWithoutLowerBound = bWithLowerBound ? 0 : 1;
+	ullWord = 0;
+	for (nBit = 0; nBit < nValueNumber; nBit++)
+	{
+		cValue = pcValues[nBit];
+		ullWord |= (unsigned long long)((nWithoutLowerBound | (cLowerBound < cValue)) & (cValue <= cUpperBound)) << nBit;
+	}
+	return ullWord;
+}
+
+#ifdef KR_INTERVAL_KERNEL_AVX2
+__attribute__((target("avx2"))) unsigned long long KRIntervalKernel::ComputeAvx2MaskWord(const Continuous* pcValues,
+											  boolean bWithLowerBound,
+											  Continuous cLowerBound,
+											  Continuous cUpperBound)
+{
+	unsigned long long ullWord;
+	int nBlock;
+	__m256d mLower;
+	__m256d mUpper;
+	__m256d mWithoutLowerBound;
+	__m256d mValues;
+	__m256d mResult;
+
+	// Sans borne inf, le test de la borne inf est toujours vrai (valeurs manquantes comprises)
+	mLower = _mm256_set1_pd(cLowerBound);
+	mUpper = _mm256_set1_pd(cUpperBound);
+	mWithoutLowerBound = _mm256_castsi256_pd(_mm256_set1_epi64x(bWithLowerBound ? 0 : -1));
+
+	// Evaluation du predicat par blocs de 4 valeurs, 4 bits de masque par bloc
+	ullWord = 0;
+	for (nBlock = 0; nBlock < nWordBitNumber / 4; nBlock++)
+	{
+		mValues = _mm256_loadu_pd(&pcValues[nBlock * 4]);
+		mResult = _mm256_and_pd(_mm256_or_pd(mWithoutLowerBound, _mm256_cmp_pd(mLower, mValues, _CMP_LT_OQ)),
+					_mm256_cmp_pd(mValues, mUpper, _CMP_LE_OQ));
+		ullWord |= (unsigned long long)_mm256_movemask_pd(mResult) << (nBlock * 4);
+	}
+	return ullWord;
+}
+#endif // KR_INTERVAL_KERNEL_AVX2
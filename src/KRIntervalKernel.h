@@ -0,0 +1,58 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#ifndef KRINTERVALKERNEL_H
+#define KRINTERVALKERNEL_H
+
+#include "Object.h"
+#include "KWContinuous.h"
+
+// Noyau AVX2 disponible uniquement pour les compilateurs gcc/clang sur architecture x86
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KR_INTERVAL_KERNEL_AVX2
+#endif
+
+////////////////////////////////////////////////////////////////////
+// Classe KRIntervalKernel
+// Evaluation du predicat d'appartenance au corps d'un attribut numerique sur une colonne
+// contigue de valeurs: LowerBound < x <= UpperBound, ou x <= UpperBound sans borne inf
+// (valeurs manquantes comprises, cf. KRRAttribute::IsInBodyContinuous)
+// Le resultat est un masque de bits (bit i du mot i/64 pour la valeur i)
+// Une implementation AVX2 est utilisee si le processeur le permet (detection a l'execution),
+// avec une implementation scalaire sans branchement sinon
+class KRIntervalKernel : public Object
+{
+public:
+	// Calcul du masque de bits des valeurs dans l'intervalle
+	// Le tableau de mots doit contenir (nValueNumber+63)/64 mots; les bits au dela de nValueNumber sont a 0
+	static void ComputeIntervalMask(const Continuous* pcValues, int nValueNumber, boolean bWithLowerBound,
+					Continuous cLowerBound, Continuous cUpperBound, unsigned long long* pullMask);
+
+	// Indique si l'implementation AVX2 est utilisee
+	static boolean IsAvx2Used();
+
+	// Choix force de l'implementation scalaire (pour les comparaisons de performance ou le debug)
+	static void SetScalarForced(boolean bValue);
+	static boolean GetScalarForced();
+
+	///////////////////////////////////////////////////////
+	///// Implementation
+protected:
+	// Calcul d'un mot du masque pour au plus 64 valeurs, en scalaire et en AVX2
+	static unsigned long long ComputeScalarMaskWord(const Continuous* pcValues, int nValueNumber,
+							boolean bWithLowerBound, Continuous cLowerBound,
+							Continuous cUpperBound);
+#ifdef KR_INTERVAL_KERNEL_AVX2
+	static unsigned long long ComputeAvx2MaskWord(const Continuous* pcValues, boolean bWithLowerBound,
+						      Continuous cLowerBound, Continuous cUpperBound);
+#endif // KR_INTERVAL_KERNEL_AVX2
+
+	// Nombre de valeurs par mot du masque
+	static const int nWordBitNumber = 64;
+
+	// Choix force de l'implementation scalaire
+	static boolean bScalarForced;
+};
+
+#endif // KRINTERVALKERNEL_H
@@ -24,6 +24,9 @@ void KRLearningProject::OpenLearningEnvironnement() {
   // Enregistrement de la regle de derivation pour PredictorRule
   KWDerivationRule::RegisterDerivationRule(new KRDRPredictorRule);
 
+  // Enregistrement de la tache parallele de pretraitement des attributs
+  PLParallelTask::RegisterTask(new KRPreprocessingTask);
+
   // Enregistrement des regles specifiques eventuelles
 }
 
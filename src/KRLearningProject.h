@@ -10,6 +10,7 @@
 #include "KRLearningProblemView.h"
 #include "KRPredictorRule.h"
 #include "KRPredictorRuleView.h"
+#include "KRPreprocessingTask.h"
 
 // Service de lancement du projet Khiops
 class KRLearningProject : public KWLearningProject
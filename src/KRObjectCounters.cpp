@@ -7,89 +7,62 @@
 
 KRObjectCounters::KRObjectCounters()
 {
+	pnBodyCounts = NULL;
+	nCounterNumber = 0;
 }
 
 
 KRObjectCounters::~KRObjectCounters()
 {
 	// Destruction des compteurs
-	nkdObjectCounters.DeleteAll();
+	CleanObjects();
 }
 
 
-void KRObjectCounters::InitializeObjects(ObjectArray* oaObjects)
+void KRObjectCounters::Initialize(int nObjectNumber)
 {
-	int nObject;
-	KWObject* kwoObject;
-	IntObject* ioCounter;
-
-	require(oaObjects != NULL);
+	require(nObjectNumber >= 0);
 
 	// Nettoyage prealable
 	CleanObjects();
 
-	// Parcours des objets pour cree les compteurs
-	for (nObject = 0; nObject < oaObjects->GetSize(); nObject++)
+	// Creation des compteurs, tous a zero, un par objet
+	nCounterNumber = nObjectNumber;
+	if (nCounterNumber > 0)
 	{
-		kwoObject = cast(KWObject*, oaObjects->GetAt(nObject));
-		check(kwoObject);
-
-		// Creation et memorisation d'un compteur
-		ioCounter = new IntObject;
-		assert(nkdObjectCounters.Lookup((NUMERIC)kwoObject) == NULL);
-		nkdObjectCounters.SetAt((NUMERIC)kwoObject, ioCounter);
+		pnBodyCounts = new int[nCounterNumber];
+		ResetCounters();
 	}
-	ensure(nkdObjectCounters.GetCount() == oaObjects->GetSize());
 }
 
 
 void KRObjectCounters::CleanObjects()
 {
-	nkdObjectCounters.DeleteAll();
-	//nkdObjectCounters.RemoveAll();
+	if (pnBodyCounts != NULL)
+		delete[] pnBodyCounts;
+	pnBodyCounts = NULL;
+	nCounterNumber = 0;
 }
 
 
 void KRObjectCounters::ResetCounters()
 {
-	POSITION position;
-	NUMERIC rKey;
-	Object* oElement;
-	IntObject* ioCounter;
-	int i;//DDDDDD
-	//require(nkdObjectCounters.Check());
-
-	// Parcours des objers du dictionnaire  pour remetter tous les compteurs a zero
-	i = 0;
-	position = nkdObjectCounters.GetStartPosition();
-	while (position != NULL)
-	{
-		nkdObjectCounters.GetNextAssoc(position, rKey, oElement);
-		ioCounter = cast(IntObject*, oElement);
-		ioCounter->SetInt(0);
-		i++;
-	}
+	// Remise a zero de tous les compteurs en un seul bloc
+	if (nCounterNumber > 0)
+		memset(pnBodyCounts, 0, nCounterNumber * sizeof(int));
 }
 
 
 void KRObjectCounters::Write(ostream& ost) const
 {
-	POSITION position;
-	NUMERIC rKey;
-	Object* oElement;
-	IntObject* ioCounter;
 	IntVector ivCounterObjectNumbers;
+	int nRank;
 	int nCount;
 
-	// Parcours des objers du dictionnaire  pour remetter tous les compteurs a zero
-	position = nkdObjectCounters.GetStartPosition();
-	while (position != NULL)
+	// Parcours des compteurs pour calculer le nombre d'objets par compte
+	for (nRank = 0; nRank < nCounterNumber; nRank++)
 	{
-		nkdObjectCounters.GetNextAssoc(position, rKey, oElement);
-		ioCounter = cast(IntObject*, oElement);
-
-		// Mise a jour du nombre d'objets pour ce compte
-		nCount = ioCounter->GetInt();
+		nCount = pnBodyCounts[nRank];
 		assert(nCount >= 0);
 
 		// Mise a jour de la taille du vecteur memorisants els nombre d'objets par compte
@@ -6,14 +6,17 @@
 #define KROBJECTCOUNTERS_H
 
 #include "Object.h"
-#include "KWObject.h"
+#include "Vector.h"
 
 
 ////////////////////////////////////////////////////////////////////
 // Classe KRObjectCounters
-// Gestionnaire d'un compteur par KWObject d'une base
+// Gestionnaire d'un compteur par objet d'une base
 // Permet dans le cas de l'optimisation des regles de gerer un compteur
 // par nombre de participatiuon au corps d'une regle
+// Les compteurs sont memorises dans un tableau contigu, indexe par le rang de chaque objet,
+// qui est sa position dans l'ordre de lecture de la base (de 0 au nombre d'objets moins un)
+// Les objets eux-memes ne sont pas conserves: leurs valeurs sont memorisees par rang (cf. KRAttributeColumn)
 class KRObjectCounters : public Object
 {
 public:
@@ -21,23 +24,23 @@ public:
 	KRObjectCounters();
 	~KRObjectCounters();
 
-	// Initialisation a partir d'une tableau de KWObjects
-	// Tous les KWObjects sont declare, avec leur compteur a 0
-	void InitializeObjects(ObjectArray* oaObjects);
+	// Initialisation pour un nombre d'objets donne, avec tous les compteurs a 0
+	void Initialize(int nObjectNumber);
 
-	// Nettoyage, supression des KWObject
+	// Nettoyage, supression des compteurs
 	void CleanObjects();
 
 	// Remise a zero de tous les compteurs
 	void ResetCounters();
 
-	// Acces au compteur d'un objet
-	void SetBodyCountAt(const KWObject* kwoObject, int nCount);
-	int GetBodyCountAt(const KWObject* kwoObject) const;
+	// Nombre de rangs, egal au nombre d'objets
+	// Le rang identifie un objet de facon stable, independamment des tris de la base
+	int GetRankNumber() const;
 
-	// Incrementation/decrementation d'un compteur d'objet
-	void IncrementBodyCountAt(const KWObject* kwoObject);
-	void DecrementBodyCountAt(const KWObject* kwoObject);
+	// Acces aux compteurs par rang d'objet
+	int GetBodyCountAtRank(int nRank) const;
+	void IncrementBodyCountAtRank(int nRank);
+	void DecrementBodyCountAtRank(int nRank);
 
 	// Affichage: Nombre d'objet pour chaque valeur de compte
 	void Write(ostream& ost) const;
@@ -45,69 +48,39 @@ public:
 	///////////////////////////////////////////////////////
 	///// Implementation
 protected:
-	// Dictionnaire des compteurs
-	//  cle: un KWObject (cle numerique)
-	//  objet accede: IntObject pour memoriser un compte
-	NumericKeyDictionary nkdObjectCounters;
+	// Tableau des compteurs, indexe par le rang des objets
+	// Les rangs etant denses, le tableau a exactement un compteur par objet, y compris en cas
+	// d'echantillonnage de la base
+	int* pnBodyCounts;
+	int nCounterNumber;
 };
 
 
 ///// Methode en inline
 
-inline void KRObjectCounters::SetBodyCountAt(const KWObject* kwoObject, int nCount)
+inline int KRObjectCounters::GetRankNumber() const
 {
-	IntObject* ioCounter;
-
-	require(kwoObject != NULL);
-	require(nkdObjectCounters.Lookup((NUMERIC)kwoObject) != NULL);
-	require(nCount >= 0);
-
-	// Acces au compteur et modification
-	ioCounter = cast(IntObject*, nkdObjectCounters.Lookup((NUMERIC)kwoObject));
-	ioCounter->SetInt(nCount);
+	return nCounterNumber;
 }
 
-inline int KRObjectCounters::GetBodyCountAt(const KWObject* kwoObject) const
+inline int KRObjectCounters::GetBodyCountAtRank(int nRank) const
 {
-	IntObject* ioCounter;
-
-	require(kwoObject != NULL);
-	require(nkdObjectCounters.Lookup((NUMERIC)kwoObject) != NULL);
-
-	// Acces au compteur et modification
-	ioCounter = cast(IntObject*, nkdObjectCounters.Lookup((NUMERIC)kwoObject));
-	ensure(ioCounter->GetInt() >= 0);
-	return ioCounter->GetInt();
+	require(0 <= nRank and nRank < nCounterNumber);
+	return pnBodyCounts[nRank];
 }
 
-inline void KRObjectCounters::IncrementBodyCountAt(const KWObject* kwoObject)
+inline void KRObjectCounters::IncrementBodyCountAtRank(int nRank)
 {
-	IntObject* ioCounter;
-
-	require(kwoObject != NULL);
-	require(nkdObjectCounters.Lookup((NUMERIC)kwoObject) != NULL);
-
-	// Acces au compteur et modification
-	ioCounter = cast(IntObject*, nkdObjectCounters.Lookup((NUMERIC)kwoObject));
-	ensure(ioCounter->GetInt() >= 0);
-	ioCounter->SetInt(ioCounter->GetInt() + 1);
+	require(0 <= nRank and nRank < nCounterNumber);
+	assert(pnBodyCounts[nRank] >= 0);
+	pnBodyCounts[nRank]++;
 }
 
-inline void KRObjectCounters::DecrementBodyCountAt(const KWObject* kwoObject)
+inline void KRObjectCounters::DecrementBodyCountAtRank(int nRank)
 {
-	IntObject* ioCounter;
-
-	require(kwoObject != NULL);
-	require(nkdObjectCounters.Lookup((NUMERIC)kwoObject) != NULL);
-
-	// Acces au compteur et modification
-	ioCounter = cast(IntObject*, nkdObjectCounters.Lookup((NUMERIC)kwoObject));
-	ensure(ioCounter->GetInt() >= 1);
-	ioCounter->SetInt(ioCounter->GetInt() - 1);
+	require(0 <= nRank and nRank < nCounterNumber);
+	assert(pnBodyCounts[nRank] >= 1);
+	pnBodyCounts[nRank]--;
 }
 
-
-
-
-
 #endif // KROBJECTCOUNTERS_H
@@ -298,6 +298,7 @@ boolean KRPredictorRule::InternalTrain()
 	KRRuleOptimizer ruleOptimizer;
 	ObjectArray oaRuleSet;
 	KRRuleCosts* costs;
+	boolean bOk;
 
 	require(Check());
 	require(GetClassStats() != NULL);
@@ -310,15 +311,14 @@ boolean KRPredictorRule::InternalTrain()
 	// Apprentissage si au moins une valeur cible
 	if (GetTargetDescriptiveStats()->GetValueNumber() > 0)
 	{
-		//lecture de la base
-		kwdb = GetDatabase();
-		kwdb->ReadAll();
-		ensure(kwdb->ReadAll());
-
 		//GetRuleParameters()->Write(cout);
 		// Parametrage du RuleOptimizer
 		ruleOptimizer.SetMaxRuleNumber(GetRuleParameters()->GetMaxRuleNumber());
 		ruleOptimizer.SetTimeAllowed(GetRuleParameters()->GetTimeAllowed());
+		ruleOptimizer.SetOptimizationSampleSize(GetRuleParameters()->GetOptimizationSampleSize());
+		ruleOptimizer.SetBoundaryCandidateGranularity(GetRuleParameters()->GetBoundaryCandidateGranularity());
+		ruleOptimizer.SetUnivariateInitialization(GetRuleParameters()->GetUnivariateInitialization());
+		ruleOptimizer.SetPreprocessingCacheDirectory(GetRuleParameters()->GetPreprocessingCacheDirectory());
 		//ruleOptimizer.SetMaxRuleNumber(10);
 		ruleOptimizer.SetClassStats(GetClassStats());
 		costs = NULL;
@@ -330,13 +330,20 @@ boolean KRPredictorRule::InternalTrain()
 		costs->SetClassStats(GetClassStats());
 		ruleOptimizer.SetRuleCosts(costs);
 
-		// Pretraitement necessaire a l'optimisation
-		ruleOptimizer.Preprocess(kwdb);
+		// Pretraitement necessaire a l'optimisation, avec lecture de la base en une seule passe
+		// Les objets lus ne sont pas conserves: seules leurs valeurs sont memorisees par attribut
+		kwdb = GetDatabase();
+		bOk = ruleOptimizer.Preprocess(kwdb);
+		if (not bOk)
+		{
+			delete costs;
+			return false;
+		}
 		//ruleOptimizer.WritePreprocessing(cout);
 
 		// Optimisation
 		oaRuleSet.SetSize(ruleOptimizer.GetMaxRuleNumber());
-		ruleOptimizer.OptimizeRuleSet(kwdb, &oaRuleSet);
+		ruleOptimizer.OptimizeRuleSet(&oaRuleSet);
 
 		// Creation d'une classe pour l'ensemble de regles
 		ruleClass = CreateRuleSetClass(&oaRuleSet);
@@ -351,8 +358,6 @@ boolean KRPredictorRule::InternalTrain()
 		// Attention, les regles sont transferees au report
 		// et le oaRuleSet est vide a l'issue de cette methode
 		FillPredictorRuleReport(&oaRuleSet);
-
-		kwdb->DeleteAll();
 		delete costs;
 
 		// debug
@@ -3,182 +3,288 @@
 // at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
 
 #include "KRPreprocessedAttribute.h"
+#include <algorithm>
 
 ////////////////////////////////////////
-// Classe KWDatabaseSorter
+// Classe KRRankSorter
 
-KWLoadIndex KWDatabaseSorterAttributeIndex;
-
-// Fonction de comparaison de deux KWObject base sur Continuous
-int KWDatabaseSorterCompareOnContinuous(const void* elem1, const void* elem2)
+// Cle de tri d'un rang d'objet, comparee selon la cle puis selon le rang
+template <class T> struct KRRankSorterKey
 {
-	KWObject* kwoObject1;
-	KWObject* kwoObject2;
-
-	require(KWDatabaseSorterAttributeIndex.IsValid());
-
-	// Acces aux objets
-	kwoObject1 = cast(KWObject*, *(Object**)elem1);
-	kwoObject2 = cast(KWObject*, *(Object**)elem2);
+	T key;
+	int nRank;
 
-	// Comparaison
-	return KWContinuous::Compare(
-	    kwoObject1->GetContinuousValueAt(KWDatabaseSorterAttributeIndex),
-	    kwoObject2->GetContinuousValueAt(KWDatabaseSorterAttributeIndex));
-}
+	bool operator<(const KRRankSorterKey<T>& other) const
+	{
+		return key < other.key or (key == other.key and nRank < other.nRank);
+	}
+};
 
-// Fonction de comparaison de deux KWObject base sur Symbol (pointeur)
-int KWDatabaseSorterCompareOnSymbol(const void* elem1, const void* elem2)
+// Tri de rangs selon une colonne de cles par rang, par l'intermediaire d'un tableau contigu de cles
+template <class T> void KRRankSorterSortRanks(const T* pRankKeys, IntVector* ivRanks)
 {
-	KWObject* kwoObject1;
-	KWObject* kwoObject2;
+	KRRankSorterKey<T>* pSortKeys;
+	int nIndex;
 
-	require(KWDatabaseSorterAttributeIndex.IsValid());
+	require(pRankKeys != NULL or ivRanks->GetSize() == 0);
 
-	// Acces aux objets
-	kwoObject1 = cast(KWObject*, *(Object**)elem1);
-	kwoObject2 = cast(KWObject*, *(Object**)elem2);
+	// Tri des cles
+	pSortKeys = new KRRankSorterKey<T>[ivRanks->GetSize()];
+	for (nIndex = 0; nIndex < ivRanks->GetSize(); nIndex++)
+	{
+		pSortKeys[nIndex].key = pRankKeys[ivRanks->GetAt(nIndex)];
+		pSortKeys[nIndex].nRank = ivRanks->GetAt(nIndex);
+	}
+	std::sort(pSortKeys, pSortKeys + ivRanks->GetSize());
 
-	// Comparaison
-	return kwoObject1->GetSymbolValueAt(KWDatabaseSorterAttributeIndex).Compare(kwoObject2->GetSymbolValueAt(KWDatabaseSorterAttributeIndex));
+	// Recopie des rangs tries
+	for (nIndex = 0; nIndex < ivRanks->GetSize(); nIndex++)
+		ivRanks->SetAt(nIndex, pSortKeys[nIndex].nRank);
+	delete[] pSortKeys;
 }
 
-void KWDatabaseSorter::SortDatabaseObjectsOnContinuous(KWDatabase* database, const ALString& sAttributeName)
+void KRRankSorter::SortRanksOnContinuous(const Continuous* pcRankValues, IntVector* ivRanks)
 {
-	KWObject* kwoFirstObject;
-	const KWClass* kwcSortClass;
-	KWAttribute* attribute;
+	const int nDigitValueNumber = 1 << nRadixDigitBitNumber;
+	const unsigned long long ullDigitMask = nDigitValueNumber - 1;
+	int nSize;
+	int* pnRanks;
+	int* pnBufferRanks;
+	int* pnSwapRanks;
+	unsigned long long* pullKeys;
+	unsigned long long* pullBufferKeys;
+	unsigned long long* pullSwapKeys;
+	int* pnDigitPositions;
+	int nShift;
+	int nIndex;
+	int nDigit;
+	int nPosition;
+	int nCount;
+	boolean bSkipPass;
 
-	require(database->Check());
-	require(not KWDatabaseSorterAttributeIndex.IsValid());
+	require(ivRanks != NULL);
 
-	// Recherche de la classe
-	if (database->GetObjects()->GetSize() == 0)
-		return;
-	else
+	// Tri par comparaison pour les petites tailles
+	nSize = ivRanks->GetSize();
+	if (nSize < nMinLinearSortSize)
 	{
-		kwoFirstObject = cast(KWObject*, database->GetObjects()->GetAt(0));
-		assert(kwoFirstObject->Check());
-		kwcSortClass = kwoFirstObject->GetClass();
+		KRRankSorterSortRanks<Continuous>(pcRankValues, ivRanks);
+		return;
 	}
 
-	// Recherche de l'attribut et verifications
-	attribute = kwcSortClass->LookupAttribute(sAttributeName);
-	require(attribute != NULL);
-	require(attribute->GetType() == KWType::Continuous);
-	require(attribute->GetUsed());
-	require(attribute->GetLoaded());
-
-	// Parametrage de la fonction de comparaison
-	KWDatabaseSorterAttributeIndex = attribute->GetLoadIndex();
+	// Extraction des rangs en ordre croissant et de leurs cles binaires
+	pnRanks = new int[nSize];
+	pnBufferRanks = new int[nSize];
+	pullKeys = new unsigned long long[nSize];
+	pullBufferKeys = new unsigned long long[nSize];
+	pnDigitPositions = new int[nDigitValueNumber];
+	InitializeAscendingRanks(ivRanks, pnRanks);
+	for (nIndex = 0; nIndex < nSize; nIndex++)
+		pullKeys[nIndex] = ComputeContinuousSortKey(pcRankValues[pnRanks[nIndex]]);
+
+	// Tri stable par chiffre, du chiffre de poids faible au chiffre de poids fort
+	for (nShift = 0; nShift < 64; nShift += nRadixDigitBitNumber)
+	{
+		// Comptage des chiffres
+		memset(pnDigitPositions, 0, nDigitValueNumber * sizeof(int));
+		for (nIndex = 0; nIndex < nSize; nIndex++)
+			pnDigitPositions[(pullKeys[nIndex] >> nShift) & ullDigitMask]++;
+
+		// Passe inutile si toutes les cles ont le meme chiffre (cas frequent pour les chiffres de poids fort)
+		bSkipPass = pnDigitPositions[(pullKeys[0] >> nShift) & ullDigitMask] == nSize;
+		if (bSkipPass)
+			continue;
+
+		// Positions de debut par chiffre
+		nPosition = 0;
+		for (nDigit = 0; nDigit < nDigitValueNumber; nDigit++)
+		{
+			nCount = pnDigitPositions[nDigit];
+			pnDigitPositions[nDigit] = nPosition;
+			nPosition += nCount;
+		}
 
-	// Tri
-	SortObjects(database, KWDatabaseSorterCompareOnContinuous);
+		// Distribution dans les tableaux tampons, puis echange des tableaux
+		for (nIndex = 0; nIndex < nSize; nIndex++)
+		{
+			nPosition = pnDigitPositions[(pullKeys[nIndex] >> nShift) & ullDigitMask]++;
+			pullBufferKeys[nPosition] = pullKeys[nIndex];
+			pnBufferRanks[nPosition] = pnRanks[nIndex];
+		}
+		pullSwapKeys = pullKeys;
+		pullKeys = pullBufferKeys;
+		pullBufferKeys = pullSwapKeys;
+		pnSwapRanks = pnRanks;
+		pnRanks = pnBufferRanks;
+		pnBufferRanks = pnSwapRanks;
+	}
 
-	// Reinitialisation
-	KWDatabaseSorterAttributeIndex.Reset();
+	// Recopie des rangs tries
+	for (nIndex = 0; nIndex < nSize; nIndex++)
+		ivRanks->SetAt(nIndex, pnRanks[nIndex]);
+	delete[] pnRanks;
+	delete[] pnBufferRanks;
+	delete[] pullKeys;
+	delete[] pullBufferKeys;
+	delete[] pnDigitPositions;
 }
 
-void KWDatabaseSorter::SortDatabaseObjectsOnSymbol(KWDatabase* database, const ALString& sAttributeName)
+void KRRankSorter::SortRanksOnInt(const int* pnRankKeys, IntVector* ivRanks)
 {
-	KWObject* kwoFirstObject;
-	const KWClass* kwcSortClass;
-	KWAttribute* attribute;
+	int nSize;
+	int* pnRanks;
+	int* pnKeyPositions;
+	int nKeyNumber;
+	int nIndex;
+	int nKey;
+	int nPosition;
+	int nCount;
 
-	require(database->Check());
-	require(not KWDatabaseSorterAttributeIndex.IsValid());
+	require(ivRanks != NULL);
 
-	// Recherche de la classe
-	if (database->GetObjects()->GetSize() == 0)
+	// Nombre de cles distinctes possibles
+	nSize = ivRanks->GetSize();
+	nKeyNumber = 0;
+	for (nIndex = 0; nIndex < nSize; nIndex++)
+	{
+		assert(pnRankKeys[ivRanks->GetAt(nIndex)] >= 0);
+		nKeyNumber = max(nKeyNumber, pnRankKeys[ivRanks->GetAt(nIndex)] + 1);
+	}
+
+	// Tri par comparaison pour les petites tailles, ou si les cles sont trop dispersees
+	if (nSize < nMinLinearSortSize or nKeyNumber > 2 * nSize)
+	{
+		KRRankSorterSortRanks<int>(pnRankKeys, ivRanks);
 		return;
-	else
+	}
+
+	// Extraction des rangs en ordre croissant
+	pnRanks = new int[nSize];
+	InitializeAscendingRanks(ivRanks, pnRanks);
+
+	// Comptage des cles et positions de debut par cle
+	pnKeyPositions = new int[nKeyNumber];
+	memset(pnKeyPositions, 0, nKeyNumber * sizeof(int));
+	for (nIndex = 0; nIndex < nSize; nIndex++)
+		pnKeyPositions[pnRankKeys[pnRanks[nIndex]]]++;
+	nPosition = 0;
+	for (nKey = 0; nKey < nKeyNumber; nKey++)
 	{
-		kwoFirstObject = cast(KWObject*, database->GetObjects()->GetAt(0));
-		assert(kwoFirstObject->Check());
-		kwcSortClass = kwoFirstObject->GetClass();
+		nCount = pnKeyPositions[nKey];
+		pnKeyPositions[nKey] = nPosition;
+		nPosition += nCount;
 	}
 
-	// Recherche de l'attribut et verifications
-	attribute = kwcSortClass->LookupAttribute(sAttributeName);
-	require(attribute != NULL);
-	require(attribute->GetType() == KWType::Symbol);
-	require(attribute->GetUsed());
-	require(attribute->GetLoaded());
-
-	// Parametrage de la fonction de comparaison
-	KWDatabaseSorterAttributeIndex = attribute->GetLoadIndex();
-
-	// Tri
-	SortObjects(database, KWDatabaseSorterCompareOnSymbol);
-
-	// Reinitialisation
-	KWDatabaseSorterAttributeIndex.Reset();
-}
-
-void KWDatabaseSorter::SortObjects(KWDatabase* database, CompareFunction fCompare)
-{
-	SortedList sortedList(fCompare);
-	int nObject;
-	KWObject* kwoObject;
-	POSITION position;
-
-	require(database->Check());
-
-	//////////////////////////////////////////////////////////////////////
-	// On utilise une liste triee intermediaire pour effectuer le tri du
-	// tableau d'objets.
-	// En effet, la methode Sort de ObjectArray est basee sur le QuickSort
-	// (qsort) de Visual C++), qui est particulierement inefficace dans
-	// le vase de gros volumes de donnees (dans un rapport de 1 a 10 au moins).
-	// Un QuickSort efficace recupere sur internet a ete teste. Il devient
-	// vraiment competitif, legerement plus rapide que notre tri par liste triee,
-	// sans demandee de memoire pour la gestion de la liste (mais avec
-	// potentiellement beaucoup de stack pour cause de recursivite du QuickSort).
-	// En revanche, il apparait souvent en analyse de donnees que le nombre de
-	// modalite effectives soit tres inferieur au nombre d'instances a trier.
-	// Dans ce cas, l'avantage revient nettement a tri par liste, qui ne garde
-	// qu'une instance de reference par modalite, ce qui diminue de facon
-	// importante le nombre de comparaison a effectuer. On a donc, aux constantes
-	// pres, un QuickSort en N*log(N) (N: nombre d'instances, et un tri par liste
-	// en M*log(M) (M: nombre de modalites).
-	// On prefere alors le tri par liste.
-
-	// Ajout des elements dans la liste triee
-	// Le tri par la liste triee est beaucoup plus rapide
-	// que le tri par le tableau
-	for (nObject = 0; nObject < database->GetObjects()->GetSize(); nObject++)
+	// Distribution stable des rangs
+	for (nIndex = 0; nIndex < nSize; nIndex++)
 	{
-		kwoObject = cast(KWObject*, database->GetObjects()->GetAt(nObject));
-		sortedList.Add(kwoObject);
+		nPosition = pnKeyPositions[pnRankKeys[pnRanks[nIndex]]]++;
+		ivRanks->SetAt(nPosition, pnRanks[nIndex]);
 	}
+	delete[] pnRanks;
+	delete[] pnKeyPositions;
+}
 
-	// On remet les elements tries dans la liste
-	position = sortedList.GetHeadPosition();
-	nObject = 0;
-	while (position != NULL)
+void KRRankSorter::InitializeAscendingRanks(const IntVector* ivRanks, int* pnRanks)
+{
+	KRCoverageBitmap bmRanks;
+	int nRankNumber;
+	int nIndex;
+	int nRank;
+
+	require(ivRanks != NULL);
+	require(pnRanks != NULL);
+
+	// Marquage des rangs presents
+	nRankNumber = 0;
+	for (nIndex = 0; nIndex < ivRanks->GetSize(); nIndex++)
+		nRankNumber = max(nRankNumber, ivRanks->GetAt(nIndex) + 1);
+	bmRanks.SetSize(nRankNumber);
+	for (nIndex = 0; nIndex < ivRanks->GetSize(); nIndex++)
+		bmRanks.Add(ivRanks->GetAt(nIndex));
+
+	// Parcours des rangs marques dans l'ordre croissant
+	nIndex = 0;
+	for (nRank = 0; nRank < nRankNumber; nRank++)
 	{
-		kwoObject = cast(KWObject*,
-				 sortedList.GetNext(position));
-		database->GetObjects()->SetAt(nObject, kwoObject);
-		nObject++;
+		if (bmRanks.Contains(nRank))
+		{
+			pnRanks[nIndex] = nRank;
+			nIndex++;
+		}
 	}
+	ensure(nIndex == ivRanks->GetSize());
+}
+
+unsigned long long KRRankSorter::ComputeContinuousSortKey(Continuous cValue)
+{
+	unsigned long long ullBits;
+	double dValue;
+
+	assert(sizeof(Continuous) == sizeof(unsigned long long));
+
+	// Normalisation du zero negatif, egal au zero positif
+	dValue = cValue;
+	if (dValue == 0)
+		dValue = 0;
+
+	// Inversion de tous les bits des valeurs negatives, et du seul bit de signe des valeurs positives
+	memcpy(&ullBits, &dValue, sizeof(unsigned long long));
+	if (ullBits >> 63)
+		return ~ullBits;
+	else
+		return ullBits ^ (1ull << 63);
 }
 
 ////////////////////////////////////////
 // Classe KRPreprocessedAttribute
 KRPreprocessedAttribute::KRPreprocessedAttribute()
 {
+	objectCounters = NULL;
+	classStats = NULL;
 }
 
 KRPreprocessedAttribute::~KRPreprocessedAttribute()
 {
 }
 
-void KRPreprocessedAttribute::Initialize(KWDatabase* kwdb, KWAttribute* attribute)
+void KRPreprocessedAttribute::Initialize(const KRAttributeColumn* column)
+{
+	require(objectCounters != NULL);
+	require(column != NULL);
+	require(column->GetAttributeType() == GetAttributeType());
+	require(column->GetObjectNumber() == objectCounters->GetRankNumber());
+
+	sAttributeName = column->GetAttributeName();
+}
+
+boolean KRPreprocessedAttribute::InitializeFromSortOrder(const KRAttributeColumn* column, KRSortOrder* sortOrder)
+{
+	require(sortOrder != NULL);
+
+	KRPreprocessedAttribute::Initialize(column);
+	return InitializeSortedObjectRanksFromSortOrder(sortOrder);
+}
+
+void KRPreprocessedAttribute::InitializeFromSortedObjectRanks(const KRAttributeColumn* column, const IntVector* ivSortedRanks)
 {
-	sAttributeName = attribute->GetName();
-	liLoadedAttributeIndex = attribute->GetLoadIndex();
-	liLoadedTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
+	require(column != NULL);
+	require(ivSortedRanks != NULL);
+	require(ivSortedRanks->GetSize() == column->GetObjectNumber());
+
+	KRPreprocessedAttribute::Initialize(column);
+	ivSortedObjectRanks.CopyFrom(ivSortedRanks);
+}
+
+void KRPreprocessedAttribute::ExportSortOrder(KRSortOrder* sortOrder) const
+{
+	require(sortOrder != NULL);
+
+	sortOrder->SetAttributeName(sAttributeName);
+	sortOrder->SetAttributeType(GetAttributeType());
+	sortOrder->GetSortedObjectRanks()->CopyFrom(&ivSortedObjectRanks);
+	sortOrder->GetValues()->SetSize(0);
+	sortOrder->GetValueLastIndexes()->SetSize(0);
 }
 
 void KRPreprocessedAttribute::SetAttributeName(const ALString& sValue)
@@ -191,9 +297,58 @@ const ALString& KRPreprocessedAttribute::GetAttributeName() const
 	return sAttributeName;
 }
 
-ObjectArray* KRPreprocessedAttribute::GetObjects()
+void KRPreprocessedAttribute::SetObjectCounters(const KRObjectCounters* counters)
 {
-	return &oaPreSortedObjects;
+	objectCounters = counters;
+}
+
+const KRObjectCounters* KRPreprocessedAttribute::GetObjectCounters() const
+{
+	return objectCounters;
+}
+
+void KRPreprocessedAttribute::InitializeSortedObjectRanks()
+{
+	int nIndex;
+
+	require(objectCounters != NULL);
+
+	// Memorisation des rangs des objets, dans l'ordre de la base (le rang d'un objet est son index)
+	ivSortedObjectRanks.SetSize(objectCounters->GetRankNumber());
+	for (nIndex = 0; nIndex < objectCounters->GetRankNumber(); nIndex++)
+		ivSortedObjectRanks.SetAt(nIndex, nIndex);
+}
+
+boolean KRPreprocessedAttribute::InitializeSortedObjectRanksFromSortOrder(KRSortOrder* sortOrder)
+{
+	IntVector* ivRanks;
+	IntVector ivUsedRanks;
+	int nIndex;
+	int nRank;
+
+	require(objectCounters != NULL);
+	require(sortOrder != NULL);
+
+	// Verification de l'attribut et du nombre d'objets
+	ivRanks = sortOrder->GetSortedObjectRanks();
+	if (sortOrder->GetAttributeName() != sAttributeName or sortOrder->GetAttributeType() != GetAttributeType() or
+	    ivRanks->GetSize() != objectCounters->GetRankNumber())
+		return false;
+
+	// Verification que les rangs forment une permutation des rangs des objets
+	ivUsedRanks.SetSize(objectCounters->GetRankNumber());
+	ivUsedRanks.Initialize();
+	for (nIndex = 0; nIndex < ivRanks->GetSize(); nIndex++)
+	{
+		nRank = ivRanks->GetAt(nIndex);
+		if (nRank < 0 or nRank >= objectCounters->GetRankNumber() or ivUsedRanks.GetAt(nRank) != 0)
+			return false;
+		ivUsedRanks.SetAt(nRank, 1);
+	}
+
+	// Memorisation des rangs
+	ivSortedObjectRanks.CopyFrom(ivRanks);
+	return true;
 }
 
 void KRPreprocessedAttribute::SetClassStats(KWClassStats* stats)
@@ -206,8 +361,30 @@ KWClassStats* KRPreprocessedAttribute::GetClassStats() const
 	return classStats;
 }
 
+const KWDGSAttributePartition* KRPreprocessedAttribute::GetUnivariatePartition() const
+{
+	KWAttributeStats* attributeStats;
+	const KWDataGridStats* dataGridStats;
+	const KWDGSAttributePartition* partition;
+
+	// Partition du premier attribut de la grille preparee, s'il s'agit de l'attribut pretraite
+	partition = NULL;
+	attributeStats = NULL;
+	if (GetClassStats() != NULL)
+		attributeStats = GetClassStats()->LookupAttributeStats(sAttributeName);
+	if (attributeStats != NULL and attributeStats->GetPreparedDataGridStats() != NULL)
+	{
+		dataGridStats = attributeStats->GetPreparedDataGridStats();
+		if (dataGridStats->GetAttributeNumber() > 0 and dataGridStats->GetAttributeAt(0)->GetAttributeName() == sAttributeName and
+		    dataGridStats->GetAttributeAt(0)->GetAttributeType() == GetAttributeType() and
+		    not dataGridStats->GetAttributeAt(0)->ArePartsSingletons())
+			partition = dataGridStats->GetAttributeAt(0);
+	}
+	return partition;
+}
+
 void KRPreprocessedAttribute::PrepareWorkingInstances(KRRAttribute* attribute, KRRule* rule,
-						      KRObjectCounters* counters, ObjectArray* oaWorkingInstances) const
+						      KRObjectCounters* counters, IntVector* ivWorkingInstances) const
 {
 }
 
@@ -219,27 +396,88 @@ boolean KRPreprocessedAttribute::Check() const
 void KRPreprocessedAttribute::Write(ostream& ost) const
 {
 	ost << "\nAttribute Name : " << sAttributeName << endl;
-	ost << "InDB Index : " << liLoadedAttributeIndex << endl;
-	ost << "Target Attribute Index : " << liLoadedTargetAttributeIndex << endl;
 }
 
 ////////////////////////////////////////
 // Classe KRPreprocessedContinuousAttribute
 KRPreprocessedContinuousAttribute::KRPreprocessedContinuousAttribute()
 {
+	pcRankValues = NULL;
+	nRankValueNumber = 0;
 }
 
 KRPreprocessedContinuousAttribute::~KRPreprocessedContinuousAttribute()
 {
+	if (pcRankValues != NULL)
+		delete[] pcRankValues;
+}
+
+void KRPreprocessedContinuousAttribute::Initialize(const KRAttributeColumn* column)
+{
+	// appel de la methode ancetre
+	KRPreprocessedAttribute::Initialize(column);
+
+	// Tri des rangs des objets selon leur valeur, sans modifier l'ordre des objets de la base
+	InitializeSortedObjectRanks();
+	InitializeRankValues(column);
+	KRRankSorter::SortRanksOnContinuous(pcRankValues, &ivSortedObjectRanks);
+}
+
+boolean KRPreprocessedContinuousAttribute::InitializeFromSortOrder(const KRAttributeColumn* column,
+								   KRSortOrder* sortOrder)
+{
+	int nIndex;
+
+	// appel de la methode ancetre
+	if (not KRPreprocessedAttribute::InitializeFromSortOrder(column, sortOrder))
+		return false;
+	InitializeRankValues(column);
+
+	// Verification de l'ordre de tri des valeurs
+	for (nIndex = 1; nIndex < GetObjectNumber(); nIndex++)
+	{
+		if (GetValueAt(nIndex - 1) > GetValueAt(nIndex))
+			return false;
+	}
+	return true;
 }
 
-void KRPreprocessedContinuousAttribute::Initialize(KWDatabase* kwdb, KWAttribute* attribute)
+void KRPreprocessedContinuousAttribute::InitializeFromSortedObjectRanks(const KRAttributeColumn* column,
+									const IntVector* ivSortedRanks)
 {
+	debug(int nIndex);
+
 	// appel de la methode ancetre
-	KRPreprocessedAttribute::Initialize(kwdb, attribute);
+	KRPreprocessedAttribute::InitializeFromSortedObjectRanks(column, ivSortedRanks);
+	InitializeRankValues(column);
+	debug(for (nIndex = 1; nIndex < GetObjectNumber(); nIndex++) assert(GetValueAt(nIndex - 1) <= GetValueAt(nIndex)));
+}
+
+void KRPreprocessedContinuousAttribute::InitializeRankValues(const KRAttributeColumn* column)
+{
+	int nRank;
+
+	require(objectCounters != NULL);
+	require(column != NULL);
+	require(column->GetObjectNumber() == objectCounters->GetRankNumber());
+
+	// Memorisation des valeurs par rang d'objet
+	if (pcRankValues != NULL)
+		delete[] pcRankValues;
+	nRankValueNumber = objectCounters->GetRankNumber();
+	pcRankValues = new Continuous[nRankValueNumber];
+	for (nRank = 0; nRank < nRankValueNumber; nRank++)
+		pcRankValues[nRank] = column->GetContinuousValueAt(nRank);
+}
 
-	KWDatabaseSorter::SortDatabaseObjectsOnContinuous(kwdb, attribute->GetName());
-	oaPreSortedObjects.CopyFrom(kwdb->GetObjects());
+const Continuous* KRPreprocessedContinuousAttribute::GetRankValues() const
+{
+	return pcRankValues;
+}
+
+int KRPreprocessedContinuousAttribute::GetRankValueNumber() const
+{
+	return nRankValueNumber;
 }
 
 int KRPreprocessedContinuousAttribute::GetAttributeType() const
@@ -247,48 +485,229 @@ int KRPreprocessedContinuousAttribute::GetAttributeType() const
 	return KWType::Continuous;
 }
 
+int KRPreprocessedContinuousAttribute::SearchUpperIndex(Continuous cValue) const
+{
+	int nLowerIndex;
+	int nUpperIndex;
+	int nMiddleIndex;
+
+	// Recherche dichotomique du premier objet de valeur strictement superieure
+	nLowerIndex = 0;
+	nUpperIndex = GetObjectNumber();
+	while (nLowerIndex < nUpperIndex)
+	{
+		nMiddleIndex = (nLowerIndex + nUpperIndex) / 2;
+		if (GetValueAt(nMiddleIndex) <= cValue)
+			nLowerIndex = nMiddleIndex + 1;
+		else
+			nUpperIndex = nMiddleIndex;
+	}
+	return nLowerIndex;
+}
+
 void KRPreprocessedContinuousAttribute::PrepareWorkingInstances(KRRAttribute* attribute, KRRule* rule,
-								KRObjectCounters* counters, ObjectArray* oaWorkingInstances) const
+								KRObjectCounters* counters, IntVector* ivWorkingInstances) const
 {
 	int nIndex;
-	Continuous cValue;
-	KWObject* kwoObject;
+	int nFirstBodyIndex;
+	int nLastBodyIndex;
 
 	require(attribute != NULL);
 	require(attribute->GetAttributeType() == KWType::Continuous);
 	require(rule != NULL);
 	require(attribute->GetAttributeName() == sAttributeName);
+	require(ivWorkingInstances != NULL);
 
-	for (nIndex = 0; nIndex < oaPreSortedObjects.GetSize(); nIndex++)
+	// Plage d'index des objets du corps de l'attribut
+	ComputeBodyIndexRange(attribute, nFirstBodyIndex, nLastBodyIndex);
+
+	ivWorkingInstances->SetSize(0);
+	for (nIndex = 0; nIndex < ivSortedObjectRanks.GetSize(); nIndex++)
 	{
-		kwoObject = cast(KWObject*, oaPreSortedObjects.GetAt(nIndex));
-		cValue = kwoObject->GetContinuousValueAt(liLoadedAttributeIndex);
+		assert((nFirstBodyIndex <= nIndex and nIndex < nLastBodyIndex) == attribute->IsInBodyContinuous(GetValueAt(nIndex)));
 
 		// si objet dans le corps de l'attribut  et compteur == k
-		if (attribute->IsInBodyContinuous(cValue) and counters->GetBodyCountAt(kwoObject) == rule->GetAttributeNumber())
-			oaWorkingInstances->Add(kwoObject);
-
+		if (nFirstBodyIndex <= nIndex and nIndex < nLastBodyIndex)
+		{
+			if (counters->GetBodyCountAtRank(ivSortedObjectRanks.GetAt(nIndex)) == rule->GetAttributeNumber())
+				ivWorkingInstances->Add(nIndex);
+		}
 		// si objet pas dans le corps de l'attribut  et compteur == k-1
-		if ((not attribute->IsInBodyContinuous(cValue)) and counters->GetBodyCountAt(kwoObject) == rule->GetAttributeNumber() - 1)
-			oaWorkingInstances->Add(kwoObject);
+		else if (counters->GetBodyCountAtRank(ivSortedObjectRanks.GetAt(nIndex)) == rule->GetAttributeNumber() - 1)
+			ivWorkingInstances->Add(nIndex);
+	}
+}
+
+void KRPreprocessedContinuousAttribute::InitializeSample(const KRCoverageBitmap* bmSampleObjects)
+{
+	int nIndex;
+
+	require(bmSampleObjects == NULL or bmSampleObjects->GetSize() == objectCounters->GetRankNumber());
+
+	ivSampleIndexes.SetSize(0);
+	if (bmSampleObjects != NULL)
+	{
+		for (nIndex = 0; nIndex < ivSortedObjectRanks.GetSize(); nIndex++)
+		{
+			if (bmSampleObjects->Contains(ivSortedObjectRanks.GetAt(nIndex)))
+				ivSampleIndexes.Add(nIndex);
+		}
+	}
+}
+
+int KRPreprocessedContinuousAttribute::GetSampleObjectNumber() const
+{
+	return ivSampleIndexes.GetSize();
+}
+
+void KRPreprocessedContinuousAttribute::PrepareSampleWorkingInstances(KRRAttribute* attribute, KRRule* rule,
+								      KRObjectCounters* counters, int nIncludedObjectRank,
+								      IntVector* ivWorkingInstances) const
+{
+	int nSample;
+	int nIndex;
+	int nIncludedIndex;
+	int nFirstBodyIndex;
+	int nLastBodyIndex;
+
+	require(attribute != NULL);
+	require(attribute->GetAttributeType() == KWType::Continuous);
+	require(rule != NULL);
+	require(attribute->GetAttributeName() == sAttributeName);
+	require(0 <= nIncludedObjectRank and nIncludedObjectRank < nRankValueNumber);
+	require(ivWorkingInstances != NULL);
+
+	// Plage d'index des objets du corps de l'attribut
+	ComputeBodyIndexRange(attribute, nFirstBodyIndex, nLastBodyIndex);
+
+	// Index de l'objet a inclure, parmi les objets de meme valeur
+	nIncludedIndex = SearchUpperIndex(pcRankValues[nIncludedObjectRank]) - 1;
+	while (nIncludedIndex >= 0 and ivSortedObjectRanks.GetAt(nIncludedIndex) != nIncludedObjectRank)
+		nIncludedIndex--;
+	assert(nIncludedIndex >= 0);
+
+	// Parcours des seuls objets de l'echantillon, avec insertion de l'objet a inclure a sa place
+	ivWorkingInstances->SetSize(0);
+	nSample = 0;
+	while (nSample < ivSampleIndexes.GetSize() or nIncludedIndex >= 0)
+	{
+		// Index suivant: objet a inclure s'il precede le prochain objet de l'echantillon
+		if (nIncludedIndex >= 0 and (nSample == ivSampleIndexes.GetSize() or nIncludedIndex <= ivSampleIndexes.GetAt(nSample)))
+		{
+			nIndex = nIncludedIndex;
+			if (nSample < ivSampleIndexes.GetSize() and nIndex == ivSampleIndexes.GetAt(nSample))
+				nSample++;
+			nIncludedIndex = -1;
+		}
+		else
+		{
+			nIndex = ivSampleIndexes.GetAt(nSample);
+			nSample++;
+		}
+
+		// Meme test que pour l'ensemble des objets
+		if (nFirstBodyIndex <= nIndex and nIndex < nLastBodyIndex)
+		{
+			if (counters->GetBodyCountAtRank(ivSortedObjectRanks.GetAt(nIndex)) == rule->GetAttributeNumber())
+				ivWorkingInstances->Add(nIndex);
+		}
+		else if (counters->GetBodyCountAtRank(ivSortedObjectRanks.GetAt(nIndex)) == rule->GetAttributeNumber() - 1)
+			ivWorkingInstances->Add(nIndex);
 	}
-	//cout << "Working Instances prepared. Size : " << oaWorkingInstances->GetSize() << "\n";
-	//cout << *oaWorkingInstances;
+}
+
+void KRPreprocessedContinuousAttribute::ComputeBodyIndexRange(const KRRAttribute* attribute, int& nFirstBodyIndex,
+							      int& nLastBodyIndex) const
+{
+	KRRInterval* bodyInterval;
+
+	require(attribute != NULL);
+
+	bodyInterval = attribute->GetPartAt(attribute->GetBodyPartIndex())->GetInterval();
+	nFirstBodyIndex = 0;
+	if (attribute->GetBodyPartIndex() != 0)
+		nFirstBodyIndex = SearchUpperIndex(bodyInterval->GetLowerBound());
+	nLastBodyIndex = SearchUpperIndex(bodyInterval->GetUpperBound());
+}
+
+void KRPreprocessedContinuousAttribute::InitializeCandidateIntervals(int nGranularity)
+{
+	const KWDGSAttributeDiscretization* discretization;
+	int nBoundNumber;
+	int nBound;
+	int nMaxIntervalFrequency;
+	int nIntervalFrequency;
+	int nInterval;
+	int nIndex;
+	boolean bNewInterval;
+	Continuous cValue;
+	Continuous cPrecValue;
+
+	require(nGranularity >= 0);
+	require(nRankValueNumber == ivSortedObjectRanks.GetSize());
+
+	ivSortedCandidateIntervals.SetSize(0);
+	if (nGranularity == 0 or GetObjectNumber() == 0)
+		return;
+
+	// Discretisation univariee de l'attribut, s'il est informatif
+	discretization = cast(const KWDGSAttributeDiscretization*, GetUnivariatePartition());
+	nBoundNumber = 0;
+	if (discretization != NULL)
+		nBoundNumber = discretization->GetIntervalBoundNumber();
+
+	// Frequence maximale des intervalles candidats
+	nMaxIntervalFrequency = (GetObjectNumber() + nGranularity - 1) / nGranularity;
+
+	// Parcours des valeurs triees, avec changement d'intervalle entre deux valeurs distinctes apres la valeur
+	// manquante, de part et d'autre d'une borne de la discretisation (intervalles de la forme ]a;b]),
+	// ou si l'intervalle courant a atteint la frequence maximale
+	ivSortedCandidateIntervals.SetSize(GetObjectNumber());
+	nBound = 0;
+	nInterval = 0;
+	nIntervalFrequency = 0;
+	cPrecValue = GetValueAt(0);
+	for (nIndex = 0; nIndex < GetObjectNumber(); nIndex++)
+	{
+		cValue = GetValueAt(nIndex);
+		if (cValue > cPrecValue)
+		{
+			bNewInterval = (nIntervalFrequency >= nMaxIntervalFrequency or cPrecValue == KWContinuous::GetMissingValue());
+			while (nBound < nBoundNumber and discretization->GetIntervalBoundAt(nBound) < cValue)
+			{
+				if (discretization->GetIntervalBoundAt(nBound) >= cPrecValue)
+					bNewInterval = true;
+				nBound++;
+			}
+			if (bNewInterval)
+			{
+				nInterval++;
+				nIntervalFrequency = 0;
+			}
+			cPrecValue = cValue;
+		}
+		ivSortedCandidateIntervals.SetAt(nIndex, nInterval);
+		nIntervalFrequency++;
+	}
+}
+
+int KRPreprocessedContinuousAttribute::GetCandidateIntervalNumber() const
+{
+	if (ivSortedCandidateIntervals.GetSize() == 0)
+		return 0;
+	else
+		return ivSortedCandidateIntervals.GetAt(ivSortedCandidateIntervals.GetSize() - 1) + 1;
 }
 
 void KRPreprocessedContinuousAttribute::Write(ostream& ost) const
 {
 	int nIndex;
-	KWObject* kwoCurrent;
 
 	// appel de la mehode ancetre
 	KRPreprocessedAttribute::Write(ost);
 	ost << "\n";
-	for (nIndex = 0; nIndex < oaPreSortedObjects.GetSize(); nIndex++)
-	{
-		kwoCurrent = cast(KWObject*, oaPreSortedObjects.GetAt(nIndex));
-		ost << kwoCurrent->GetContinuousValueAt(liLoadedAttributeIndex) << ", ";
-	}
+	for (nIndex = 0; nIndex < GetObjectNumber(); nIndex++)
+		ost << GetValueAt(nIndex) << ", ";
 }
 
 ////////////////////////////////////////
@@ -305,69 +724,176 @@ KRPreprocessedSymbolAttribute::~KRPreprocessedSymbolAttribute()
 	oaPreprocessedValues.DeleteAll();
 }
 
-void KRPreprocessedSymbolAttribute::Initialize(KWDatabase* kwdb, KWAttribute* attribute)
+void KRPreprocessedSymbolAttribute::Initialize(const KRAttributeColumn* column)
+{
+	int nRank;
+	int* pnRankValueCodes;
+
+	// appel de la methode ancetre
+	KRPreprocessedAttribute::Initialize(column);
+	require(column->GetObjectNumber() != 0);
+
+	// Codes des valeurs par rang, dans leur ordre de premiere apparition selon le rang des objets (cf. KRAttributeColumn)
+	pnRankValueCodes = new int[objectCounters->GetRankNumber()];
+	for (nRank = 0; nRank < objectCounters->GetRankNumber(); nRank++)
+		pnRankValueCodes[nRank] = column->GetSymbolCodeAt(nRank);
+
+	// Tri des rangs des objets selon le code de leur valeur, sans modifier l'ordre des objets de la base
+	InitializeSortedObjectRanks();
+	KRRankSorter::SortRanksOnInt(pnRankValueCodes, &ivSortedObjectRanks);
+	delete[] pnRankValueCodes;
+
+	// Valeurs pretraitees
+	InitializeValuesFromSortedObjectRanks(column);
+}
+
+void KRPreprocessedSymbolAttribute::InitializeFromSortedObjectRanks(const KRAttributeColumn* column,
+								    const IntVector* ivSortedRanks)
+{
+	require(column != NULL);
+	require(column->GetObjectNumber() > 0);
+	require(oaPreprocessedValues.GetSize() == 0);
+
+	// appel de la methode ancetre
+	KRPreprocessedAttribute::InitializeFromSortedObjectRanks(column, ivSortedRanks);
+
+	// Valeurs pretraitees
+	InitializeValuesFromSortedObjectRanks(column);
+}
+
+void KRPreprocessedSymbolAttribute::InitializeValuesFromSortedObjectRanks(const KRAttributeColumn* column)
 {
 	int nIndex;
-	KWObject* kwoCurrent;
-	Symbol sCurrentValue;
-	Symbol sPrecValue;
-	int nFrequency;
-	int nLastIndex;
+	int nCode;
 	int nFirstIndex;
 	KRPreprocessedValue* krpvValue;
 
-	// appel de la methode ancetre
-	KRPreprocessedAttribute::Initialize(kwdb, attribute);
-
-	KWDatabaseSorter::SortDatabaseObjectsOnSymbol(kwdb, attribute->GetName());
-	oaPreSortedObjects.CopyFrom(kwdb->GetObjects());
-	require(oaPreSortedObjects.GetSize() != 0);
+	require(column != NULL);
+	require(column->GetObjectNumber() == GetObjectNumber());
+	require(GetObjectNumber() > 0);
 
-	// creation du tableau des preprocessed values
-	kwoCurrent = cast(KWObject*, oaPreSortedObjects.GetAt(0));
-	sPrecValue = kwoCurrent->GetSymbolValueAt(liLoadedAttributeIndex);
-	nFrequency = 0;
+	// creation du tableau des preprocessed values, une par plage d'objets de meme code
+	// Tous les codes etant presents, la valeur d'index nCode est celle de code nCode
 	nFirstIndex = 0;
-	nLastIndex = 0;
-	for (nIndex = 0; nIndex < oaPreSortedObjects.GetSize(); nIndex++)
+	for (nIndex = 1; nIndex <= GetObjectNumber(); nIndex++)
 	{
-		kwoCurrent = cast(KWObject*, oaPreSortedObjects.GetAt(nIndex));
-		sCurrentValue = kwoCurrent->GetSymbolValueAt(liLoadedAttributeIndex);
-		if (sCurrentValue != sPrecValue)
+		nCode = column->GetSymbolCodeAt(GetObjectRankAt(nFirstIndex));
+		if (nIndex == GetObjectNumber() or column->GetSymbolCodeAt(GetObjectRankAt(nIndex)) != nCode)
 		{
-			krpvValue = new KRPreprocessedValue(sPrecValue, nLastIndex - nFirstIndex + 1, nFirstIndex, nLastIndex);
+			assert(nCode == oaPreprocessedValues.GetSize());
+			krpvValue = new KRPreprocessedValue(column->GetSymbolValueAt(nCode), nIndex - nFirstIndex, nFirstIndex, nIndex - 1);
 			oaPreprocessedValues.Add(krpvValue);
-			nFirstIndex = nLastIndex + 1;
-			nLastIndex = nIndex;
-			nFrequency = 1;
-			sPrecValue = sCurrentValue;
-		}
-		else
-		{
-			if (nIndex != 0)
-			{
-				nLastIndex++;
-			} // cas particulier du premier objet
-			nFrequency++;
+			nFirstIndex = nIndex;
 		}
+	}
+	assert(oaPreprocessedValues.GetSize() == column->GetSymbolValueNumber());
+
+	// Indexation et codage des valeurs
+	InitializeObjectValueCodes();
+}
+
+boolean KRPreprocessedSymbolAttribute::InitializeFromSortOrder(const KRAttributeColumn* column,
+							       KRSortOrder* sortOrder)
+{
+	boolean bOk;
+	StringVector* svValues;
+	IntVector* ivValueLastIndexes;
+	KRPreprocessedValue* krpvValue;
+	Symbol sValue;
+	int nValue;
+	int nIndex;
+	int nFirstIndex;
+	int nLastIndex;
+
+	require(oaPreprocessedValues.GetSize() == 0);
 
-		// pour la derniere valeur
-		if (nIndex == oaPreSortedObjects.GetSize() - 1)
+	// appel de la methode ancetre
+	bOk = KRPreprocessedAttribute::InitializeFromSortOrder(column, sortOrder);
+	bOk = bOk and GetObjectNumber() > 0;
+
+	// Creation des valeurs pretraitees, en verifiant que la plage d'index de chaque valeur
+	// ne contient que des objets de cette valeur
+	if (bOk)
+	{
+		svValues = sortOrder->GetValues();
+		ivValueLastIndexes = sortOrder->GetValueLastIndexes();
+		nFirstIndex = 0;
+		for (nValue = 0; nValue < svValues->GetSize(); nValue++)
 		{
-			if (sCurrentValue != sPrecValue)
+			nLastIndex = ivValueLastIndexes->GetAt(nValue);
+			bOk = nFirstIndex <= nLastIndex and nLastIndex < GetObjectNumber();
+			if (bOk)
 			{
-				krpvValue = new KRPreprocessedValue(sCurrentValue, 1, nIndex, nIndex);
-				oaPreprocessedValues.Add(krpvValue);
-			}
-			else
-			{
-				krpvValue = new KRPreprocessedValue(sCurrentValue, nIndex - nFirstIndex + 1, nFirstIndex, nIndex);
-				oaPreprocessedValues.Add(krpvValue);
+				sValue = (const char*)svValues->GetAt(nValue);
+				for (nIndex = nFirstIndex; nIndex <= nLastIndex; nIndex++)
+				{
+					if (column->GetSymbolValueAt(column->GetSymbolCodeAt(GetObjectRankAt(nIndex))) != sValue)
+					{
+						bOk = false;
+						break;
+					}
+				}
 			}
+			if (not bOk)
+				break;
+			krpvValue = new KRPreprocessedValue(sValue, nLastIndex - nFirstIndex + 1, nFirstIndex, nLastIndex);
+			oaPreprocessedValues.Add(krpvValue);
+			nFirstIndex = nLastIndex + 1;
 		}
+		bOk = bOk and nFirstIndex == GetObjectNumber();
+	}
+
+	// Indexation et codage des valeurs, en verifiant que les valeurs sont distinctes
+	if (bOk)
+	{
+		InitializeObjectValueCodes();
+		bOk = nkdValues.GetCount() == oaPreprocessedValues.GetSize();
+	}
+
+	// Nettoyage en cas d'ordre de tri ne correspondant pas a la base
+	if (not bOk)
+	{
+		DeleteIndexingStructure();
+		oaPreprocessedValues.DeleteAll();
+	}
+	return bOk;
+}
+
+void KRPreprocessedSymbolAttribute::ExportSortOrder(KRSortOrder* sortOrder) const
+{
+	KRPreprocessedValue* krpvValue;
+	int nValue;
+
+	// appel de la methode ancetre
+	KRPreprocessedAttribute::ExportSortOrder(sortOrder);
+
+	// Valeurs et fin de leur plage d'index
+	for (nValue = 0; nValue < oaPreprocessedValues.GetSize(); nValue++)
+	{
+		krpvValue = cast(KRPreprocessedValue*, oaPreprocessedValues.GetAt(nValue));
+		sortOrder->GetValues()->Add(krpvValue->GetValue().GetValue());
+		sortOrder->GetValueLastIndexes()->Add(krpvValue->GetLastIndex());
 	}
+}
+
+void KRPreprocessedSymbolAttribute::InitializeObjectValueCodes()
+{
+	int nValue;
+	int nIndex;
+	KRPreprocessedValue* krpvValue;
+
 	// construction de la structure d'indexation
 	BuildIndexingStructure();
+
+	// Codes des valeurs des objets, par rang
+	ivObjectValueCodes.SetSize(objectCounters->GetRankNumber());
+	ivObjectValueCodes.Initialize();
+	for (nValue = 0; nValue < oaPreprocessedValues.GetSize(); nValue++)
+	{
+		krpvValue = cast(KRPreprocessedValue*, oaPreprocessedValues.GetAt(nValue));
+		for (nIndex = krpvValue->GetFirstIndex(); nIndex <= krpvValue->GetLastIndex(); nIndex++)
+			ivObjectValueCodes.SetAt(ivSortedObjectRanks.GetAt(nIndex), krpvValue->GetValueCode());
+	}
 }
 
 int KRPreprocessedSymbolAttribute::GetAttributeType() const
@@ -390,6 +916,7 @@ void KRPreprocessedSymbolAttribute::BuildIndexingStructure()
 	for (nIndex = 0; nIndex < oaPreprocessedValues.GetSize(); nIndex++)
 	{
 		krpvValue = cast(KRPreprocessedValue*, oaPreprocessedValues.GetAt(nIndex));
+		krpvValue->SetValueCode(nIndex);
 		sValue = krpvValue->GetValue();
 		nkdValues.SetAt((NUMERIC)sValue.GetNumericKey(), krpvValue);
 	}
@@ -424,33 +951,107 @@ KRPreprocessedValue* KRPreprocessedSymbolAttribute::LookUpPreprocessedValue(Symb
 	return krpvValue;
 }
 
+int KRPreprocessedSymbolAttribute::GetPreprocessedValueNumber() const
+{
+	return oaPreprocessedValues.GetSize();
+}
+
+KRPreprocessedValue* KRPreprocessedSymbolAttribute::GetPreprocessedValueAt(int nIndex) const
+{
+	return cast(KRPreprocessedValue*, oaPreprocessedValues.GetAt(nIndex));
+}
+
+int KRPreprocessedSymbolAttribute::ComputeUnivariateGroupIndexes(IntVector* ivValueGroupIndexes) const
+{
+	const KWDGSAttributeGrouping* grouping;
+	int nGroup;
+	int nValue;
+	int nValueCode;
+	int nStarGroup;
+
+	require(ivValueGroupIndexes != NULL);
+	require(IsIndexed());
+
+	ivValueGroupIndexes->SetSize(0);
+	grouping = cast(const KWDGSAttributeGrouping*, GetUnivariatePartition());
+	if (grouping == NULL)
+		return 0;
+
+	// Groupe de chaque valeur presente dans la base, et groupe de la modalite speciale
+	ivValueGroupIndexes->SetSize(GetPreprocessedValueNumber());
+	for (nValueCode = 0; nValueCode < ivValueGroupIndexes->GetSize(); nValueCode++)
+		ivValueGroupIndexes->SetAt(nValueCode, -1);
+	nStarGroup = 0;
+	for (nGroup = 0; nGroup < grouping->GetGroupNumber(); nGroup++)
+	{
+		for (nValue = grouping->GetGroupFirstValueIndexAt(nGroup); nValue <= grouping->GetGroupLastValueIndexAt(nGroup); nValue++)
+		{
+			if (grouping->GetValueAt(nValue) == Symbol::GetStarValue())
+				nStarGroup = nGroup;
+			else
+			{
+				nValueCode = LookUpValueCode(grouping->GetValueAt(nValue));
+				if (nValueCode >= 0)
+					ivValueGroupIndexes->SetAt(nValueCode, nGroup);
+			}
+		}
+	}
+
+	// Les valeurs non memorisees dans le groupement sont dans le groupe de la modalite speciale
+	for (nValueCode = 0; nValueCode < ivValueGroupIndexes->GetSize(); nValueCode++)
+	{
+		if (ivValueGroupIndexes->GetAt(nValueCode) == -1)
+			ivValueGroupIndexes->SetAt(nValueCode, nStarGroup);
+	}
+	return grouping->GetGroupNumber();
+}
+
+int KRPreprocessedSymbolAttribute::LookUpValueCode(Symbol sValue) const
+{
+	KRPreprocessedValue* krpvValue;
+
+	require(IsIndexed());
+
+	krpvValue = cast(KRPreprocessedValue*, nkdValues.Lookup((NUMERIC)sValue.GetNumericKey()));
+	if (krpvValue == NULL)
+		return -1;
+	else
+		return krpvValue->GetValueCode();
+}
+
 void KRPreprocessedSymbolAttribute::PrepareWorkingInstances(KRRAttribute* attribute, KRRule* rule,
-							    KRObjectCounters* counters, ObjectArray* oaWorkingInstances) const
+							    KRObjectCounters* counters, IntVector* ivWorkingInstances) const
 {
+	int nValue;
 	int nIndex;
-	Symbol sValue;
-	KWObject* kwoObject;
+	KRPreprocessedValue* krpvValue;
+	int nExpectedBodyCount;
 
 	require(attribute != NULL);
 	require(attribute->GetAttributeType() == KWType::Symbol);
 	require(rule != NULL);
 	require(attribute->GetAttributeName() == sAttributeName);
+	require(attribute->GetBodyValueCodes()->GetSize() == oaPreprocessedValues.GetSize());
+	require(ivWorkingInstances != NULL);
 
-	for (nIndex = 0; nIndex < oaPreSortedObjects.GetSize(); nIndex++)
+	// Parcours par valeur, le test d'appartenance au corps n'etant effectue qu'une fois par valeur, par son code
+	ivWorkingInstances->SetSize(0);
+	for (nValue = 0; nValue < oaPreprocessedValues.GetSize(); nValue++)
 	{
-		kwoObject = cast(KWObject*, oaPreSortedObjects.GetAt(nIndex));
-		sValue = kwoObject->GetSymbolValueAt(liLoadedAttributeIndex);
+		krpvValue = cast(KRPreprocessedValue*, oaPreprocessedValues.GetAt(nValue));
 
 		// si objet dans le corps de l'attribut  et compteur == k
-		if (attribute->IsInBodySymbol(sValue) and counters->GetBodyCountAt(kwoObject) == rule->GetAttributeNumber())
-			oaWorkingInstances->Add(kwoObject);
-
 		// si objet pas dans le corps de l'attribut  et compteur == k-1
-		if ((not attribute->IsInBodySymbol(sValue)) and counters->GetBodyCountAt(kwoObject) == rule->GetAttributeNumber() - 1)
-			oaWorkingInstances->Add(kwoObject);
+		if (attribute->IsInBodySymbolCode(krpvValue->GetValueCode()))
+			nExpectedBodyCount = rule->GetAttributeNumber();
+		else
+			nExpectedBodyCount = rule->GetAttributeNumber() - 1;
+		for (nIndex = krpvValue->GetFirstIndex(); nIndex <= krpvValue->GetLastIndex(); nIndex++)
+		{
+			if (counters->GetBodyCountAtRank(ivSortedObjectRanks.GetAt(nIndex)) == nExpectedBodyCount)
+				ivWorkingInstances->Add(nIndex);
+		}
 	}
-	/*cout << "Working Instances prepared. Size : " << oaWorkingInstances->GetSize() << "\n";
-	cout << *oaWorkingInstances;*/
 }
 
 void KRPreprocessedSymbolAttribute::Test()
@@ -504,6 +1105,7 @@ KRPreprocessedValue::KRPreprocessedValue(Symbol sValue, int nFrequency, int nFir
 	nValueFrequency = nFrequency;
 	nValueFirstIndex = nFirstIndex;
 	nValueLastIndex = nLastIndex;
+	nValueCode = -1;
 }
 
 KRPreprocessedValue::~KRPreprocessedValue()
@@ -530,6 +1132,16 @@ int KRPreprocessedValue::GetLastIndex() const
 	return nValueLastIndex;
 }
 
+void KRPreprocessedValue::SetValueCode(int nValue)
+{
+	nValueCode = nValue;
+}
+
+int KRPreprocessedValue::GetValueCode() const
+{
+	return nValueCode;
+}
+
 void KRPreprocessedValue::Write(ostream& ost) const
 {
 	ost << "(" << sSymbolValue << " [" << nValueFirstIndex << "-" << nValueLastIndex << "] :" << nValueFrequency << ")";
@@ -13,32 +13,47 @@ class KRPreprocessedValue;
 #include "Vector.h"
 #include "KWType.h"
 #include "KWSymbol.h"
-#include "KWDatabase.h"
+#include "KRAttributeColumn.h"
 #include "KWClassStats.h"
 #include "KRRuleOptimizer.h"
 #include "KRRule.h"
 #include "KRObjectCounters.h"
+#include "KRCoverageBitmap.h"
+#include "KRPreprocessingCache.h"
 
-// Classe permettant de trier une base
-// Permet de simuler une ancienne fonctionnalit des KWDatabase du temps de Khiops V8
-// pour eviter une migration plus complete du code
-class KWDatabaseSorter : public Object
+////////////////////////////////////////////////////////////////////////////////////
+// Classe KRRankSorter
+// Tri des rangs des objets (cf. KRObjectCounters) selon une colonne de cles indexee par rang,
+// les rangs de cles egales etant ordonnes par rang croissant
+// Le tri porte sur une permutation des rangs, sans modifier l'ordre des objets de la base, et ne partage
+// aucun etat: il peut etre effectue independamment pour chaque attribut
+// Les cles sont extraites avec les rangs dans des tableaux contigus, puis triees en temps lineaire
+// par des tris stables appliques aux rangs mis au prealable en ordre croissant
+class KRRankSorter : public Object
 {
 public:
-	// Tri de la base de donnees base suivant un attribut Continuous
-	static void SortDatabaseObjectsOnContinuous(KWDatabase* database, const ALString& sAttributeName);
+	// Tri selon une valeur numerique par rang
+	// Tri par base (LSD radix sort) sur une representation binaire des valeurs preservant leur ordre
+	static void SortRanksOnContinuous(const Continuous* pcRankValues, IntVector* ivRanks);
 
-	// Tri de la base de donnees base suivant un attribut Symbol
-	// Tri rapide base sur l'identifiant des Symbol
-	static void SortDatabaseObjectsOnSymbol(KWDatabase* database, const ALString& sAttributeName);
+	// Tri selon une cle entiere positive ou nulle par rang (par exemple le code de la valeur d'un attribut Symbol)
+	// Tri par denombrement (counting sort) des cles
+	static void SortRanksOnInt(const int* pnRankKeys, IntVector* ivRanks);
 
-	///////////////////////////////////////////////////////////////////////////////////
-	// Implementation
+	///////////////////////////////////////////////////////
+	///// Implementation
 protected:
-	// Tri de la base de donnees
-	// On se base sur un algorithme plus rapide que le Sort
-	// des ObjectArray
-	static void SortObjects(KWDatabase* database, CompareFunction fCompare);
+	// Recopie des rangs dans l'ordre croissant dans un tableau, par marquage des rangs presents
+	static void InitializeAscendingRanks(const IntVector* ivRanks, int* pnRanks);
+
+	// Cle binaire d'une valeur numerique, dont l'ordre des entiers non signes est celui des valeurs
+	static unsigned long long ComputeContinuousSortKey(Continuous cValue);
+
+	// Taille en dessous de laquelle un tri par comparaison est utilise
+	static const int nMinLinearSortSize = 256;
+
+	// Nombre de bits des chiffres du tri par base
+	static const int nRadixDigitBitNumber = 16;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -46,7 +61,10 @@ protected:
 // Structure de donnees de pretraitement pour l'optimisation de regles
 // principalement caracterise par:
 //		nom de l'attribut
-//		tableau d'objects tries selon la valeur de l'attribut
+//		colonne des rangs des objets tries selon la valeur de l'attribut
+// Les objets sont identifies par leur rang dans l'index des objets (KRObjectCounters),
+// ce qui permet un parcours de memoire contigue sans acceder aux KWObject, qui ne sont pas conserves:
+// l'attribut est initialise a partir de la colonne de ses valeurs lues dans la base (KRAttributeColumn)
 
 class KRPreprocessedAttribute : public Object
 {
@@ -56,8 +74,21 @@ public:
 	~KRPreprocessedAttribute();
 
 	/////////////////////////////////
-	// Initialisation de l'attribut
-	virtual void Initialize(KWDatabase* kwdb, KWAttribute* attribute);
+	// Initialisation de l'attribut a partir de la colonne de ses valeurs par rang d'objet
+	// La colonne n'est pas modifiee et peut etre detruite apres l'initialisation
+	virtual void Initialize(const KRAttributeColumn* column);
+
+	// Initialisation de l'attribut a partir d'un ordre de tri memorise (cf. KRPreprocessingCache), sans tri
+	// L'ordre de tri est verifie sur les valeurs de la colonne: renvoie false s'il ne leur correspond pas,
+	// l'attribut etant alors a initialiser par Initialize
+	virtual boolean InitializeFromSortOrder(const KRAttributeColumn* column, KRSortOrder* sortOrder);
+
+	// Initialisation de l'attribut a partir de la colonne de ses valeurs et des rangs des objets deja tries
+	// selon ces valeurs (cf. KRPreprocessingTask), sans tri
+	virtual void InitializeFromSortedObjectRanks(const KRAttributeColumn* column, const IntVector* ivSortedRanks);
+
+	// Export de l'ordre de tri de l'attribut initialise
+	virtual void ExportSortOrder(KRSortOrder* sortOrder) const;
 
 	////////////////////////////////
 	// Specifications de l'attribut
@@ -70,8 +101,18 @@ public:
 	// Type de l'attribut (Symbol ou Continuous)
 	virtual int GetAttributeType() const = 0;
 
-	// Acces aux objects pre-tries
-	ObjectArray* GetObjects();
+	// Parametrage par l'index des objets, fournissant le rang de chaque objet
+	// A parametrer avant l'initialisation
+	// Memoire: l'index est reference et destine a etre partage
+	void SetObjectCounters(const KRObjectCounters* counters);
+	const KRObjectCounters* GetObjectCounters() const;
+
+	// Acces aux objets pre-tries
+	// Nombre d'objets
+	int GetObjectNumber() const;
+
+	// Rang de l'objet d'index donne dans l'ordre de tri
+	int GetObjectRankAt(int nIndex) const;
 
 	// Parametrage par des statistiques sur le probleme d'apprentissage
 	// Permet l'utilisation des statistiques univariees pour optimiser les regles
@@ -79,13 +120,19 @@ public:
 	void SetClassStats(KWClassStats* stats);
 	KWClassStats* GetClassStats() const;
 
+	// Partition univariee de l'attribut issue de la preparation des donnees (cf. KWClassStats):
+	// discretisation pour un attribut Continuous, groupement de valeurs pour un attribut Symbol
+	// Renvoie NULL si l'attribut n'est pas informatif ou si sa partition n'est pas disponible
+	const KWDGSAttributePartition* GetUnivariatePartition() const;
+
 	///////////////////////////////
 	// Services divers
 
 	// Service exploitant la structure de pretraitement pour l'optimisation
-	// Creation de la sous-base utile a l'optimisation de l'attribut pour une regle
+	// Creation de la sous-base utile a l'optimisation de l'attribut pour une regle,
+	// sous forme des index des objets dans l'ordre de tri
 	virtual void PrepareWorkingInstances(KRRAttribute* attribute, KRRule* rule,
-					     KRObjectCounters* counters, ObjectArray* oaWorkingInstances) const;
+					     KRObjectCounters* counters, IntVector* ivWorkingInstances) const;
 
 	// Controle d'integrite local a l'attribut
 	boolean Check() const;
@@ -94,11 +141,17 @@ public:
 	virtual void Write(ostream& ost) const;
 
 protected:
+	// Initialisation de la colonne des rangs des objets dans l'ordre de la base, avant leur tri
+	void InitializeSortedObjectRanks();
+
+	// Initialisation de la colonne des rangs des objets a partir d'un ordre de tri memorise, s'il s'agit
+	// d'une permutation des rangs des objets de la base (false sinon)
+	boolean InitializeSortedObjectRanksFromSortOrder(KRSortOrder* sortOrder);
+
 	// Attributs
 	ALString sAttributeName;
-	ObjectArray oaPreSortedObjects;
-	KWLoadIndex liLoadedAttributeIndex;
-	KWLoadIndex liLoadedTargetAttributeIndex;
+	IntVector ivSortedObjectRanks;
+	const KRObjectCounters* objectCounters;
 	KWClassStats* classStats;
 };
 
@@ -107,7 +160,11 @@ protected:
 // Structure de donnees de pretraitement pour l'optimisation de regles
 // principalement caracterise par:
 //		nom de l'attribut
-//		tableau d'objects tries selon la valeur de l'attribut
+//		colonne des rangs des objets, tries selon la valeur de l'attribut
+//		colonne des valeurs, indexee par rang d'objet
+// Les valeurs ne sont memorisees qu'une fois, par rang: l'acces dans l'ordre de tri passe par le rang de l'objet
+// L'attribut occupe ainsi 12 octets par objet (valeur et rang), plus 4 octets par objet
+// avec des intervalles candidats (cf. InitializeCandidateIntervals)
 
 class KRPreprocessedContinuousAttribute : public KRPreprocessedAttribute
 {
@@ -122,21 +179,76 @@ public:
 
 	/////////////////////////////////
 	// Initialisation de l'attribut
-	void Initialize(KWDatabase* kwdb, KWAttribute* attribute);
+	void Initialize(const KRAttributeColumn* column);
+	boolean InitializeFromSortOrder(const KRAttributeColumn* column, KRSortOrder* sortOrder);
+	void InitializeFromSortedObjectRanks(const KRAttributeColumn* column, const IntVector* ivSortedRanks);
 
 	// Type de l'attribut (Symbol ou Continuous)
 	int GetAttributeType() const;
 
+	// Valeur de l'objet d'index donne dans l'ordre de tri, lue dans la colonne des valeurs par rang
+	Continuous GetValueAt(int nIndex) const;
+
+	// Valeur de l'objet de rang donne
+	Continuous GetValueAtRank(int nRank) const;
+
+	// Index du premier objet de valeur strictement superieure a une valeur (GetObjectNumber() si aucun)
+	int SearchUpperIndex(Continuous cValue) const;
+
+	// Colonne contigue des valeurs par rang d'objet (cf. KRObjectCounters), pour l'evaluation vectorisee
+	// des intervalles (cf. KRIntervalKernel)
+	const Continuous* GetRankValues() const;
+	int GetRankValueNumber() const;
+
 	///////////////////////////////
 	// Services divers
 
 	// Service exploitant la structure de pretraitement pour l'optimisation
 	// Creation de la sous-base utile a l'optimisation de l'attribut pour une regle
 	void PrepareWorkingInstances(KRRAttribute* attribute, KRRule* rule,
-				     KRObjectCounters* counters, ObjectArray* oaWorkingInstances) const;
+				     KRObjectCounters* counters, IntVector* ivWorkingInstances) const;
+
+	// Echantillon d'objets, memorise par les index dans l'ordre de tri des objets dont le rang appartient
+	// a un bitmap de rangs (NULL: pas d'echantillon)
+	void InitializeSample(const KRCoverageBitmap* bmSampleObjects);
+	int GetSampleObjectNumber() const;
+
+	// Creation de la sous-base utile a l'optimisation de l'attribut, restreinte aux objets de l'echantillon
+	// L'objet de rang donne y figure toujours s'il fait partie des instances de travail
+	void PrepareSampleWorkingInstances(KRRAttribute* attribute, KRRule* rule, KRObjectCounters* counters,
+					   int nIncludedObjectRank, IntVector* ivWorkingInstances) const;
+
+	// Intervalles candidats pour les bornes des regles: intervalles de la discretisation univariee de l'attribut
+	// (cf. KWClassStats), redecoupes en intervalles de frequence au plus egale au nombre d'objets divise par
+	// la granularite, les valeurs manquantes formant un intervalle a part
+	// Les coupures sont placees uniquement entre deux valeurs distinctes
+	void InitializeCandidateIntervals(int nGranularity);
+	int GetCandidateIntervalNumber() const;
+
+	// Indique si une borne entre deux objets d'index donnes dans l'ordre de tri est candidate, c'est-a-dire
+	// s'ils sont dans deux intervalles candidats differents (toujours vrai sans intervalles candidats)
+	boolean IsCandidateBoundBetween(int nLowerIndex, int nUpperIndex) const;
 
 	// Affichage complet
 	void Write(ostream& ost) const;
+
+protected:
+	// Memorisation des valeurs par rang, a partir de la colonne des valeurs de l'attribut
+	void InitializeRankValues(const KRAttributeColumn* column);
+
+	// Plage d'index des objets du corps de l'attribut, du premier au suivant le dernier
+	// (valeurs manquantes comprises pour la premiere partie)
+	void ComputeBodyIndexRange(const KRRAttribute* attribute, int& nFirstBodyIndex, int& nLastBodyIndex) const;
+
+	// Index dans l'ordre de tri des objets de l'echantillon
+	IntVector ivSampleIndexes;
+
+	// Index de l'intervalle candidat de chaque objet, dans l'ordre de tri (vide si pas d'intervalles candidats)
+	IntVector ivSortedCandidateIntervals;
+
+	// Valeurs par rang d'objet, en memoire contigue: seule colonne de valeurs de l'attribut
+	Continuous* pcRankValues;
+	int nRankValueNumber;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -159,7 +271,10 @@ public:
 
 	/////////////////////////////////
 	// Initialisation de l'attribut
-	void Initialize(KWDatabase* kwdb, KWAttribute* attribute);
+	void Initialize(const KRAttributeColumn* column);
+	boolean InitializeFromSortOrder(const KRAttributeColumn* column, KRSortOrder* sortOrder);
+	void InitializeFromSortedObjectRanks(const KRAttributeColumn* column, const IntVector* ivSortedRanks);
+	void ExportSortOrder(KRSortOrder* sortOrder) const;
 
 	// Type de l'attribut (Symbol ou Continuous)
 	int GetAttributeType() const;
@@ -180,13 +295,30 @@ public:
 	// recherche de valeur
 	KRPreprocessedValue* LookUpPreprocessedValue(Symbol sValue);
 
+	// Acces aux valeurs, dans l'ordre de tri
+	int GetPreprocessedValueNumber() const;
+	KRPreprocessedValue* GetPreprocessedValueAt(int nIndex) const;
+
+	// Codes denses des valeurs: index de la valeur dans l'ordre de tri,
+	// entre 0 et GetPreprocessedValueNumber()-1
+	// Code d'une valeur (-1 si valeur absente de la base)
+	int LookUpValueCode(Symbol sValue) const;
+
+	// Code de la valeur d'un objet de la base, par son rang, sans recherche par valeur
+	int GetObjectValueCodeAtRank(int nRank) const;
+
+	// Index du groupe de la partition univariee (cf. GetUnivariatePartition) de chaque valeur, par code de valeur,
+	// les valeurs absentes du groupement etant dans le groupe de la modalite speciale
+	// Renvoie le nombre de groupes (0 et vecteur vide si pas de partition univariee)
+	int ComputeUnivariateGroupIndexes(IntVector* ivValueGroupIndexes) const;
+
 	///////////////////////////////
 	// Services divers
 
 	// Service exploitant la structure de pretraitement pour l'optimisation
 	// Creation de la sous-base utile a l'optimisation de l'attribut pour une regle
 	void PrepareWorkingInstances(KRRAttribute* attribute, KRRule* rule,
-				     KRObjectCounters* counters, ObjectArray* oaWorkingInstances) const;
+				     KRObjectCounters* counters, IntVector* ivWorkingInstances) const;
 
 	// test
 	void Test();
@@ -195,10 +327,20 @@ public:
 	void Write(ostream& ost) const;
 
 protected:
+	// Creation des valeurs pretraitees, une par plage d'objets de meme code dans l'ordre de tri des rangs,
+	// puis indexation et codage des valeurs
+	void InitializeValuesFromSortedObjectRanks(const KRAttributeColumn* column);
+
+	// Indexation des valeurs et codage des valeurs des objets, une fois les valeurs pretraitees
+	void InitializeObjectValueCodes();
+
 	//Attributs
 	ObjectArray oaPreprocessedValues;
 	NumericKeyDictionary nkdValues;
 	boolean bIsIndexed;
+
+	// Code de la valeur de chaque objet, indexe par rang d'objet
+	IntVector ivObjectValueCodes;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -233,6 +375,10 @@ public:
 	// Dernier index d'apparition dans la BD triee
 	int GetLastIndex() const;
 
+	// Code dense de la valeur (index dans les valeurs triees de l'attribut)
+	void SetValueCode(int nValue);
+	int GetValueCode() const;
+
 	///////////////////////////////
 	// Services divers
 
@@ -245,6 +391,42 @@ protected:
 	int nValueFrequency;
 	int nValueFirstIndex;
 	int nValueLastIndex;
+	int nValueCode;
 };
 
+///// Methode en inline
+
+inline int KRPreprocessedAttribute::GetObjectNumber() const
+{
+	return ivSortedObjectRanks.GetSize();
+}
+
+inline int KRPreprocessedAttribute::GetObjectRankAt(int nIndex) const
+{
+	return ivSortedObjectRanks.GetAt(nIndex);
+}
+
+inline Continuous KRPreprocessedContinuousAttribute::GetValueAt(int nIndex) const
+{
+	return pcRankValues[ivSortedObjectRanks.GetAt(nIndex)];
+}
+
+inline Continuous KRPreprocessedContinuousAttribute::GetValueAtRank(int nRank) const
+{
+	require(0 <= nRank and nRank < nRankValueNumber);
+	return pcRankValues[nRank];
+}
+
+inline boolean KRPreprocessedContinuousAttribute::IsCandidateBoundBetween(int nLowerIndex, int nUpperIndex) const
+{
+	require(nLowerIndex < nUpperIndex);
+	return ivSortedCandidateIntervals.GetSize() == 0 or
+	       ivSortedCandidateIntervals.GetAt(nLowerIndex) != ivSortedCandidateIntervals.GetAt(nUpperIndex);
+}
+
+inline int KRPreprocessedSymbolAttribute::GetObjectValueCodeAtRank(int nRank) const
+{
+	return ivObjectValueCodes.GetAt(nRank);
+}
+
 #endif // KRPREPROCESSEDATTRIBUTE_H
@@ -0,0 +1,436 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#include "KRPreprocessingCache.h"
+#include "FileService.h"
+
+////////////////////////////////////////
+// Classe KRSortOrder
+
+KRSortOrder::KRSortOrder()
+{
+	nAttributeType = KWType::Unknown;
+}
+
+KRSortOrder::~KRSortOrder() {}
+
+void KRSortOrder::SetAttributeName(const ALString& sValue)
+{
+	sAttributeName = sValue;
+}
+
+const ALString& KRSortOrder::GetAttributeName() const
+{
+	return sAttributeName;
+}
+
+void KRSortOrder::SetAttributeType(int nValue)
+{
+	require(nValue == KWType::Continuous or nValue == KWType::Symbol);
+	nAttributeType = nValue;
+}
+
+int KRSortOrder::GetAttributeType() const
+{
+	return nAttributeType;
+}
+
+IntVector* KRSortOrder::GetSortedObjectRanks()
+{
+	return &ivSortedObjectRanks;
+}
+
+StringVector* KRSortOrder::GetValues()
+{
+	return &svValues;
+}
+
+IntVector* KRSortOrder::GetValueLastIndexes()
+{
+	return &ivValueLastIndexes;
+}
+
+void KRSortOrder::WriteBinary(ostream& ost) const
+{
+	int nValue;
+
+	require(nAttributeType == KWType::Continuous or nAttributeType == KWType::Symbol);
+	require(svValues.GetSize() == ivValueLastIndexes.GetSize());
+
+	WriteBinaryString(ost, sAttributeName);
+	WriteBinaryInt(ost, nAttributeType);
+	WriteBinaryIntVector(ost, &ivSortedObjectRanks);
+	WriteBinaryInt(ost, svValues.GetSize());
+	for (nValue = 0; nValue < svValues.GetSize(); nValue++)
+		WriteBinaryString(ost, svValues.GetAt(nValue));
+	WriteBinaryIntVector(ost, &ivValueLastIndexes);
+}
+
+boolean KRSortOrder::ReadBinary(istream& ist, longint lFileSize, int nObjectNumber)
+{
+	boolean bOk;
+	int nValueNumber;
+	int nValue;
+	ALString sValue;
+
+	require(lFileSize >= 0);
+	require(nObjectNumber >= 0);
+
+	// Lecture des caracteristiques de l'attribut
+	bOk = ReadBinaryString(ist, lFileSize, sAttributeName);
+	bOk = bOk and ReadBinaryInt(ist, nAttributeType);
+	bOk = bOk and (nAttributeType == KWType::Continuous or nAttributeType == KWType::Symbol);
+
+	// Lecture des rangs et des valeurs, au plus une par objet, chaque valeur occupant au moins
+	// la taille de sa longueur dans le fichier
+	bOk = bOk and ReadBinaryIntVector(ist, lFileSize, nObjectNumber, &ivSortedObjectRanks);
+	bOk = bOk and ReadBinaryInt(ist, nValueNumber);
+	bOk = bOk and nValueNumber >= 0 and nValueNumber <= nObjectNumber;
+	bOk = bOk and nValueNumber <= GetRemainingSize(ist, lFileSize) / (longint)sizeof(int);
+	if (bOk)
+	{
+		svValues.SetSize(0);
+		for (nValue = 0; nValue < nValueNumber; nValue++)
+		{
+			bOk = ReadBinaryString(ist, lFileSize, sValue);
+			if (not bOk)
+				break;
+			svValues.Add(sValue);
+		}
+	}
+	bOk = bOk and ReadBinaryIntVector(ist, lFileSize, nObjectNumber, &ivValueLastIndexes);
+	bOk = bOk and svValues.GetSize() == ivValueLastIndexes.GetSize();
+	return bOk;
+}
+
+void KRSortOrder::WriteBinaryInt(ostream& ost, int nValue)
+{
+	ost.write((const char*)&nValue, sizeof(int));
+}
+
+boolean KRSortOrder::ReadBinaryInt(istream& ist, int& nValue)
+{
+	ist.read((char*)&nValue, sizeof(int));
+	return not ist.fail();
+}
+
+void KRSortOrder::WriteBinaryString(ostream& ost, const ALString& sValue)
+{
+	WriteBinaryInt(ost, sValue.GetLength());
+	ost.write((const char*)sValue, sValue.GetLength());
+}
+
+boolean KRSortOrder::ReadBinaryString(istream& ist, longint lFileSize, ALString& sValue)
+{
+	boolean bOk;
+	int nLength;
+	char* sBuffer;
+
+	bOk = ReadBinaryInt(ist, nLength);
+	bOk = bOk and nLength >= 0 and nLength <= GetRemainingSize(ist, lFileSize);
+	if (bOk)
+	{
+		sBuffer = sValue.GetBufferSetLength(nLength);
+		ist.read(sBuffer, nLength);
+		sValue.ReleaseBuffer(nLength);
+		bOk = not ist.fail();
+	}
+	return bOk;
+}
+
+void KRSortOrder::WriteBinaryIntVector(ostream& ost, const IntVector* ivValues)
+{
+	const int nBufferSize = 4096;
+	int nBuffer[nBufferSize];
+	int nIndex;
+	int nBufferIndex;
+
+	require(ivValues != NULL);
+
+	// Ecriture de la taille puis des valeurs, par blocs
+	WriteBinaryInt(ost, ivValues->GetSize());
+	nBufferIndex = 0;
+	for (nIndex = 0; nIndex < ivValues->GetSize(); nIndex++)
+	{
+		nBuffer[nBufferIndex] = ivValues->GetAt(nIndex);
+		nBufferIndex++;
+		if (nBufferIndex == nBufferSize or nIndex == ivValues->GetSize() - 1)
+		{
+			ost.write((const char*)nBuffer, nBufferIndex * sizeof(int));
+			nBufferIndex = 0;
+		}
+	}
+}
+
+boolean KRSortOrder::ReadBinaryIntVector(istream& ist, longint lFileSize, int nMaxSize, IntVector* ivValues)
+{
+	const int nBufferSize = 4096;
+	int nBuffer[nBufferSize];
+	boolean bOk;
+	int nSize;
+	int nIndex;
+	int nBlockSize;
+	int nBufferIndex;
+
+	require(ivValues != NULL);
+
+	// Lecture de la taille, bornee par la taille maximale et par la taille restant a lire,
+	// puis des valeurs, par blocs
+	bOk = ReadBinaryInt(ist, nSize);
+	bOk = bOk and nSize >= 0 and nSize <= nMaxSize;
+	bOk = bOk and nSize <= GetRemainingSize(ist, lFileSize) / (longint)sizeof(int);
+	if (bOk)
+	{
+		ivValues->SetSize(nSize);
+		nIndex = 0;
+		while (nIndex < nSize)
+		{
+			nBlockSize = min(nBufferSize, nSize - nIndex);
+			ist.read((char*)nBuffer, nBlockSize * sizeof(int));
+			if (ist.fail())
+			{
+				bOk = false;
+				break;
+			}
+			for (nBufferIndex = 0; nBufferIndex < nBlockSize; nBufferIndex++)
+				ivValues->SetAt(nIndex + nBufferIndex, nBuffer[nBufferIndex]);
+			nIndex += nBlockSize;
+		}
+	}
+	if (not bOk)
+		ivValues->SetSize(0);
+	return bOk;
+}
+
+longint KRSortOrder::GetRemainingSize(istream& ist, longint lFileSize)
+{
+	longint lPosition;
+
+	lPosition = (longint)ist.tellg();
+	if (lPosition < 0 or lPosition > lFileSize)
+		return -1;
+	return lFileSize - lPosition;
+}
+
+////////////////////////////////////////
+// Classe KRPreprocessingCache
+
+const ALString KRPreprocessingCache::sCacheFileHeader = "Khiops rules preprocessing cache 1.2";
+
+KRPreprocessingCache::KRPreprocessingCache() {}
+
+KRPreprocessingCache::~KRPreprocessingCache()
+{
+	DeleteAll();
+}
+
+void KRPreprocessingCache::SetCacheDirectory(const ALString& sValue)
+{
+	sCacheDirectory = sValue;
+}
+
+const ALString& KRPreprocessingCache::GetCacheDirectory() const
+{
+	return sCacheDirectory;
+}
+
+boolean KRPreprocessingCache::Load(KWDatabase* kwdb, const KWClass* kwcClass, int nObjectNumber)
+{
+	boolean bOk;
+	ALString sCacheFileName;
+	ALString sDatabaseKey;
+	ALString sValue;
+	fstream fstCache;
+	longint lFileSize;
+	boolean bOpened;
+	int nSortOrderNumber;
+	int nSortOrder;
+	KRSortOrder* sortOrder;
+
+	require(kwdb != NULL);
+	require(kwcClass != NULL);
+	require(nObjectNumber >= 0);
+
+	// Nettoyage prealable
+	DeleteAll();
+
+	// Ouverture du fichier de cache, s'il existe (son absence n'est pas une erreur)
+	bOpened = false;
+	lFileSize = 0;
+	sCacheFileName = BuildCacheFileName(kwdb);
+	sDatabaseKey = ComputeDatabaseKey(kwdb, kwcClass, nObjectNumber);
+	bOk = sCacheFileName != "" and sDatabaseKey != "" and FileService::FileExists(sCacheFileName);
+	if (bOk)
+	{
+		lFileSize = FileService::GetFileSize(sCacheFileName);
+		bOpened = FileService::OpenInputBinaryFile(sCacheFileName, fstCache);
+		bOk = bOpened;
+	}
+
+	// Verification de l'entete et de la cle de la base
+	bOk = bOk and KRSortOrder::ReadBinaryString(fstCache, lFileSize, sValue) and sValue == sCacheFileHeader;
+	bOk = bOk and KRSortOrder::ReadBinaryString(fstCache, lFileSize, sValue) and sValue == sDatabaseKey;
+
+	// Lecture des ordres de tri, au plus un par attribut charge
+	bOk = bOk and KRSortOrder::ReadBinaryInt(fstCache, nSortOrderNumber);
+	bOk = bOk and nSortOrderNumber >= 0 and nSortOrderNumber <= kwcClass->GetLoadedAttributeNumber();
+	if (bOk)
+	{
+		for (nSortOrder = 0; nSortOrder < nSortOrderNumber; nSortOrder++)
+		{
+			sortOrder = new KRSortOrder;
+			bOk = sortOrder->ReadBinary(fstCache, lFileSize, nObjectNumber) and
+			      LookupSortOrder(sortOrder->GetAttributeName()) == NULL;
+			if (not bOk)
+			{
+				delete sortOrder;
+				break;
+			}
+			AddSortOrder(sortOrder);
+		}
+	}
+	if (bOpened)
+		FileService::CloseInputBinaryFile(sCacheFileName, fstCache);
+
+	// Nettoyage en cas d'erreur
+	if (not bOk)
+		DeleteAll();
+	return bOk;
+}
+
+boolean KRPreprocessingCache::Save(KWDatabase* kwdb, const KWClass* kwcClass, int nObjectNumber)
+{
+	boolean bOk;
+	ALString sCacheFileName;
+	ALString sDatabaseKey;
+	fstream fstCache;
+	boolean bOpened;
+	int nSortOrder;
+
+	require(kwdb != NULL);
+	require(kwcClass != NULL);
+	require(nObjectNumber >= 0);
+
+	// Ouverture du fichier de cache
+	bOpened = false;
+	sCacheFileName = BuildCacheFileName(kwdb);
+	sDatabaseKey = ComputeDatabaseKey(kwdb, kwcClass, nObjectNumber);
+	bOk = sCacheFileName != "" and sDatabaseKey != "";
+	if (bOk)
+	{
+		bOpened = FileService::OpenOutputBinaryFile(sCacheFileName, fstCache);
+		bOk = bOpened;
+	}
+
+	// Ecriture de l'entete, de la cle de la base et des ordres de tri
+	if (bOk)
+	{
+		KRSortOrder::WriteBinaryString(fstCache, sCacheFileHeader);
+		KRSortOrder::WriteBinaryString(fstCache, sDatabaseKey);
+		KRSortOrder::WriteBinaryInt(fstCache, oaSortOrders.GetSize());
+		for (nSortOrder = 0; nSortOrder < oaSortOrders.GetSize(); nSortOrder++)
+			cast(KRSortOrder*, oaSortOrders.GetAt(nSortOrder))->WriteBinary(fstCache);
+		bOk = not fstCache.fail();
+		bOk = FileService::CloseOutputBinaryFile(sCacheFileName, fstCache) and bOk;
+	}
+
+	// Warning en cas d'erreur, l'apprentissage n'etant pas impacte
+	if (not bOk and sCacheFileName != "")
+	{
+		AddWarning("Unable to write preprocessing cache file " + sCacheFileName);
+		if (bOpened)
+			FileService::RemoveFile(sCacheFileName);
+	}
+	return bOk;
+}
+
+KRSortOrder* KRPreprocessingCache::LookupSortOrder(const ALString& sAttributeName) const
+{
+	return cast(KRSortOrder*, odSortOrders.Lookup(sAttributeName));
+}
+
+void KRPreprocessingCache::AddSortOrder(KRSortOrder* sortOrder)
+{
+	require(sortOrder != NULL);
+	require(LookupSortOrder(sortOrder->GetAttributeName()) == NULL);
+
+	oaSortOrders.Add(sortOrder);
+	odSortOrders.SetAt(sortOrder->GetAttributeName(), sortOrder);
+}
+
+int KRPreprocessingCache::GetSortOrderNumber() const
+{
+	return oaSortOrders.GetSize();
+}
+
+void KRPreprocessingCache::DeleteAll()
+{
+	odSortOrders.RemoveAll();
+	oaSortOrders.DeleteAll();
+}
+
+const ALString KRPreprocessingCache::BuildCacheFileName(KWDatabase* kwdb) const
+{
+	ALString sDatabaseFileName;
+
+	require(kwdb != NULL);
+
+	// Un fichier de cache par fichier de donnees, dans le repertoire du cache, distingue des fichiers
+	// de meme nom dans d'autres repertoires par le hash du chemin complet
+	sDatabaseFileName = FileService::GetFileName(kwdb->GetDatabaseName());
+	if (sCacheDirectory == "" or sDatabaseFileName == "")
+		return "";
+	return FileService::BuildFilePathName(
+	    sCacheDirectory,
+	    sDatabaseFileName + "." + LongintToString((longint)ComputeHashValue(kwdb->GetDatabaseName())) + ".krcache");
+}
+
+const ALString KRPreprocessingCache::ComputeDatabaseKey(KWDatabase* kwdb, const KWClass* kwcClass, int nObjectNumber) const
+{
+	longint lDatabaseFileSize;
+	ALString sDatabaseKey;
+	KWAttribute* attribute;
+	int nAttribute;
+
+	require(kwdb != NULL);
+	require(kwcClass != NULL);
+	require(nObjectNumber >= 0);
+
+	// Fichier de donnees: chemin et taille (cle vide si le fichier n'existe pas)
+	if (not FileService::FileExists(kwdb->GetDatabaseName()))
+		return "";
+	lDatabaseFileSize = FileService::GetFileSize(kwdb->GetDatabaseName());
+	sDatabaseKey = kwdb->GetDatabaseName() + "\t" + LongintToString(lDatabaseFileSize) + "\n";
+
+	// Parametres de lecture de la base
+	sDatabaseKey += DoubleToString(kwdb->GetSampleNumberPercentage()) + "\t" +
+			BooleanToString(kwdb->GetModeExcludeSample()) + "\t" + kwdb->GetSelectionAttribute() + "\t" +
+			kwdb->GetSelectionValue() + "\n";
+
+	// Dictionnaire: attributs charges
+	sDatabaseKey += kwcClass->GetName() + "\n";
+	for (nAttribute = 0; nAttribute < kwcClass->GetLoadedAttributeNumber(); nAttribute++)
+	{
+		attribute = kwcClass->GetLoadedAttributeAt(nAttribute);
+		sDatabaseKey += attribute->GetName() + "\t" + KWType::ToString(attribute->GetType()) + "\n";
+	}
+
+	// Nombre d'objets lus
+	sDatabaseKey += IntToString(nObjectNumber) + "\n";
+	return sDatabaseKey;
+}
+
+unsigned int KRPreprocessingCache::ComputeHashValue(const ALString& sValue)
+{
+	unsigned int nHash;
+	int i;
+
+	nHash = 2166136261u;
+	for (i = 0; i < sValue.GetLength(); i++)
+	{
+		nHash ^= (unsigned char)sValue.GetAt(i);
+		nHash *= 16777619u;
+	}
+	return nHash;
+}
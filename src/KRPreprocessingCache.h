@@ -0,0 +1,138 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#ifndef KRPREPROCESSINGCACHE_H
+#define KRPREPROCESSINGCACHE_H
+
+class KRSortOrder;
+class KRPreprocessingCache;
+
+#include "Object.h"
+#include "Vector.h"
+#include "KWType.h"
+#include "KWClass.h"
+#include "KWDatabase.h"
+
+////////////////////////////////////////////////////////////////////
+// Classe KRSortOrder
+// Ordre de tri des objets selon un attribut, tel que calcule lors du pretraitement (cf. KRPreprocessedAttribute):
+// rangs des objets (cf. KRObjectCounters) dans l'ordre de tri et, pour un attribut Symbol,
+// plages d'index des valeurs distinctes dans cet ordre
+class KRSortOrder : public Object
+{
+public:
+	// Constructeur
+	KRSortOrder();
+	~KRSortOrder();
+
+	// Nom de l'attribut
+	void SetAttributeName(const ALString& sValue);
+	const ALString& GetAttributeName() const;
+
+	// Type de l'attribut (Symbol ou Continuous)
+	void SetAttributeType(int nValue);
+	int GetAttributeType() const;
+
+	// Rangs des objets dans l'ordre de tri
+	// Memoire: le vecteur rendu appartient a l'appele
+	IntVector* GetSortedObjectRanks();
+
+	// Valeurs distinctes d'un attribut Symbol, dans l'ordre de tri, et index dans l'ordre de tri
+	// du dernier objet de chaque valeur (le premier suivant le dernier de la valeur precedente)
+	// Memoire: les vecteurs rendus appartiennent a l'appele
+	StringVector* GetValues();
+	IntVector* GetValueLastIndexes();
+
+	// Ecriture et lecture au format binaire (false en cas d'erreur de lecture ou de donnees incoherentes)
+	// En lecture, les longueurs lues sont bornees par la taille restant a lire dans le fichier,
+	// et les nombres de rangs et de valeurs par le nombre d'objets de la base
+	void WriteBinary(ostream& ost) const;
+	boolean ReadBinary(istream& ist, longint lFileSize, int nObjectNumber);
+
+	// Services de lecture et ecriture binaire d'entiers, de chaines de caracteres et de vecteurs d'entiers
+	// En lecture, les longueurs sont bornees par la taille restant a lire dans un fichier de taille donnee,
+	// et la taille des vecteurs par une taille maximale
+	static void WriteBinaryInt(ostream& ost, int nValue);
+	static boolean ReadBinaryInt(istream& ist, int& nValue);
+	static void WriteBinaryString(ostream& ost, const ALString& sValue);
+	static boolean ReadBinaryString(istream& ist, longint lFileSize, ALString& sValue);
+	static void WriteBinaryIntVector(ostream& ost, const IntVector* ivValues);
+	static boolean ReadBinaryIntVector(istream& ist, longint lFileSize, int nMaxSize, IntVector* ivValues);
+
+	// Taille restant a lire dans un fichier de taille donnee (-1 en cas d'erreur)
+	static longint GetRemainingSize(istream& ist, longint lFileSize);
+
+	///////////////////////////////////////////////////////
+	///// Implementation
+protected:
+	ALString sAttributeName;
+	int nAttributeType;
+	IntVector ivSortedObjectRanks;
+	StringVector svValues;
+	IntVector ivValueLastIndexes;
+};
+
+////////////////////////////////////////////////////////////////////
+// Classe KRPreprocessingCache
+// Cache persistant des ordres de tri des attributs pretraites d'une base, pour eviter
+// de retrier les objets a chaque apprentissage sur une meme base
+// Un fichier de cache par fichier de donnees est memorise dans le repertoire du cache, de nom construit
+// a partir du nom du fichier de donnees et d'une valeur de hash de son chemin complet
+// Il est identifie par une cle construite a partir du fichier de donnees (chemin et taille),
+// des parametres de lecture de la base (echantillonnage, selection), du dictionnaire (attributs charges)
+// et du nombre d'objets lus; un fichier de cle differente est ignore, puis remplace
+// Les ordres de tri relus sont a valider sur les objets de la base avant utilisation, ce qui protege
+// notamment d'une modification du fichier de donnees sans changement de taille
+class KRPreprocessingCache : public Object
+{
+public:
+	// Constructeur
+	KRPreprocessingCache();
+	~KRPreprocessingCache();
+
+	// Repertoire du cache (vide: pas de cache)
+	void SetCacheDirectory(const ALString& sValue);
+	const ALString& GetCacheDirectory() const;
+
+	// Lecture du fichier de cache d'une base lue, de dictionnaire et de nombre d'objets lus donnes
+	// Renvoie false si le fichier est absent, illisible, ou de cle differente (le cache est alors vide)
+	boolean Load(KWDatabase* kwdb, const KWClass* kwcClass, int nObjectNumber);
+
+	// Ecriture du contenu du cache dans le fichier de cache de la base, avec un warning en cas d'erreur
+	boolean Save(KWDatabase* kwdb, const KWClass* kwcClass, int nObjectNumber);
+
+	// Recherche de l'ordre de tri d'un attribut (NULL si absent)
+	KRSortOrder* LookupSortOrder(const ALString& sAttributeName) const;
+
+	// Ajout d'un ordre de tri, d'attribut non deja present
+	// Memoire: l'ordre de tri appartient au cache
+	void AddSortOrder(KRSortOrder* sortOrder);
+
+	// Nombre d'ordres de tri
+	int GetSortOrderNumber() const;
+
+	// Destruction de tous les ordres de tri
+	void DeleteAll();
+
+	///////////////////////////////////////////////////////
+	///// Implementation
+protected:
+	// Nom du fichier de cache d'une base (vide si la base n'est pas un fichier local)
+	const ALString BuildCacheFileName(KWDatabase* kwdb) const;
+
+	// Cle d'identification d'une base lue (vide si la base n'est pas un fichier local)
+	const ALString ComputeDatabaseKey(KWDatabase* kwdb, const KWClass* kwcClass, int nObjectNumber) const;
+
+	// Valeur de hash d'une chaine de caracteres (FNV-1a), stable d'une execution a l'autre
+	static unsigned int ComputeHashValue(const ALString& sValue);
+
+	// Entete des fichiers de cache, avec la version du format
+	static const ALString sCacheFileHeader;
+
+	ALString sCacheDirectory;
+	ObjectArray oaSortOrders;
+	ObjectDictionary odSortOrders;
+};
+
+#endif // KRPREPROCESSINGCACHE_H
@@ -0,0 +1,210 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#include "KRPreprocessingTask.h"
+#include "KRPreprocessedAttribute.h"
+
+KRPreprocessingTask::KRPreprocessingTask()
+{
+	oaMasterColumns = NULL;
+	oaMasterSortedObjectRanks = NULL;
+	nMasterObjectNumber = 0;
+	nMasterColumnNumber = 0;
+	nMasterNextColumnIndex = 0;
+
+	// Declaration des variables partagees
+	DeclareTaskInput(&input_nColumnIndex);
+	DeclareTaskInput(&input_nAttributeType);
+	DeclareTaskInput(&input_cvValues);
+	DeclareTaskInput(&input_ivValueCodes);
+	DeclareTaskOutput(&output_nColumnIndex);
+	DeclareTaskOutput(&output_ivSortedObjectRanks);
+}
+
+KRPreprocessingTask::~KRPreprocessingTask() {}
+
+boolean KRPreprocessingTask::SortColumns(const ObjectArray* oaColumns, ObjectArray* oaSortedObjectRanks)
+{
+	boolean bOk;
+	KRAttributeColumn* column;
+	int nColumn;
+
+	require(oaColumns != NULL);
+	require(oaSortedObjectRanks != NULL);
+
+	// Initialisation des variables du maitre
+	oaMasterColumns = oaColumns;
+	oaMasterSortedObjectRanks = oaSortedObjectRanks;
+	oaMasterSortedObjectRanks->DeleteAll();
+	oaMasterSortedObjectRanks->SetSize(oaColumns->GetSize());
+	nMasterObjectNumber = 0;
+	nMasterColumnNumber = 0;
+	nMasterNextColumnIndex = 0;
+	for (nColumn = 0; nColumn < oaColumns->GetSize(); nColumn++)
+	{
+		column = cast(KRAttributeColumn*, oaColumns->GetAt(nColumn));
+		if (column != NULL)
+		{
+			assert(nMasterColumnNumber == 0 or column->GetObjectNumber() == nMasterObjectNumber);
+			nMasterObjectNumber = column->GetObjectNumber();
+			nMasterColumnNumber++;
+		}
+	}
+
+	// Lancement de la tache, s'il y a des colonnes a trier
+	bOk = true;
+	if (nMasterColumnNumber > 0)
+		bOk = Run();
+
+	// Nettoyage
+	if (not bOk)
+		oaMasterSortedObjectRanks->DeleteAll();
+	oaMasterColumns = NULL;
+	oaMasterSortedObjectRanks = NULL;
+	return bOk;
+}
+
+const ALString KRPreprocessingTask::GetTaskName() const
+{
+	return "Rule mining preprocessing";
+}
+
+PLParallelTask* KRPreprocessingTask::Create() const
+{
+	return new KRPreprocessingTask;
+}
+
+boolean KRPreprocessingTask::ComputeResourceRequirements()
+{
+	longint lSlaveMemory;
+
+	// Un esclave trie une colonne a la fois: valeurs recues, cles de tri et rangs tries
+	lSlaveMemory = nMasterObjectNumber * (longint)(2 * sizeof(Continuous) + 3 * sizeof(int));
+	GetResourceRequirements()->GetSlaveRequirement()->GetMemory()->Set(lSlaveMemory);
+
+	// Le maitre conserve les rangs tries de toutes les colonnes
+	GetResourceRequirements()->GetMasterRequirement()->GetMemory()->Set(nMasterColumnNumber * nMasterObjectNumber *
+									     (longint)sizeof(int));
+
+	// Au plus un esclave par colonne a trier
+	GetResourceRequirements()->SetMaxSlaveProcessNumber(nMasterColumnNumber);
+	return true;
+}
+
+boolean KRPreprocessingTask::MasterInitialize()
+{
+	require(oaMasterColumns != NULL);
+	require(oaMasterSortedObjectRanks != NULL);
+
+	nMasterNextColumnIndex = 0;
+	return true;
+}
+
+boolean KRPreprocessingTask::MasterPrepareTaskInput(double& dTaskPercent, boolean& bIsTaskFinished)
+{
+	KRAttributeColumn* column;
+	int nRank;
+
+	// Recherche de la prochaine colonne a trier
+	while (nMasterNextColumnIndex < oaMasterColumns->GetSize() and oaMasterColumns->GetAt(nMasterNextColumnIndex) == NULL)
+		nMasterNextColumnIndex++;
+	if (nMasterNextColumnIndex == oaMasterColumns->GetSize())
+	{
+		bIsTaskFinished = true;
+		return true;
+	}
+
+	// Envoi des valeurs de la colonne, selon son type
+	column = cast(KRAttributeColumn*, oaMasterColumns->GetAt(nMasterNextColumnIndex));
+	input_nColumnIndex.SetValue(nMasterNextColumnIndex);
+	input_nAttributeType.SetValue(column->GetAttributeType());
+	input_cvValues.GetContinuousVector()->SetSize(0);
+	input_ivValueCodes.GetIntVector()->SetSize(0);
+	if (column->GetAttributeType() == KWType::Continuous)
+	{
+		input_cvValues.GetContinuousVector()->SetSize(column->GetObjectNumber());
+		for (nRank = 0; nRank < column->GetObjectNumber(); nRank++)
+			input_cvValues.GetContinuousVector()->SetAt(nRank, column->GetContinuousValueAt(nRank));
+	}
+	else
+	{
+		input_ivValueCodes.GetIntVector()->SetSize(column->GetObjectNumber());
+		for (nRank = 0; nRank < column->GetObjectNumber(); nRank++)
+			input_ivValueCodes.GetIntVector()->SetAt(nRank, column->GetSymbolCodeAt(nRank));
+	}
+	dTaskPercent = 1.0 / nMasterColumnNumber;
+	nMasterNextColumnIndex++;
+	return true;
+}
+
+boolean KRPreprocessingTask::MasterAggregateResults()
+{
+	IntVector* ivSortedObjectRanks;
+
+	require(0 <= output_nColumnIndex.GetValue() and output_nColumnIndex.GetValue() < oaMasterSortedObjectRanks->GetSize());
+	require(oaMasterSortedObjectRanks->GetAt(output_nColumnIndex.GetValue()) == NULL);
+	require(output_ivSortedObjectRanks.GetConstIntVector()->GetSize() == nMasterObjectNumber);
+
+	// Memorisation des rangs tries de la colonne
+	ivSortedObjectRanks = new IntVector;
+	ivSortedObjectRanks->CopyFrom(output_ivSortedObjectRanks.GetConstIntVector());
+	oaMasterSortedObjectRanks->SetAt(output_nColumnIndex.GetValue(), ivSortedObjectRanks);
+	return true;
+}
+
+boolean KRPreprocessingTask::MasterFinalize(boolean bProcessEndedCorrectly)
+{
+	return bProcessEndedCorrectly;
+}
+
+boolean KRPreprocessingTask::SlaveInitialize()
+{
+	return true;
+}
+
+boolean KRPreprocessingTask::SlaveProcess()
+{
+	IntVector* ivSortedObjectRanks;
+	Continuous* pcRankValues;
+	int* pnRankValueCodes;
+	int nObjectNumber;
+	int nRank;
+
+	// Rangs des objets dans l'ordre de la base, avant leur tri
+	if (input_nAttributeType.GetValue() == KWType::Continuous)
+		nObjectNumber = input_cvValues.GetConstContinuousVector()->GetSize();
+	else
+		nObjectNumber = input_ivValueCodes.GetConstIntVector()->GetSize();
+	ivSortedObjectRanks = output_ivSortedObjectRanks.GetIntVector();
+	ivSortedObjectRanks->SetSize(nObjectNumber);
+	for (nRank = 0; nRank < nObjectNumber; nRank++)
+		ivSortedObjectRanks->SetAt(nRank, nRank);
+
+	// Tri selon les valeurs, recopiees dans un tableau contigu
+	if (input_nAttributeType.GetValue() == KWType::Continuous)
+	{
+		pcRankValues = new Continuous[nObjectNumber];
+		for (nRank = 0; nRank < nObjectNumber; nRank++)
+			pcRankValues[nRank] = input_cvValues.GetConstContinuousVector()->GetAt(nRank);
+		KRRankSorter::SortRanksOnContinuous(pcRankValues, ivSortedObjectRanks);
+		delete[] pcRankValues;
+	}
+	// Tri selon les codes des valeurs
+	else
+	{
+		assert(input_nAttributeType.GetValue() == KWType::Symbol);
+		pnRankValueCodes = new int[nObjectNumber];
+		for (nRank = 0; nRank < nObjectNumber; nRank++)
+			pnRankValueCodes[nRank] = input_ivValueCodes.GetConstIntVector()->GetAt(nRank);
+		KRRankSorter::SortRanksOnInt(pnRankValueCodes, ivSortedObjectRanks);
+		delete[] pnRankValueCodes;
+	}
+	output_nColumnIndex.SetValue(input_nColumnIndex.GetValue());
+	return true;
+}
+
+boolean KRPreprocessingTask::SlaveFinalize(boolean bProcessEndedCorrectly)
+{
+	return true;
+}
@@ -0,0 +1,80 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#ifndef KRPREPROCESSINGTASK_H
+#define KRPREPROCESSINGTASK_H
+
+#include "Object.h"
+#include "Vector.h"
+#include "PLParallelTask.h"
+#include "PLSharedVector.h"
+#include "KRAttributeColumn.h"
+
+////////////////////////////////////////////////////////////////////
+// Classe KRPreprocessingTask
+// Tache parallele de tri des rangs des objets selon les valeurs de chaque attribut a pretraiter
+// (cf. KRPreprocessedAttribute): chaque esclave recoit la colonne des valeurs d'un attribut
+// (valeurs Continuous, ou codes des valeurs Symbol), et renvoie les rangs des objets tries (cf. KRRankSorter)
+// Le tri de chaque attribut etant independant, les attributs sont traites en parallele par des processus,
+// le runtime Khiops (Symbol, allocateur) ne permettant pas l'utilisation de threads
+// Les attributs pretraites sont ensuite initialises par le maitre a partir des rangs tries, sans tri
+class KRPreprocessingTask : public PLParallelTask
+{
+public:
+	// Constructeur
+	KRPreprocessingTask();
+	~KRPreprocessingTask();
+
+	// Tri des rangs des objets selon chaque colonne d'un tableau de colonnes (KRAttributeColumn) de meme nombre
+	// d'objets, les colonnes NULL etant ignorees
+	// En sortie, tableau des rangs tries de chaque colonne (IntVector), de meme taille et de meme index
+	// que les colonnes (NULL pour les colonnes ignorees)
+	// Renvoie false en cas d'erreur ou d'interruption utilisateur, le tableau en sortie etant alors vide
+	// Memoire: les colonnes sont referencees; les vecteurs en sortie appartiennent a l'appelant
+	boolean SortColumns(const ObjectArray* oaColumns, ObjectArray* oaSortedObjectRanks);
+
+	///////////////////////////////////////////////////////
+	///// Implementation
+protected:
+	// Reimplementation des methodes virtuelles de tache
+	const ALString GetTaskName() const;
+	PLParallelTask* Create() const;
+	boolean ComputeResourceRequirements();
+	boolean MasterInitialize();
+	boolean MasterPrepareTaskInput(double& dTaskPercent, boolean& bIsTaskFinished);
+	boolean MasterAggregateResults();
+	boolean MasterFinalize(boolean bProcessEndedCorrectly);
+	boolean SlaveInitialize();
+	boolean SlaveProcess();
+	boolean SlaveFinalize(boolean bProcessEndedCorrectly);
+
+	//////////////////////////////////////////////////////
+	// Variables du maitre
+
+	// Colonnes a trier (referencees) et rangs tries en sortie
+	const ObjectArray* oaMasterColumns;
+	ObjectArray* oaMasterSortedObjectRanks;
+
+	// Nombre d'objets, nombre de colonnes a trier, et index de la prochaine colonne a envoyer
+	int nMasterObjectNumber;
+	int nMasterColumnNumber;
+	int nMasterNextColumnIndex;
+
+	//////////////////////////////////////////////////////
+	// Entrees et sorties des esclaves
+
+	// Index et type de la colonne a trier
+	PLShared_Int input_nColumnIndex;
+	PLShared_Int input_nAttributeType;
+
+	// Valeurs par rang (attribut Continuous), ou codes des valeurs par rang (attribut Symbol)
+	PLShared_ContinuousVector input_cvValues;
+	PLShared_IntVector input_ivValueCodes;
+
+	// Index de la colonne triee et rangs des objets tries
+	PLShared_Int output_nColumnIndex;
+	PLShared_IntVector output_ivSortedObjectRanks;
+};
+
+#endif // KRPREPROCESSINGTASK_H
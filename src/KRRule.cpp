@@ -17,6 +17,7 @@ KRRule::KRRule()
 	dBodyCost = 0;
 	dOutBodyCost = 0;
 	dNullCost = 0;
+	valuePool = NULL;
 }
 
 KRRule::~KRRule()
@@ -447,6 +448,76 @@ boolean KRRule::CheckAllCosts(const KRRuleCosts* krrCosts)
 	return bOk;
 }
 
+const ALString KRRule::ComputeBodyKey() const
+{
+	ALString sKey;
+	ALString sAttributeKey;
+	StringVector svAttributeKeys;
+	StringVector svValues;
+	KRRAttribute* attribute;
+	KRRInterval* interval;
+	KRRValueSet* valueSet;
+	KRRValue* value;
+	int nAttribute;
+	int nPart;
+	int nIndex;
+	char sBuffer[64];
+
+	// Cle de chaque attribut
+	for (nAttribute = 0; nAttribute < GetAttributeNumber(); nAttribute++)
+	{
+		attribute = GetAttributeAt(nAttribute);
+		sAttributeKey = attribute->GetAttributeName();
+		for (nPart = 0; nPart < attribute->GetPartNumber(); nPart++)
+		{
+			// Seule la partie du corps est prise en compte, sauf pour les attributs portant sur la cible
+			if (nPart != attribute->GetBodyPartIndex() and not attribute->GetAttributeTargetFunction())
+				continue;
+			sAttributeKey += "\t";
+			sAttributeKey += IntToString(nPart);
+
+			// Bornes d'un intervalle, en precision maximale
+			if (attribute->GetAttributeType() == KWType::Continuous)
+			{
+				interval = attribute->GetPartAt(nPart)->GetInterval();
+				snprintf(sBuffer, sizeof(sBuffer), "]%.17g;%.17g]", interval->GetLowerBound(), interval->GetUpperBound());
+				sAttributeKey += sBuffer;
+			}
+			// Valeurs d'un groupe, triees
+			else
+			{
+				valueSet = attribute->GetPartAt(nPart)->GetValueSet();
+				svValues.SetSize(0);
+				value = valueSet->GetHeadValue();
+				while (value != NULL)
+				{
+					svValues.Add(value->GetValue().GetValue());
+					valueSet->GetNextValue(value);
+				}
+				svValues.Sort();
+				sAttributeKey += "{";
+				for (nIndex = 0; nIndex < svValues.GetSize(); nIndex++)
+				{
+					if (nIndex > 0)
+						sAttributeKey += "\x01";
+					sAttributeKey += svValues.GetAt(nIndex);
+				}
+				sAttributeKey += "}";
+			}
+		}
+		svAttributeKeys.Add(sAttributeKey);
+	}
+
+	// Concatenation des cles des attributs triees par nom
+	svAttributeKeys.Sort();
+	for (nAttribute = 0; nAttribute < svAttributeKeys.GetSize(); nAttribute++)
+	{
+		sKey += svAttributeKeys.GetAt(nAttribute);
+		sKey += "\n";
+	}
+	return sKey;
+}
+
 void KRRule::DeleteNonInformativeAttributes()
 {
 	int nAttribute;
@@ -727,6 +798,16 @@ void KRRule::CopyFrom(const KRRule* krrSource)
 	*/
 }
 
+void KRRule::SetValuePool(KRRValuePool* pool)
+{
+	valuePool = pool;
+}
+
+KRRValuePool* KRRule::GetValuePool() const
+{
+	return valuePool;
+}
+
 KRRule* KRRule::Clone() const
 {
 	KRRule* krrClone;
@@ -901,6 +982,24 @@ boolean KRRAttribute::IsInBodySymbol(Symbol sValue) const
 	return bodyPart == LookupSymbolPart(sValue);
 }
 
+KRValueCodeBitset* KRRAttribute::GetBodyValueCodes()
+{
+	return &bsBodyValueCodes;
+}
+
+const KRValueCodeBitset* KRRAttribute::GetBodyValueCodes() const
+{
+	return &bsBodyValueCodes;
+}
+
+boolean KRRAttribute::IsInBodySymbolCode(int nValueCode) const
+{
+	require(GetAttributeType() == KWType::Symbol);
+	require(0 <= nValueCode and nValueCode < bsBodyValueCodes.GetSize());
+
+	return bsBodyValueCodes.Contains(nValueCode);
+}
+
 void KRRAttribute::SetCost(double dValue)
 {
 	dCost = dValue;
@@ -927,6 +1026,10 @@ KRRPart* KRRAttribute::AddPart()
 	// On connecte la partie a l'attribut
 	part->attribute = this;
 
+	// Les valeurs d'une partie symbolique sont allouees dans le pool de la regle
+	if (part->GetValueSet() != NULL and rule != NULL)
+		part->GetValueSet()->SetValuePool(rule->GetValuePool());
+
 	// Ajout en fin de tableau des parties
 	oaParts.Add(part);
 
@@ -1083,27 +1186,17 @@ boolean KRRAttribute::IsIndexed() const
 KRRPart* KRRAttribute::LookupSymbolPart(Symbol sValue) const
 {
 	//KRRPart* part;
-	KRRValue* krrvCurrent;
 
 	//require(IsIndexed());
 	require(GetAttributeType() == KWType::Symbol);
 
-	krrvCurrent = new KRRValue(sValue, 0);
-	if (GetPartAt(0)->GetValueSet()->CheckValue(krrvCurrent))
-	{
-		delete krrvCurrent;
+	// Recherche sans allocation dans les valeurs des parties
+	if (GetPartAt(0)->GetValueSet()->CheckSymbolValue(sValue))
 		return GetPartAt(0);
-	}
-	else if (GetPartAt(1)->GetValueSet()->CheckValue(krrvCurrent))
-	{
-		delete krrvCurrent;
+	else if (GetPartNumber() > 1 and GetPartAt(1)->GetValueSet()->CheckSymbolValue(sValue))
 		return GetPartAt(1);
-	}
 	else
-	{
-		delete krrvCurrent;
 		return NULL;
-	}
 
 	/*part = cast(KRRPart*, nkdParts.Lookup((NUMERIC)sValue.GetNumericKey()));
 	if (part == NULL)
@@ -1260,6 +1353,7 @@ void KRRAttribute::CopyFrom(const KRRAttribute* krraSource)
 			sourcePart = krraSource->GetPartAt(nPart);
 			part = GetPartAt(nPart);
 			part->GetInterval()->CopyFrom(sourcePart->GetInterval());
+			part->SetCost(sourcePart->GetCost());
 		}
 
 		/*DDD
@@ -1274,7 +1368,9 @@ void KRRAttribute::CopyFrom(const KRRAttribute* krraSource)
 			sourcePart = krraSource->GetPartAt(nPart);
 			part = GetPartAt(nPart);
 			part->GetValueSet()->CopyFrom(sourcePart->GetValueSet());
+			part->SetCost(sourcePart->GetCost());
 		}
+		bsBodyValueCodes.CopyFrom(&krraSource->bsBodyValueCodes);
 	}
 }
 
@@ -1518,6 +1614,7 @@ KRRValueSet::KRRValueSet()
 	headValue = NULL;
 	tailValue = NULL;
 	nValueNumber = 0;
+	valuePool = NULL;
 	bIsIndexed = false;
 }
 
@@ -1533,8 +1630,11 @@ KRRValue* KRRValueSet::AddValue(Symbol sValue, int nFrequency)
 
 	require(nFrequency >= 0);
 
-	// Creation de la valeur
-	value = new KRRValue(sValue, nFrequency);
+	// Creation de la valeur, dans le pool le cas echeant
+	if (valuePool != NULL)
+		value = valuePool->NewValue(sValue, nFrequency);
+	else
+		value = new KRRValue(sValue, nFrequency);
 
 	// Ajout en fin de la liste des valeurs
 	nValueNumber++;
@@ -1566,8 +1666,15 @@ void KRRValueSet::DeleteValue(KRRValue* value)
 	if (tailValue == value)
 		tailValue = value->prevValue;
 
-	// Destruction de la valeur
-	delete value;
+	// Destruction de la valeur, ou restitution au pool
+	if (valuePool != NULL)
+	{
+		value->prevValue = NULL;
+		value->nextValue = NULL;
+		valuePool->ReleaseValue(value);
+	}
+	else
+		delete value;
 }
 
 void KRRValueSet::DeleteAllValues()
@@ -1575,13 +1682,21 @@ void KRRValueSet::DeleteAllValues()
 	KRRValue* value;
 	KRRValue* valueToDelete;
 
-	// Destruction des valeurs
-	value = headValue;
-	while (value != NULL)
+	// Restitution de la liste des valeurs au pool en temps constant, ou destruction des valeurs
+	if (valuePool != NULL)
 	{
-		valueToDelete = value;
-		value = value->nextValue;
-		delete valueToDelete;
+		if (headValue != NULL)
+			valuePool->ReleaseValueList(headValue, tailValue, nValueNumber);
+	}
+	else
+	{
+		value = headValue;
+		while (value != NULL)
+		{
+			valueToDelete = value;
+			value = value->nextValue;
+			delete valueToDelete;
+		}
 	}
 
 	// Reinitialisation de la gestion de la liste des valeurs
@@ -1595,6 +1710,17 @@ int KRRValueSet::GetValueNumber() const
 	return nValueNumber;
 }
 
+void KRRValueSet::SetValuePool(KRRValuePool* pool)
+{
+	require(GetValueNumber() == 0);
+	valuePool = pool;
+}
+
+KRRValuePool* KRRValueSet::GetValuePool() const
+{
+	return valuePool;
+}
+
 KRRValue* KRRValueSet::GetHeadValue() const
 {
 	return headValue;
@@ -1655,12 +1781,16 @@ boolean KRRValueSet::IsIndexed() const
 }
 
 boolean KRRValueSet::CheckValue(KRRValue* value) const
+{
+	require(value != NULL);
+	return CheckSymbolValue(value->GetValue());
+}
+
+boolean KRRValueSet::CheckSymbolValue(Symbol sValue) const
 {
 	boolean bOk;
 	KRRValue* currentValue;
-	Symbol sValue;
 
-	require(value != NULL);
 	/*require(IsIndexed());
 
 	sValue = value->GetValue();
@@ -1679,7 +1809,7 @@ boolean KRRValueSet::CheckValue(KRRValue* value) const
 	while (currentValue != NULL)
 	{
 		// comparaison de la valeur seulement
-		if (value->GetValue() == currentValue->GetValue())
+		if (sValue == currentValue->GetValue())
 		{
 			bOk = true;
 			break;
@@ -1898,6 +2028,80 @@ void KRRValue::Write(ostream& ost) const
 	ost << sSymbolValue << "\t" << nValueFrequency;
 }
 
+///////////////////////////////////////////////////
+// KRRValuePool
+
+KRRValuePool::KRRValuePool()
+{
+	freeValue = NULL;
+	nFreeValueNumber = 0;
+}
+
+KRRValuePool::~KRRValuePool()
+{
+	DeleteAll();
+}
+
+KRRValue* KRRValuePool::NewValue(Symbol sValue, int nFrequency)
+{
+	KRRValue* value;
+
+	require(nFrequency >= 0);
+
+	// Creation si pas de valeur libre
+	if (freeValue == NULL)
+		return new KRRValue(sValue, nFrequency);
+
+	// Reutilisation sinon de la premiere valeur libre
+	value = freeValue;
+	freeValue = value->nextValue;
+	nFreeValueNumber--;
+	value->sSymbolValue = sValue;
+	value->nValueFrequency = nFrequency;
+	value->prevValue = NULL;
+	value->nextValue = NULL;
+	return value;
+}
+
+void KRRValuePool::ReleaseValue(KRRValue* value)
+{
+	require(value != NULL);
+
+	value->nextValue = freeValue;
+	freeValue = value;
+	nFreeValueNumber++;
+}
+
+void KRRValuePool::ReleaseValueList(KRRValue* headValue, KRRValue* tailValue, int nValueNumber)
+{
+	require(headValue != NULL and tailValue != NULL);
+	require(headValue->prevValue == NULL and tailValue->nextValue == NULL);
+	require(nValueNumber > 0);
+
+	// Insertion de la liste en tete des valeurs libres, le chainage suivant etant conserve
+	tailValue->nextValue = freeValue;
+	freeValue = headValue;
+	nFreeValueNumber += nValueNumber;
+}
+
+int KRRValuePool::GetFreeValueNumber() const
+{
+	return nFreeValueNumber;
+}
+
+void KRRValuePool::DeleteAll()
+{
+	KRRValue* value;
+
+	while (freeValue != NULL)
+	{
+		value = freeValue;
+		freeValue = value->nextValue;
+		delete value;
+	}
+	nFreeValueNumber = 0;
+}
+
 int KRRValueCompareDecreasingFrequency(const void* elem1, const void* elem2)
 {
 	KRRValue* value1;
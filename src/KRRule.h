@@ -16,6 +16,7 @@ class KRRPart;
 class KRRInterval;
 class KRRValueSet;
 class KRRValue;
+class KRRValuePool;
 
 #include "Vector.h"
 #include "KWType.h"
@@ -23,6 +24,7 @@ class KRRValue;
 #include "KWContinuous.h"
 #include "KWDatabase.h"
 #include "KRRuleCosts.h"
+#include "KRValueCodeBitset.h"
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Classe KRRule
@@ -147,6 +149,13 @@ public:
 	void InitializeAllCosts(const KRRuleCosts* krrCosts);
 	boolean CheckAllCosts(const KRRuleCosts* krrCosts);
 
+	// Parametrage d'un pool de valeurs, utilise par les ensembles de valeurs des parties crees ensuite
+	// (NULL par defaut: allocation et destruction individuelles des valeurs)
+	// Le pool n'est pas recopie par CopyFrom, ce qui permet de recopier une regle hors du pool
+	// Memoire: le pool est reference, et doit etre detruit apres la regle
+	void SetValuePool(KRRValuePool* pool);
+	KRRValuePool* GetValuePool() const;
+
 	// Nettoyage des attributs non informatifs (reduits a une seules partie)
 	// Prerequis: les attributs doivent etre initialises avec leur partition en intervalles/groupes,
 	// mais aucune cellule ne doit etre cree
@@ -156,6 +165,11 @@ public:
 	int GetInformativeAttributeNumber() const;
 	int ComputeInformativeAttributeNumber();
 
+	// Cle canonique du corps de la regle, identique pour deux regles de memes attributs, bornes
+	// et groupes de valeurs du corps, quel que soit l'ordre des attributs et des valeurs
+	// Les attributs portant sur la cible sont pris en compte avec toutes leurs parties
+	const ALString ComputeBodyKey() const;
+
 	// Nettoyage complet
 	void DeleteAll();
 
@@ -226,6 +240,9 @@ protected:
 
 	double dNullCost;
 	//double dLevel; //
+
+	// Pool des valeurs des ensembles de valeurs
+	KRRValuePool* valuePool;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -282,6 +299,17 @@ public:
 	boolean IsInBodyContinuous(Continuous cValue) const;
 	boolean IsInBodySymbol(Symbol sValue) const;
 
+	// Ensemble des codes des valeurs du corps, pour un attribut symbolique dont les codes sont ceux
+	// des valeurs pretraitees (cf. KRPreprocessedSymbolAttribute)
+	// L'ensemble est tenu a jour par l'optimiseur de regle lors de l'initialisation de l'attribut et des
+	// deplacements de valeurs, et permet de tester l'appartenance au corps d'une valeur par son code en O(1)
+	// Il est vide (de taille 0) tant qu'il n'a pas ete initialise
+	KRValueCodeBitset* GetBodyValueCodes();
+	const KRValueCodeBitset* GetBodyValueCodes() const;
+
+	// Indique si une valeur symbolique, designee par son code, est dans le bodyPart
+	boolean IsInBodySymbolCode(int nValueCode) const;
+
 	// Cout local d'un attribut
 	void SetCost(double dValue);
 	double GetCost() const;
@@ -375,6 +403,9 @@ protected:
 	KRRPart* starValuePart;
 	boolean bIsIndexed;
 
+	// Codes des valeurs du corps dans le cas symbolique
+	KRValueCodeBitset bsBodyValueCodes;
+
 	// Cout
 	double dCost;
 };
@@ -516,6 +547,12 @@ public:
 	// Nombre de valeurs
 	int GetValueNumber() const;
 
+	// Pool dans lequel sont allouees et restituees les valeurs (NULL par defaut)
+	// A parametrer sur un ensemble de valeurs vide
+	// Memoire: le pool est reference, et doit etre detruit apres l'ensemble de valeurs
+	void SetValuePool(KRRValuePool* pool);
+	KRRValuePool* GetValuePool() const;
+
 	// Parcours de tous les valeurs
 	KRRValue* GetHeadValue() const;
 	KRRValue* GetTailValue() const;
@@ -542,6 +579,9 @@ public:
 	// Test de validite d'une valeur (si elle appartient a la partie)
 	boolean CheckValue(KRRValue* value) const;
 
+	// Test d'appartenance d'une valeur symbolique a la partie, sans allocation
+	boolean CheckSymbolValue(Symbol sValue) const;
+
 	///////////////////////////////
 	// Services divers
 
@@ -584,6 +624,7 @@ protected:
 	KRRValue* headValue;
 	KRRValue* tailValue;
 	int nValueNumber;
+	KRRValuePool* valuePool;
 	NumericKeyDictionary nkdValues;
 	boolean bIsIndexed;
 };
@@ -613,6 +654,7 @@ public:
 	///// Implementation
 protected:
 	friend class KRRValueSet;
+	friend class KRRValuePool;
 
 	// Attributs
 	Symbol sSymbolValue;
@@ -621,6 +663,42 @@ protected:
 	KRRValue* nextValue;
 };
 
+//////////////////////////////////////////////////////////////////////////////
+// Classe KRRValuePool
+// Pool de valeurs symboliques, recyclees entre les regles successives d'une extraction de regles
+// Les valeurs restituees sont chainees dans une liste de valeurs libres, reutilisees par les allocations
+// suivantes: une liste de valeurs d'un ensemble de valeurs est restituee en temps constant, sans destruction
+// Les valeurs libres conservent leur Symbol jusqu'a leur reutilisation ou la destruction du pool
+class KRRValuePool : public Object
+{
+public:
+	// Constructeur
+	KRRValuePool();
+	~KRRValuePool();
+
+	// Allocation d'une valeur, reutilisant une valeur libre si possible
+	KRRValue* NewValue(Symbol sValue, int nFrequency);
+
+	// Restitution d'une valeur
+	void ReleaseValue(KRRValue* value);
+
+	// Restitution d'une liste doublement chainee de valeurs, de taille donnee, en temps constant
+	void ReleaseValueList(KRRValue* headValue, KRRValue* tailValue, int nValueNumber);
+
+	// Nombre de valeurs libres
+	int GetFreeValueNumber() const;
+
+	// Destruction des valeurs libres
+	void DeleteAll();
+
+	///////////////////////////////
+	///// Implementation
+protected:
+	// Liste simplement chainee des valeurs libres
+	KRRValue* freeValue;
+	int nFreeValueNumber;
+};
+
 // Comparaison de deux valeurs symboliques, par effectif decroissant
 int KRRValueCompareDecreasingFrequency(const void* elem1, const void* elem2);
 
@@ -13,6 +13,9 @@ KRRuleCosts::KRRuleCosts()
 {
 	dEpsilon = 1e-5;
 	classStats = NULL;
+	dDatasetNullRuleCost = 0;
+	nCostTableInstanceNumber = 0;
+	bCostTablesInitialized = false;
 }
 
 
@@ -36,6 +39,60 @@ KWClassStats* KRRuleCosts::GetClassStats() const
 	return classStats;
 }
 
+void KRRuleCosts::InitializeCostTables()
+{
+	int nMaxValue;
+	int nValue;
+	int nInformativeAttributeNumber;
+
+	require(GetClassStats() != NULL);
+	require(GetClassStats()->IsStatsComputed());
+
+	CleanCostTables();
+
+	// Table des ln(n!) pour n de 0 a N+J, avec J le nombre de valeurs cibles (classes ou valeurs distinctes
+	// en regression, majorant du nombre de parties de l'attribut cible)
+	nCostTableInstanceNumber = GetClassStats()->GetInstanceNumber();
+	nMaxValue = nCostTableInstanceNumber + GetClassStats()->GetTargetDescriptiveStats()->GetValueNumber();
+	dvLnFactorials.SetSize(nMaxValue + 1);
+	for (nValue = 0; nValue <= nMaxValue; nValue++)
+		dvLnFactorials.SetAt(nValue, KWStat::LnFactorial(nValue));
+
+	// Couts de regle par nombre d'attributs informatifs
+	dvRuleCosts.SetSize(GetTotalAttributeNumber() + 1);
+	for (nInformativeAttributeNumber = 0; nInformativeAttributeNumber <= GetTotalAttributeNumber(); nInformativeAttributeNumber++)
+		dvRuleCosts.SetAt(nInformativeAttributeNumber, ComputeRuleSelectionCost(nInformativeAttributeNumber));
+
+	// Cout de la regle nulle, qui ne depend que de la base
+	dDatasetNullRuleCost = ComputeDatasetNullRuleCost();
+	bCostTablesInitialized = true;
+}
+
+void KRRuleCosts::CleanCostTables()
+{
+	dvLnFactorials.SetSize(0);
+	dvRuleCosts.SetSize(0);
+	dDatasetNullRuleCost = 0;
+	nCostTableInstanceNumber = 0;
+	bCostTablesInitialized = false;
+}
+
+boolean KRRuleCosts::AreCostTablesInitialized() const
+{
+	return bCostTablesInitialized;
+}
+
+double KRRuleCosts::ComputeRuleSelectionCost(int nInformativeAttributeNumber) const
+{
+	require(nInformativeAttributeNumber >= 0);
+	return 0;
+}
+
+double KRRuleCosts::ComputeDatasetNullRuleCost() const
+{
+	return 0;
+}
+
 double KRRuleCosts::ComputeRuleCost(const KRRule* rule, int nInformativeAttributeNumber) const
 {
 	require(rule != NULL);
@@ -90,6 +147,44 @@ double KRRuleCosts::ComputeOutBodyCost(const KRRule* rule) const
 }
 
 
+double KRRuleCosts::ComputeBodyCostWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const
+{
+	require(rule != NULL);
+	return 0;
+}
+
+double KRRuleCosts::ComputeOutBodyCostWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const
+{
+	require(rule != NULL);
+	return 0;
+}
+
+double KRRuleCosts::ComputeRuleLevelWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const
+{
+	double dTotalCost;
+
+	require(rule != NULL);
+	require(ivTargetValueFrequencyDiffs != NULL);
+
+	// Seuls les couts du corps et de l'exterieur dependent des effectifs
+	dTotalCost = rule->GetTotalCost() - rule->GetBodyCost() - rule->GetOutBodyCost();
+	dTotalCost += ComputeBodyCostWithDiff(rule, ivTargetValueFrequencyDiffs);
+	dTotalCost += ComputeOutBodyCostWithDiff(rule, ivTargetValueFrequencyDiffs);
+	if (rule->GetNullCost() != 0)
+		return 1 - dTotalCost / rule->GetNullCost();
+	else
+		return 0;
+}
+
+double KRRuleCosts::ComputeAttributeLevelUpperBound(const KRRule* rule, const KRRAttribute* attribute,
+	const IntVector* ivWorkingTargetFrequencies) const
+{
+	require(rule != NULL);
+	require(attribute != NULL);
+	require(ivWorkingTargetFrequencies != NULL);
+	return 1;
+}
+
 double KRRuleCosts::ComputeRuleCompressionCoefficient(const KRRule* rule) const
 {
 	double dTotalCost;
@@ -636,6 +731,7 @@ const ALString KRRuleCosts::GetClassLabel() const
 
 KRRuleClassificationCosts::KRRuleClassificationCosts()
 {
+	dEpsilon = 1e-5;
 }
 
 
@@ -646,20 +742,33 @@ KRRuleClassificationCosts::~KRRuleClassificationCosts()
 
 double KRRuleClassificationCosts::ComputeRuleCost(const KRRule* rule, int nInformativeAttributeNumber) const
 {
-	double dRuleCost;
-
 	require(rule != NULL);
 	require(nInformativeAttributeNumber >= 0);
 	require(nInformativeAttributeNumber <= GetTotalAttributeNumber());
 
+	// Cout precalcule si disponible
+	if (nInformativeAttributeNumber < dvRuleCosts.GetSize())
+	{
+		assert(fabs(dvRuleCosts.GetAt(nInformativeAttributeNumber) - ComputeRuleSelectionCost(nInformativeAttributeNumber)) < dEpsilon);
+		return dvRuleCosts.GetAt(nInformativeAttributeNumber);
+	}
+	return ComputeRuleSelectionCost(nInformativeAttributeNumber);
+}
+
+double KRRuleClassificationCosts::ComputeRuleSelectionCost(int nInformativeAttributeNumber) const
+{
+	double dRuleCost;
+
+	require(nInformativeAttributeNumber >= 0);
+
 	// Cout de selection des variables
 	dRuleCost = 0;
 	if (GetTotalAttributeNumber() > 0)
 	{
 		dRuleCost += log(GetTotalAttributeNumber() + 1.0);
-		dRuleCost += KWStat::LnFactorial(GetTotalAttributeNumber() + nInformativeAttributeNumber - 1);
-		dRuleCost -= KWStat::LnFactorial(GetTotalAttributeNumber() - 1);
-		dRuleCost -= KWStat::LnFactorial(nInformativeAttributeNumber);
+		dRuleCost += LnFactorial(GetTotalAttributeNumber() + nInformativeAttributeNumber - 1);
+		dRuleCost -= LnFactorial(GetTotalAttributeNumber() - 1);
+		dRuleCost -= LnFactorial(nInformativeAttributeNumber);
 	}
 	return dRuleCost;
 }
@@ -697,9 +806,9 @@ double KRRuleClassificationCosts::ComputeAttributeCost(const KRRAttribute* attri
 			dAttributeCost += log(1.0 + dTemp);
 
 			// Cout de codage des intervalles
-			dAttributeCost += KWStat::LnFactorial(nValueNumber - 1);
-			dAttributeCost -= KWStat::LnFactorial(nValueNumber - nPartitionSize);
-			dAttributeCost -= KWStat::LnFactorial(nPartitionSize - 1);
+			dAttributeCost += LnFactorial(nValueNumber - 1);
+			dAttributeCost -= LnFactorial(nValueNumber - nPartitionSize);
+			dAttributeCost -= LnFactorial(nPartitionSize - 1);
 		}
 		// Cout de structure si attribut symbolique
 		else
@@ -741,55 +850,149 @@ double KRRuleClassificationCosts::ComputePartUnionCost(const KRRPart* part1, con
 
 
 double KRRuleClassificationCosts::ComputeBodyCost(const KRRule* rule) const
+{
+	return ComputeBodyCostWithDiff(rule, NULL);
+}
+
+double KRRuleClassificationCosts::ComputeOutBodyCost(const KRRule* rule) const
+{
+	return ComputeOutBodyCostWithDiff(rule, NULL);
+}
+
+double KRRuleClassificationCosts::ComputeBodyCostWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const
 {
 	double dBodyCost;
 	int nBodyFrequency;
+	int nFrequency;
 	int nIndex;
 
 	require(rule != NULL);
-	//require(bodyPart->GetAttribute()->GetPartAt(bodyPart->GetAttribute()->GetBodyPartIndex()) == part);
+	require(ivTargetValueFrequencyDiffs == NULL or ivTargetValueFrequencyDiffs->GetSize() == rule->GetTargetValueNumber());
 
 	nBodyFrequency = 0;
 	dBodyCost = 0;
 
 	for (nIndex = 0; nIndex < rule->GetTargetValueNumber(); nIndex++)
 	{
-		nBodyFrequency += rule->GetInBodyTargetValueFrequencyAt(nIndex);
-		dBodyCost -= KWStat::LnFactorial(rule->GetInBodyTargetValueFrequencyAt(nIndex));
+		nFrequency = rule->GetInBodyTargetValueFrequencyAt(nIndex);
+		if (ivTargetValueFrequencyDiffs != NULL)
+			nFrequency += ivTargetValueFrequencyDiffs->GetAt(nIndex);
+		assert(nFrequency >= 0);
+		nBodyFrequency += nFrequency;
+		dBodyCost -= LnFactorial(nFrequency);
 	}
 
-	ensure(nBodyFrequency == rule->GetInBodyTotalFrequency());
+	ensure(ivTargetValueFrequencyDiffs != NULL or nBodyFrequency == rule->GetInBodyTotalFrequency());
 
-	dBodyCost += KWStat::LnFactorial(nBodyFrequency + rule->GetTargetValueNumber() - 1);
-	dBodyCost -= KWStat::LnFactorial(rule->GetTargetValueNumber() - 1);
+	dBodyCost += LnFactorial(nBodyFrequency + rule->GetTargetValueNumber() - 1);
+	dBodyCost -= LnFactorial(rule->GetTargetValueNumber() - 1);
 
 	// simplification du log(NX)! du prior et de la vraisemblance
 	return dBodyCost;
 }
 
-double KRRuleClassificationCosts::ComputeOutBodyCost(const KRRule* rule) const
+double KRRuleClassificationCosts::ComputeOutBodyCostWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const
 {
 	double dOutBodyCost;
 	int nOutBodyFrequency;
+	int nFrequency;
 	int nIndex;
 
 	require(rule != NULL);
-	//require(bodyPart->GetAttribute()->GetPartAt(bodyPart->GetAttribute()->GetBodyPartIndex()) == part);
+	require(ivTargetValueFrequencyDiffs == NULL or ivTargetValueFrequencyDiffs->GetSize() == rule->GetTargetValueNumber());
 
-	nOutBodyFrequency = rule->GetTotalFrequency() - rule->GetInBodyTotalFrequency();
+	nOutBodyFrequency = 0;
 	dOutBodyCost = 0;
 
 	for (nIndex = 0; nIndex < rule->GetTargetValueNumber(); nIndex++)
 	{
-		dOutBodyCost -= KWStat::LnFactorial(rule->GetTargetValueFrequencyAt(nIndex) - rule->GetInBodyTargetValueFrequencyAt(nIndex));
+		nFrequency = rule->GetTargetValueFrequencyAt(nIndex) - rule->GetInBodyTargetValueFrequencyAt(nIndex);
+		if (ivTargetValueFrequencyDiffs != NULL)
+			nFrequency -= ivTargetValueFrequencyDiffs->GetAt(nIndex);
+		assert(nFrequency >= 0);
+		nOutBodyFrequency += nFrequency;
+		dOutBodyCost -= LnFactorial(nFrequency);
 	}
-	dOutBodyCost += KWStat::LnFactorial(nOutBodyFrequency + rule->GetTargetValueNumber() - 1);
-	dOutBodyCost -= KWStat::LnFactorial(rule->GetTargetValueNumber() - 1);
+	assert(ivTargetValueFrequencyDiffs != NULL or nOutBodyFrequency == rule->GetTotalFrequency() - rule->GetInBodyTotalFrequency());
+	dOutBodyCost += LnFactorial(nOutBodyFrequency + rule->GetTargetValueNumber() - 1);
+	dOutBodyCost -= LnFactorial(rule->GetTargetValueNumber() - 1);
 
 	// simplification du log(NnonX)! du prior et de la vraisemblance
 	return dOutBodyCost;
 }
 
+double KRRuleClassificationCosts::ComputeAttributeLevelUpperBound(const KRRule* rule, const KRRAttribute* attribute,
+	const IntVector* ivWorkingTargetFrequencies) const
+{
+	double dStructureCost;
+	double dRemainderCost;
+	double dDataCost;
+	double dMinDataCost;
+	int nInformativeAttributeNumber;
+	int nAttribute;
+	int nTarget;
+	int nTargetNumber;
+	int nTotalFrequency;
+	int nWorkingFrequency;
+	int nRemainderFrequency;
+	int nMaxRemainderFrequency;
+	int nBodyFrequency;
+
+	require(rule != NULL);
+	require(attribute != NULL);
+	require(ivWorkingTargetFrequencies != NULL);
+	require(ivWorkingTargetFrequencies->GetSize() == rule->GetTargetValueNumber());
+
+	// Pas de majorant si le cout de la regle nulle n'est pas positif
+	if (rule->GetNullCost() <= 0)
+		return 1;
+
+	// Minorant du cout de structure: cout des autres attributs, l'attribut optimise pouvant devenir non informatif
+	dStructureCost = 0;
+	nInformativeAttributeNumber = 0;
+	for (nAttribute = 0; nAttribute < rule->GetAttributeNumber(); nAttribute++)
+	{
+		if (rule->GetAttributeAt(nAttribute) != attribute)
+		{
+			dStructureCost += rule->GetAttributeAt(nAttribute)->GetCost();
+			if (rule->GetAttributeAt(nAttribute)->GetPartNumber() > 1)
+				nInformativeAttributeNumber++;
+		}
+	}
+	dStructureCost += ComputeRuleCost(rule, nInformativeAttributeNumber);
+
+	// Instances hors instances de travail, exterieures au corps quel que soit le corps optimise
+	nTargetNumber = rule->GetTargetValueNumber();
+	nTotalFrequency = 0;
+	nWorkingFrequency = 0;
+	nMaxRemainderFrequency = 0;
+	dRemainderCost = 0;
+	for (nTarget = 0; nTarget < nTargetNumber; nTarget++)
+	{
+		nRemainderFrequency = rule->GetTargetValueFrequencyAt(nTarget) - ivWorkingTargetFrequencies->GetAt(nTarget);
+		assert(nRemainderFrequency >= 0);
+		nTotalFrequency += rule->GetTargetValueFrequencyAt(nTarget);
+		nWorkingFrequency += ivWorkingTargetFrequencies->GetAt(nTarget);
+		dRemainderCost -= LnFactorial(nRemainderFrequency);
+		if (nRemainderFrequency > nMaxRemainderFrequency)
+			nMaxRemainderFrequency = nRemainderFrequency;
+	}
+
+	// Minorant des couts du corps et de l'exterieur, minimise sur la taille du corps
+	dMinDataCost = 0;
+	for (nBodyFrequency = 0; nBodyFrequency <= nWorkingFrequency; nBodyFrequency++)
+	{
+		dDataCost = LnFactorial(nBodyFrequency + nTargetNumber - 1) - LnFactorial(nBodyFrequency);
+		dDataCost += LnFactorial(nTotalFrequency - nBodyFrequency + nTargetNumber - 1) + dRemainderCost;
+		dDataCost += LnFactorial(nMaxRemainderFrequency) - LnFactorial(nMaxRemainderFrequency + nWorkingFrequency - nBodyFrequency);
+		if (nBodyFrequency == 0 or dDataCost < dMinDataCost)
+			dMinDataCost = dDataCost;
+	}
+	dMinDataCost -= 2 * LnFactorial(nTargetNumber - 1);
+
+	return 1 - (dStructureCost + dMinDataCost) / rule->GetNullCost();
+}
+
 
 double KRRuleClassificationCosts::ComputeRuleCompressionCoefficient(const KRRule* rule) const
 {
@@ -803,21 +1006,59 @@ double KRRuleClassificationCosts::ComputeRuleCompressionCoefficient(const KRRule
 }
 
 double KRRuleClassificationCosts::ComputeNullRuleCost(const KRRule* rule) const
+{
+	require(GetTotalAttributeNumber() != 0);
+	require(IsInitialized());
+
+	// Cout precalcule pour la base, les effectifs par classe de la regle etant ceux de la base
+	if (AreCostTablesInitialized() and rule->GetTotalFrequency() == nCostTableInstanceNumber)
+	{
+		assert(fabs(dDatasetNullRuleCost - ComputeRuleNullRuleCost(rule)) < dEpsilon);
+		return dDatasetNullRuleCost;
+	}
+	return ComputeRuleNullRuleCost(rule);
+}
+
+double KRRuleClassificationCosts::ComputeRuleNullRuleCost(const KRRule* rule) const
+{
+	IntVector ivTargetFrequencies;
+	int nIndex;
+
+	require(rule != NULL);
+
+	ivTargetFrequencies.SetSize(rule->GetTargetValueNumber());
+	for (nIndex = 0; nIndex < rule->GetTargetValueNumber(); nIndex++)
+		ivTargetFrequencies.SetAt(nIndex, rule->GetTargetValueFrequencyAt(nIndex));
+	return ComputeNullRuleCostFromFrequencies(rule->GetTotalFrequency(), &ivTargetFrequencies);
+}
+
+double KRRuleClassificationCosts::ComputeDatasetNullRuleCost() const
+{
+	IntVector ivPartFrequencies;
+
+	require(GetClassStats() != NULL);
+
+	// Effectifs par classe de la base, dans l'ordre des valeurs cibles des regles (cf. KRRuleOptimizer::InitializeRule)
+	GetClassStats()->GetTargetValueStats()->ExportAttributePartFrequenciesAt(GetClassStats()->GetTargetValueStats()->GetFirstTargetAttributeIndex(),
+		&ivPartFrequencies);
+	return ComputeNullRuleCostFromFrequencies(GetClassStats()->GetInstanceNumber(), &ivPartFrequencies);
+}
+
+double KRRuleClassificationCosts::ComputeNullRuleCostFromFrequencies(int nTotalFrequency, const IntVector* ivTargetFrequencies) const
 {
 	double dNullRuleCost;
 	int nIndex;
 
-	require(GetTotalAttributeNumber() != 0);
-	require(IsInitialized());
+	require(ivTargetFrequencies != NULL);
 
 	dNullRuleCost = log(GetTotalAttributeNumber() + 1.0)
-		+ KWStat::LnFactorial(rule->GetTotalFrequency() + rule->GetTargetValueNumber() - 1)
-		- KWStat::LnFactorial(rule->GetTargetValueNumber() - 1)
-		- KWStat::LnFactorial(rule->GetTotalFrequency());
-	dNullRuleCost += KWStat::LnFactorial(rule->GetTotalFrequency());
-	for (nIndex = 0; nIndex < rule->GetTargetValueNumber(); nIndex++)
+		+ LnFactorial(nTotalFrequency + ivTargetFrequencies->GetSize() - 1)
+		- LnFactorial(ivTargetFrequencies->GetSize() - 1)
+		- LnFactorial(nTotalFrequency);
+	dNullRuleCost += LnFactorial(nTotalFrequency);
+	for (nIndex = 0; nIndex < ivTargetFrequencies->GetSize(); nIndex++)
 	{
-		dNullRuleCost -= KWStat::LnFactorial(rule->GetTargetValueFrequencyAt(nIndex));
+		dNullRuleCost -= LnFactorial(ivTargetFrequencies->GetAt(nIndex));
 	}
 	return dNullRuleCost;
 }
@@ -1385,6 +1626,7 @@ const ALString KRRuleClassificationCosts::GetClassLabel() const
 
 KRRuleRegressionCosts::KRRuleRegressionCosts()
 {
+	dEpsilon = 1e-5;
 }
 
 
@@ -1394,20 +1636,33 @@ KRRuleRegressionCosts::~KRRuleRegressionCosts()
 
 double KRRuleRegressionCosts::ComputeRuleCost(const KRRule* rule, int nInformativeAttributeNumber) const
 {
-	double dRuleCost;
-
 	require(rule != NULL);
 	require(nInformativeAttributeNumber >= 0);
 	require(nInformativeAttributeNumber <= GetTotalAttributeNumber());
 
+	// Cout precalcule si disponible
+	if (nInformativeAttributeNumber < dvRuleCosts.GetSize())
+	{
+		assert(fabs(dvRuleCosts.GetAt(nInformativeAttributeNumber) - ComputeRuleSelectionCost(nInformativeAttributeNumber)) < dEpsilon);
+		return dvRuleCosts.GetAt(nInformativeAttributeNumber);
+	}
+	return ComputeRuleSelectionCost(nInformativeAttributeNumber);
+}
+
+double KRRuleRegressionCosts::ComputeRuleSelectionCost(int nInformativeAttributeNumber) const
+{
+	double dRuleCost;
+
+	require(nInformativeAttributeNumber >= 0);
+
 	// Cout de selection des variables + cout de la varibale classe numerique
 	dRuleCost = 0;
 	if (GetTotalAttributeNumber() > 0)
 	{
 		dRuleCost += log(GetTotalAttributeNumber() + 1.0); // log(m+1)
-		dRuleCost += KWStat::LnFactorial(GetTotalAttributeNumber() + nInformativeAttributeNumber - 1); // log(m+k-1)!
-		dRuleCost -= KWStat::LnFactorial(GetTotalAttributeNumber() - 1); // log(m+k-1-k)!
-		dRuleCost -= KWStat::LnFactorial(nInformativeAttributeNumber); // log(k)!
+		dRuleCost += LnFactorial(GetTotalAttributeNumber() + nInformativeAttributeNumber - 1); // log(m+k-1)!
+		dRuleCost -= LnFactorial(GetTotalAttributeNumber() - 1); // log(m+k-1-k)!
+		dRuleCost -= LnFactorial(nInformativeAttributeNumber); // log(k)!
 	}
 	return dRuleCost;
 }
@@ -1441,7 +1696,7 @@ double KRRuleRegressionCosts::ComputeAttributeCost(const KRRAttribute* attribute
 				// Partie likelihood specifique a la variable cible numerique
 				for (nIndex=0; nIndex < attribute->GetPartNumber(); nIndex++)
 				{
-					dAttributeCost += KWStat::LnFactorial(attribute->GetRule()->GetTargetValueFrequencyAt(nIndex));
+					dAttributeCost += LnFactorial(attribute->GetRule()->GetTargetValueFrequencyAt(nIndex));
 				}
 			}
 			else // autre attribut pas cible
@@ -1457,9 +1712,9 @@ double KRRuleRegressionCosts::ComputeAttributeCost(const KRRAttribute* attribute
 				dAttributeCost += log(1.0 + dTemp);
 
 				// Cout de codage des intervalles
-				dAttributeCost += KWStat::LnFactorial(nValueNumber - 1);
-				dAttributeCost -= KWStat::LnFactorial(nValueNumber - nPartitionSize);
-				dAttributeCost -= KWStat::LnFactorial(nPartitionSize - 1);
+				dAttributeCost += LnFactorial(nValueNumber - 1);
+				dAttributeCost -= LnFactorial(nValueNumber - nPartitionSize);
+				dAttributeCost -= LnFactorial(nPartitionSize - 1);
 			}
 		}
 		// Cout de structure si attribut symbolique
@@ -1502,84 +1757,83 @@ double KRRuleRegressionCosts::ComputePartUnionCost(const KRRPart* part1, const K
 
 
 double KRRuleRegressionCosts::ComputeBodyCost(const KRRule* rule) const
+{
+	return ComputeBodyCostWithDiff(rule, NULL);
+}
+
+double KRRuleRegressionCosts::ComputeOutBodyCost(const KRRule* rule) const
+{
+	return ComputeOutBodyCostWithDiff(rule, NULL);
+}
+
+double KRRuleRegressionCosts::ComputeBodyCostWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const
 {
 	double dBodyCost;
 	int nBodyFrequency;
+	int nTargetNumber;
+	int nFrequency;
 	int nIndex;
 
 	require(rule != NULL);
-	//require(bodyPart->GetAttribute()->GetPartAt(bodyPart->GetAttribute()->GetBodyPartIndex()) == part);
 
+	// Nombre de classes: valeurs cibles en classification supervisee, parties de l'attribut cible en regression
+	if (rule->GetTargetType() == KWType::Symbol)
+		nTargetNumber = rule->GetTargetValueNumber();
+	else
+		nTargetNumber = rule->GetTargetAttribute()->GetPartNumber();
+	require(ivTargetValueFrequencyDiffs == NULL or ivTargetValueFrequencyDiffs->GetSize() == nTargetNumber);
+
+	// Fin de prior + likelihood
 	nBodyFrequency = 0;
 	dBodyCost = 0;
-	// Classification supervisee : fin de prior + likelihood
-	if (rule->GetTargetType() == KWType::Symbol)
+	for (nIndex = 0; nIndex < nTargetNumber; nIndex++)
 	{
-		for (nIndex = 0; nIndex < rule->GetTargetValueNumber(); nIndex++)
-		{
-			nBodyFrequency += rule->GetInBodyTargetValueFrequencyAt(nIndex);
-			dBodyCost -= KWStat::LnFactorial(rule->GetInBodyTargetValueFrequencyAt(nIndex));
-		}
-
-		ensure(nBodyFrequency == rule->GetInBodyTotalFrequency());
-
-		dBodyCost += KWStat::LnFactorial(nBodyFrequency + rule->GetTargetValueNumber() - 1);
-		dBodyCost -= KWStat::LnFactorial(rule->GetTargetValueNumber() - 1);
+		nFrequency = rule->GetInBodyTargetValueFrequencyAt(nIndex);
+		if (ivTargetValueFrequencyDiffs != NULL)
+			nFrequency += ivTargetValueFrequencyDiffs->GetAt(nIndex);
+		assert(nFrequency >= 0);
+		nBodyFrequency += nFrequency;
+		dBodyCost -= LnFactorial(nFrequency);
 	}
 
-	// Regression : fin de prior + likelihood
-	if (rule->GetTargetType() == KWType::Continuous)
-	{
-		for (nIndex = 0; nIndex < rule->GetTargetAttribute()->GetPartNumber(); nIndex++)
-		{
-			nBodyFrequency += rule->GetInBodyTargetValueFrequencyAt(nIndex);
-			dBodyCost -= KWStat::LnFactorial(rule->GetInBodyTargetValueFrequencyAt(nIndex));
-		}
-
-		ensure(nBodyFrequency == rule->GetInBodyTotalFrequency());
-
-		dBodyCost += KWStat::LnFactorial(nBodyFrequency + rule->GetTargetAttribute()->GetPartNumber() - 1);
-		dBodyCost -= KWStat::LnFactorial(rule->GetTargetAttribute()->GetPartNumber() - 1);
-	}
+	ensure(ivTargetValueFrequencyDiffs != NULL or nBodyFrequency == rule->GetInBodyTotalFrequency());
 
+	dBodyCost += LnFactorial(nBodyFrequency + nTargetNumber - 1);
+	dBodyCost -= LnFactorial(nTargetNumber - 1);
 	return dBodyCost;
 }
 
-double KRRuleRegressionCosts::ComputeOutBodyCost(const KRRule* rule) const
+double KRRuleRegressionCosts::ComputeOutBodyCostWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const
 {
 	double dOutBodyCost;
 	int nOutBodyFrequency;
+	int nTargetNumber;
+	int nFrequency;
 	int nIndex;
 
 	require(rule != NULL);
-	//require(bodyPart->GetAttribute()->GetPartAt(bodyPart->GetAttribute()->GetBodyPartIndex()) == part);
-
-	nOutBodyFrequency = rule->GetTotalFrequency() - rule->GetInBodyTotalFrequency();
-	dOutBodyCost = 0;
 
-	// Classification supervise
+	// Nombre de classes: valeurs cibles en classification supervisee, parties de l'attribut cible en regression
 	if (rule->GetTargetType() == KWType::Symbol)
-	{
-		for (nIndex = 0; nIndex < rule->GetTargetValueNumber(); nIndex++)
-		{
-			dOutBodyCost -= KWStat::LnFactorial(rule->GetTargetValueFrequencyAt(nIndex) - rule->GetInBodyTargetValueFrequencyAt(nIndex));
-		}
-		dOutBodyCost += KWStat::LnFactorial(nOutBodyFrequency + rule->GetTargetValueNumber() - 1);
-		dOutBodyCost -= KWStat::LnFactorial(rule->GetTargetValueNumber() - 1);
-	}
+		nTargetNumber = rule->GetTargetValueNumber();
+	else
+		nTargetNumber = rule->GetTargetAttribute()->GetPartNumber();
+	require(ivTargetValueFrequencyDiffs == NULL or ivTargetValueFrequencyDiffs->GetSize() == nTargetNumber);
 
-	// Regression
-	if (rule->GetTargetType() == KWType::Continuous)
+	nOutBodyFrequency = 0;
+	dOutBodyCost = 0;
+	for (nIndex = 0; nIndex < nTargetNumber; nIndex++)
 	{
-		for (nIndex = 0; nIndex < rule->GetTargetAttribute()->GetPartNumber(); nIndex++)
-		{
-			//cout << "TVF : " << rule->GetTargetValueFrequencyAt(nIndex) << " - " << "IBTVF : " << rule->GetInBodyTargetValueFrequencyAt(nIndex) << endl;
-			dOutBodyCost -= KWStat::LnFactorial(rule->GetTargetValueFrequencyAt(nIndex) - rule->GetInBodyTargetValueFrequencyAt(nIndex));
-		}
-		dOutBodyCost += KWStat::LnFactorial(nOutBodyFrequency + rule->GetTargetAttribute()->GetPartNumber() - 1);
-		dOutBodyCost -= KWStat::LnFactorial(rule->GetTargetAttribute()->GetPartNumber() - 1);
+		nFrequency = rule->GetTargetValueFrequencyAt(nIndex) - rule->GetInBodyTargetValueFrequencyAt(nIndex);
+		if (ivTargetValueFrequencyDiffs != NULL)
+			nFrequency -= ivTargetValueFrequencyDiffs->GetAt(nIndex);
+		assert(nFrequency >= 0);
+		nOutBodyFrequency += nFrequency;
+		dOutBodyCost -= LnFactorial(nFrequency);
 	}
-
+	assert(ivTargetValueFrequencyDiffs != NULL or nOutBodyFrequency == rule->GetTotalFrequency() - rule->GetInBodyTotalFrequency());
+	dOutBodyCost += LnFactorial(nOutBodyFrequency + nTargetNumber - 1);
+	dOutBodyCost -= LnFactorial(nTargetNumber - 1);
 	return dOutBodyCost;
 }
 
@@ -1602,12 +1856,25 @@ double KRRuleRegressionCosts::ComputeNullRuleCost(const KRRule* rule) const
 	require(GetTotalAttributeNumber() != 0);
 	require(IsInitialized());
 
+	// Cout precalcule pour la base
+	if (AreCostTablesInitialized() and rule->GetTotalFrequency() == nCostTableInstanceNumber)
+	{
+		assert(fabs(dDatasetNullRuleCost - (log(GetTotalAttributeNumber() + 1.0) + LnFactorial(rule->GetTotalFrequency()))) < dEpsilon);
+		return dDatasetNullRuleCost;
+	}
+
 	dNullRuleCost = log(GetTotalAttributeNumber() + 1.0)
-		+ KWStat::LnFactorial(rule->GetTotalFrequency());
+		+ LnFactorial(rule->GetTotalFrequency());
 
 	return dNullRuleCost;
 }
 
+double KRRuleRegressionCosts::ComputeDatasetNullRuleCost() const
+{
+	require(GetClassStats() != NULL);
+	return log(GetTotalAttributeNumber() + 1.0) + LnFactorial(GetClassStats()->GetInstanceNumber());
+}
+
 double KRRuleRegressionCosts::ComputeRuleTotalCost(const KRRule* rule) const
 {
 	double dTotalCost;
@@ -31,6 +31,16 @@ public:
     void SetClassStats(KWClassStats* stats);
     KWClassStats* GetClassStats() const;
 
+	// Precalcul des tables de couts, a partir des statistiques sur le probleme d'apprentissage:
+	//  - table des ln(n!) pour n de 0 a N+J (N: nombre d'instances, J: nombre de valeurs cibles)
+	//  - cout de regle par nombre d'attributs informatifs
+	//  - cout de la regle nulle, qui ne depend que de la base
+	// Les evaluations de couts se font alors par consultation des tables, avec repli
+	// sur le calcul direct pour les valeurs hors tables
+	void InitializeCostTables();
+	void CleanCostTables();
+	boolean AreCostTablesInitialized() const;
+
 	/////////////////////////////////////////////////////////////////////////
 	// Calcul des couts locaux par entite de la regle, portant
 	// sur la regle, les attributs, les parties
@@ -50,6 +60,25 @@ public:
 	virtual double ComputeBodyCost(const KRRule* rule) const;
 	virtual double ComputeOutBodyCost(const KRRule* rule) const;
 
+	// Calcul des couts du corps et de l'exterieur apres application a la regle d'une differentielle
+	// d'effectifs par classe (instances entrant (+) ou sortant (-) du corps), sans modifier la regle
+	// La differentielle est de la taille du vecteur d'effectifs du corps de la regle (NULL: pas de differentielle)
+	virtual double ComputeBodyCostWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const;
+	virtual double ComputeOutBodyCostWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const;
+
+	// Level de la regle apres application d'une differentielle d'effectifs par classe,
+	// la structure de la regle (attributs et nombres de parties) etant inchangee, en O(J)
+	// Les couts bufferises de la regle doivent etre a jour
+	double ComputeRuleLevelWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const;
+
+	// Majorant optimiste du level atteignable en optimisant le corps d'un attribut de la regle, les autres
+	// attributs etant inchanges: le corps optimise est alors inclus dans les instances couvertes par les autres
+	// conditions (instances de travail de l'attribut), dont les effectifs par classe sont donnes
+	// Les couts bufferises de la regle doivent etre a jour
+	// Renvoie 1 par defaut (pas de majorant)
+	virtual double ComputeAttributeLevelUpperBound(const KRRule* rule, const KRRAttribute* attribute,
+		const IntVector* ivWorkingTargetFrequencies) const;
+
 	/////////////////////////////////////////////////////////////////////////
 	// Calcul du cout total d'une regle
 	//	- cout de la regle
@@ -137,8 +166,24 @@ public:
 	///////////////////////////////
     ///// Implementation
 protected:
+	// Calcul de ln(n!), par consultation de la table si possible
+	double LnFactorial(int nValue) const;
+
+	// Calcul direct du cout de regle pour un nombre d'attributs informatifs
+	virtual double ComputeRuleSelectionCost(int nInformativeAttributeNumber) const;
+
+	// Calcul direct du cout de la regle nulle sur la base
+	virtual double ComputeDatasetNullRuleCost() const;
+
 	double dEpsilon;
 	KWClassStats* classStats;
+
+	// Tables de couts precalculees
+	DoubleVector dvLnFactorials;
+	DoubleVector dvRuleCosts;
+	double dDatasetNullRuleCost;
+	int nCostTableInstanceNumber;
+	boolean bCostTablesInitialized;
 };
 
 
@@ -177,6 +222,19 @@ public:
 	double ComputePartUnionCost(const KRRPart* part1, const KRRPart* part2) const;
 	double ComputeBodyCost(const KRRule* rule) const;
 	double ComputeOutBodyCost(const KRRule* rule) const;
+	double ComputeBodyCostWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const;
+	double ComputeOutBodyCostWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const;
+
+	// Majorant optimiste du level, obtenu a partir de minorants des couts:
+	//  - structure: l'attribut optimise peut devenir non informatif (cout d'attribut nul, un attribut
+	//    informatif de moins pour le cout de regle)
+	//  - corps de taille n: coefficient multinomial minore par 0 (corps pur)
+	//  - exterieur: les instances hors instances de travail y restent; le coefficient multinomial est
+	//    minimal quand les instances de travail hors corps sont toutes de la classe la plus representee
+	//    parmi ces instances (maximum d'une fonction convexe atteint sur un sommet)
+	// Le minorant du cout des donnees est minimise sur la taille n du corps, en O(W)
+	double ComputeAttributeLevelUpperBound(const KRRule* rule, const KRRAttribute* attribute,
+		const IntVector* ivWorkingTargetFrequencies) const;
 
 	/////////////////////////////////////////////////////////////////////////
 	// Calcul du cout total d'une regle
@@ -265,6 +323,14 @@ public:
 	///////////////////////////////
     ///// Implementation
 protected:
+	// Calcul direct des couts precalcules
+	double ComputeRuleSelectionCost(int nInformativeAttributeNumber) const;
+	double ComputeDatasetNullRuleCost() const;
+
+	// Calcul du cout de la regle nulle a partir des effectifs par classe d'une regle ou donnes
+	double ComputeRuleNullRuleCost(const KRRule* rule) const;
+	double ComputeNullRuleCostFromFrequencies(int nTotalFrequency, const IntVector* ivTargetFrequencies) const;
+
 	double dEpsilon;
 	KWClassStats* classStats;
 };
@@ -305,6 +371,8 @@ public:
 	double ComputePartUnionCost(const KRRPart* part1, const KRRPart* part2) const;
 	double ComputeBodyCost(const KRRule* rule) const;
 	double ComputeOutBodyCost(const KRRule* rule) const;
+	double ComputeBodyCostWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const;
+	double ComputeOutBodyCostWithDiff(const KRRule* rule, const IntVector* ivTargetValueFrequencyDiffs) const;
 
 	/////////////////////////////////////////////////////////////////////////
 	// Calcul du cout total d'une regle
@@ -393,8 +461,23 @@ public:
 	///////////////////////////////
     ///// Implementation
 protected:
+	// Calcul direct des couts precalcules
+	double ComputeRuleSelectionCost(int nInformativeAttributeNumber) const;
+	double ComputeDatasetNullRuleCost() const;
+
 	double dEpsilon;
 	KWClassStats* classStats;
 };
 
+///// Methode en inline
+
+inline double KRRuleCosts::LnFactorial(int nValue) const
+{
+	require(nValue >= 0);
+	if (nValue < dvLnFactorials.GetSize())
+		return dvLnFactorials.GetAt(nValue);
+	else
+		return KWStat::LnFactorial(nValue);
+}
+
 #endif // KRRULECOSTS_H
@@ -0,0 +1,339 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#include "KRRuleCoveragePlan.h"
+
+//////////////////////////////////////////////////////////////////////////////////
+// Classe KRRuleCoveragePlan
+
+KRRuleCoveragePlan::KRRuleCoveragePlan()
+{
+	compiledRule = NULL;
+}
+
+KRRuleCoveragePlan::~KRRuleCoveragePlan()
+{
+	Clean();
+}
+
+void KRRuleCoveragePlan::Compile(const KRRule* rule, const KWClass* kwcClass, const ObjectDictionary* odPreprocessedAttributes)
+{
+	int nAttributeIndex;
+	KRRAttribute* krrAttribute;
+	KRCoverageCondition* condition;
+	KRPreprocessedAttribute* krpaAttribute;
+
+	require(rule != NULL);
+	require(kwcClass != NULL);
+	require(odPreprocessedAttributes != NULL);
+
+	// Nettoyage prealable
+	Clean();
+
+	// Resolution de chaque attribut de la regle
+	for (nAttributeIndex = 0; nAttributeIndex < rule->GetAttributeNumber(); nAttributeIndex++)
+	{
+		krrAttribute = rule->GetAttributeAt(nAttributeIndex);
+		require(KWType::IsSimple(krrAttribute->GetAttributeType()));
+		assert(kwcClass->LookupAttribute(krrAttribute->GetAttributeName()) != NULL);
+		krpaAttribute = cast(KRPreprocessedAttribute*, odPreprocessedAttributes->Lookup(krrAttribute->GetAttributeName()));
+		check(krpaAttribute);
+		assert(krpaAttribute->GetAttributeType() == krrAttribute->GetAttributeType());
+
+		condition = new KRCoverageCondition;
+		condition->nType = krrAttribute->GetAttributeType();
+		condition->bTargetFunction = krrAttribute->GetAttributeTargetFunction();
+		condition->attribute = krrAttribute;
+		if (condition->nType == KWType::Continuous)
+			condition->preprocessedContinuousAttribute = cast(KRPreprocessedContinuousAttribute*, krpaAttribute);
+		else
+		{
+			condition->preprocessedAttribute = cast(KRPreprocessedSymbolAttribute*, krpaAttribute);
+			condition->bodyValueCodes.SetSize(condition->preprocessedAttribute->GetPreprocessedValueNumber());
+		}
+
+		// Corps de la condition
+		UpdateConditionBody(condition);
+		oaConditions.Add(condition);
+	}
+	compiledRule = rule;
+}
+
+void KRRuleCoveragePlan::Synchronize(const KRRule* rule, const KWClass* kwcClass, const ObjectDictionary* odPreprocessedAttributes)
+{
+	int nCondition;
+
+	require(rule != NULL);
+
+	// Compilation si la structure de la regle a change
+	if (not IsCompiledFor(rule))
+		Compile(rule, kwcClass, odPreprocessedAttributes);
+	// Sinon, mise a jour sur place du corps de chaque condition, sans allocation
+	else
+	{
+		for (nCondition = 0; nCondition < oaConditions.GetSize(); nCondition++)
+			UpdateConditionBody(cast(KRCoverageCondition*, oaConditions.GetAt(nCondition)));
+	}
+}
+
+boolean KRRuleCoveragePlan::IsCompiledFor(const KRRule* rule) const
+{
+	int nCondition;
+	KRCoverageCondition* condition;
+	KRRAttribute* krrAttribute;
+
+	require(rule != NULL);
+
+	if (rule != compiledRule or rule->GetAttributeNumber() != oaConditions.GetSize())
+		return false;
+
+	// Comparaison des attributs de la regle a ceux des conditions, sans acces aux attributs compiles,
+	// qui peuvent avoir ete detruits
+	for (nCondition = 0; nCondition < oaConditions.GetSize(); nCondition++)
+	{
+		condition = cast(KRCoverageCondition*, oaConditions.GetAt(nCondition));
+		krrAttribute = rule->GetAttributeAt(nCondition);
+		if (krrAttribute != condition->attribute or krrAttribute->GetAttributeType() != condition->nType or
+		    krrAttribute->GetAttributeTargetFunction() != condition->bTargetFunction)
+			return false;
+		if (condition->nType == KWType::Continuous and
+		    krrAttribute->GetAttributeName() != condition->preprocessedContinuousAttribute->GetAttributeName())
+			return false;
+		if (condition->nType == KWType::Symbol and
+		    krrAttribute->GetAttributeName() != condition->preprocessedAttribute->GetAttributeName())
+			return false;
+	}
+	return true;
+}
+
+void KRRuleCoveragePlan::Clean()
+{
+	oaConditions.DeleteAll();
+	compiledRule = NULL;
+}
+
+int KRRuleCoveragePlan::GetConditionNumber() const
+{
+	return oaConditions.GetSize();
+}
+
+void KRRuleCoveragePlan::UpdateConditionBody(KRCoverageCondition* condition) const
+{
+	const KRRAttribute* krrAttribute;
+	KRRInterval* krriBodyInterval;
+	KRRValueSet* krrvsBody;
+	KRRValue* value;
+	int nCode;
+
+	require(condition != NULL);
+
+	krrAttribute = condition->attribute;
+
+	// Bornes du corps pour un attribut numerique (cf. KRRAttribute::IsInBodyContinuous)
+	// Le bitmap de la condition est a reconstruire si elles ont change
+	if (condition->nType == KWType::Continuous)
+	{
+		krriBodyInterval = krrAttribute->GetPartAt(krrAttribute->GetBodyPartIndex())->GetInterval();
+		if (condition->bWithLowerBound != (krrAttribute->GetBodyPartIndex() != 0) or
+		    condition->cLowerBound != krriBodyInterval->GetLowerBound() or
+		    condition->cUpperBound != krriBodyInterval->GetUpperBound())
+		{
+			condition->bWithLowerBound = (krrAttribute->GetBodyPartIndex() != 0);
+			condition->cLowerBound = krriBodyInterval->GetLowerBound();
+			condition->cUpperBound = krriBodyInterval->GetUpperBound();
+			condition->bBitmapUpToDate = false;
+		}
+	}
+	// Codes des valeurs du corps pour un attribut symbolique, recopies depuis l'attribut de la regle
+	// s'il les tient a jour, et sinon recherches a partir des valeurs de son corps
+	// Les valeurs absentes de la base (dont la valeur speciale) n'ont pas de code
+	else
+	{
+		if (krrAttribute->GetBodyValueCodes()->GetSize() == condition->bodyValueCodes.GetSize())
+		{
+			if (not condition->bodyValueCodes.Equals(krrAttribute->GetBodyValueCodes()))
+			{
+				condition->bodyValueCodes.CopyFrom(krrAttribute->GetBodyValueCodes());
+				condition->bBitmapUpToDate = false;
+			}
+		}
+		else
+		{
+			condition->bodyValueCodes.Reset();
+			krrvsBody = krrAttribute->GetPartAt(krrAttribute->GetBodyPartIndex())->GetValueSet();
+			value = krrvsBody->GetHeadValue();
+			while (value != NULL)
+			{
+				nCode = condition->preprocessedAttribute->LookUpValueCode(value->GetValue());
+				if (nCode >= 0)
+					condition->bodyValueCodes.Add(nCode);
+				krrvsBody->GetNextValue(value);
+			}
+			condition->bBitmapUpToDate = false;
+		}
+	}
+}
+
+boolean KRRuleCoveragePlan::IsInConditionBody(const KRCoverageCondition* condition, int nObjectRank) const
+{
+	Continuous cValue;
+	int nCode;
+
+	if (condition->nType == KWType::Continuous)
+	{
+		cValue = condition->preprocessedContinuousAttribute->GetValueAtRank(nObjectRank);
+		return (not condition->bWithLowerBound or condition->cLowerBound < cValue) and cValue <= condition->cUpperBound;
+	}
+	// Attribut symbolique: test du bit du code de la valeur de l'objet
+	else
+	{
+		nCode = condition->preprocessedAttribute->GetObjectValueCodeAtRank(nObjectRank);
+		assert(condition->bodyValueCodes.Contains(nCode) ==
+		       condition->attribute->IsInBodySymbol(condition->preprocessedAttribute->GetPreprocessedValueAt(nCode)->GetValue()));
+		return condition->bodyValueCodes.Contains(nCode);
+	}
+}
+
+int KRRuleCoveragePlan::ComputeBodyCount(int nObjectRank) const
+{
+	int nCondition;
+	int nCount;
+
+	require(nObjectRank >= 0);
+
+	nCount = 0;
+	for (nCondition = 0; nCondition < oaConditions.GetSize(); nCondition++)
+	{
+		if (IsInConditionBody(cast(KRCoverageCondition*, oaConditions.GetAt(nCondition)), nObjectRank))
+			nCount++;
+	}
+	return nCount;
+}
+
+boolean KRRuleCoveragePlan::IsCovered(int nObjectRank) const
+{
+	int nCondition;
+	KRCoverageCondition* condition;
+
+	require(nObjectRank >= 0);
+
+	// Arret des la premiere condition non satisfaite
+	for (nCondition = 0; nCondition < oaConditions.GetSize(); nCondition++)
+	{
+		condition = cast(KRCoverageCondition*, oaConditions.GetAt(nCondition));
+		if (not condition->bTargetFunction and not IsInConditionBody(condition, nObjectRank))
+			return false;
+	}
+	return true;
+}
+
+void KRRuleCoveragePlan::ComputeBodyBitmap(const KRCoverageBitmap* bmAllObjects, KRCoverageBitmap* bmBody)
+{
+	int nCondition;
+	KRCoverageCondition* condition;
+
+	require(bmAllObjects != NULL);
+	require(bmBody != NULL);
+
+	// Initialisation avec tous les objets
+	if (bmBody->GetSize() != bmAllObjects->GetSize())
+		bmBody->SetSize(bmAllObjects->GetSize());
+	bmBody->CopyFrom(bmAllObjects);
+
+	// Intersection avec le bitmap de chaque condition hors cible, reconstruit uniquement si son corps a change
+	for (nCondition = 0; nCondition < oaConditions.GetSize(); nCondition++)
+	{
+		condition = cast(KRCoverageCondition*, oaConditions.GetAt(nCondition));
+		if (not condition->bTargetFunction)
+		{
+			if (not condition->bBitmapUpToDate or condition->bmCondition.GetSize() != bmAllObjects->GetSize())
+			{
+				if (condition->bmCondition.GetSize() != bmAllObjects->GetSize())
+					condition->bmCondition.SetSize(bmAllObjects->GetSize());
+				BuildConditionBitmap(condition, &condition->bmCondition);
+				condition->bBitmapUpToDate = true;
+			}
+			bmBody->And(&condition->bmCondition);
+		}
+	}
+}
+
+void KRRuleCoveragePlan::BuildConditionBitmap(const KRCoverageCondition* condition, KRCoverageBitmap* bmCondition) const
+{
+	const KRPreprocessedContinuousAttribute* krpcaAttribute;
+	const KRPreprocessedSymbolAttribute* krpsaAttribute;
+	KRPreprocessedValue* krpvValue;
+	int nCode;
+	int nIndex;
+
+	require(condition != NULL);
+	require(bmCondition != NULL);
+
+	// Attribut numerique: evaluation vectorisee de l'intervalle du corps sur la colonne par rang
+	if (condition->nType == KWType::Continuous)
+	{
+		krpcaAttribute = condition->preprocessedContinuousAttribute;
+		check(krpcaAttribute);
+		assert(krpcaAttribute->GetRankValueNumber() == bmCondition->GetSize());
+		bmCondition->SetInterval(krpcaAttribute->GetRankValues(), condition->bWithLowerBound, condition->cLowerBound,
+					 condition->cUpperBound);
+	}
+	// Attribut symbolique: plages de la colonne triee de chaque valeur du corps
+	else
+	{
+		bmCondition->Reset();
+		krpsaAttribute = condition->preprocessedAttribute;
+		check(krpsaAttribute);
+		for (nCode = 0; nCode < condition->bodyValueCodes.GetSize(); nCode++)
+		{
+			if (condition->bodyValueCodes.Contains(nCode))
+			{
+				krpvValue = krpsaAttribute->GetPreprocessedValueAt(nCode);
+				assert(krpvValue->GetValueCode() == nCode);
+				for (nIndex = krpvValue->GetFirstIndex(); nIndex <= krpvValue->GetLastIndex(); nIndex++)
+					bmCondition->Add(krpsaAttribute->GetObjectRankAt(nIndex));
+			}
+		}
+	}
+}
+
+void KRRuleCoveragePlan::Write(ostream& ost) const
+{
+	int nCondition;
+	KRCoverageCondition* condition;
+
+	for (nCondition = 0; nCondition < oaConditions.GetSize(); nCondition++)
+	{
+		condition = cast(KRCoverageCondition*, oaConditions.GetAt(nCondition));
+		ost << condition->attribute->GetAttributeName() << "\t" << KWType::ToString(condition->nType);
+		if (condition->nType == KWType::Continuous)
+		{
+			if (condition->bWithLowerBound)
+				ost << "\t]" << condition->cLowerBound << ", " << condition->cUpperBound << "]";
+			else
+				ost << "\t]*, " << condition->cUpperBound << "]";
+		}
+		if (condition->bTargetFunction)
+			ost << "\ttarget";
+		ost << "\n";
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// Classe KRCoverageCondition
+
+KRCoverageCondition::KRCoverageCondition()
+{
+	nType = KWType::Unknown;
+	bTargetFunction = false;
+	bWithLowerBound = false;
+	cLowerBound = 0;
+	cUpperBound = 0;
+	attribute = NULL;
+	preprocessedAttribute = NULL;
+	preprocessedContinuousAttribute = NULL;
+	bBitmapUpToDate = false;
+}
+
+KRCoverageCondition::~KRCoverageCondition() {}
@@ -0,0 +1,128 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#ifndef KRRULECOVERAGEPLAN_H
+#define KRRULECOVERAGEPLAN_H
+
+#include "Object.h"
+#include "KWClass.h"
+#include "KRRule.h"
+#include "KRPreprocessedAttribute.h"
+#include "KRCoverageBitmap.h"
+
+class KRCoverageCondition;
+
+////////////////////////////////////////////////////////////////////
+// Classe KRRuleCoveragePlan
+// Plan de test de couverture des objets par le corps d'une regle
+// Les attributs pretraites, types, bornes d'intervalle et parties du corps des attributs
+// de la regle sont resolus une seule fois par compilation, ce qui evite les recherches
+// d'attribut par nom lors des parcours de la base
+// Les objets sont designes par leur rang (cf. KRObjectCounters), leurs valeurs etant lues
+// dans les colonnes des attributs pretraites
+// Le plan est destine a etre conserve pour la regle en cours d'optimisation: il est resynchronise avec la regle
+// avant chaque utilisation, en etant recompile si ses attributs ou parties ont change, et sinon en mettant a jour
+// sur place les bornes et les codes des valeurs du corps de ses conditions
+class KRRuleCoveragePlan : public Object
+{
+public:
+	// Constructeur
+	KRRuleCoveragePlan();
+	~KRRuleCoveragePlan();
+
+	// Compilation du plan pour une regle et la classe des objets a tester, a partir du dictionnaire
+	// des attributs pretraites (indexes par nom), qui doit contenir tous les attributs de la regle
+	// L'appartenance au corps des attributs symboliques est testee via le code de la valeur de l'objet
+	// dans un ensemble de codes en bits
+	// Memoire: la regle et les attributs pretraites sont references
+	void Compile(const KRRule* rule, const KWClass* kwcClass, const ObjectDictionary* odPreprocessedAttributes);
+
+	// Synchronisation du plan avec une regle: compilation si le plan n'est pas compile pour les attributs
+	// de la regle, et sinon mise a jour sur place du corps des conditions
+	void Synchronize(const KRRule* rule, const KWClass* kwcClass, const ObjectDictionary* odPreprocessedAttributes);
+
+	// Test si le plan est compile pour une regle et ses attributs (en nombre, type, fonction et nom),
+	// sans tenir compte du corps des conditions
+	boolean IsCompiledFor(const KRRule* rule) const;
+
+	// Nettoyage
+	void Clean();
+
+	// Nombre de conditions (une par attribut de la regle)
+	int GetConditionNumber() const;
+
+	// Nombre de conditions dont le corps contient la valeur de l'objet, pour tous les attributs
+	// y compris ceux portant sur la cible (cf. compteurs d'objets)
+	int ComputeBodyCount(int nObjectRank) const;
+
+	// Test de couverture d'un objet par le corps de la regle, hors attributs portant sur la cible
+	boolean IsCovered(int nObjectRank) const;
+
+	// Calcul de l'ensemble des rangs des objets couverts par le corps de la regle, hors attributs portant
+	// sur la cible, par intersection des bitmaps des conditions avec le bitmap de tous les objets
+	// Le bitmap de chaque condition est construit a partir des colonnes de son attribut pretraite, puis
+	// conserve: seules les conditions dont le corps a change depuis le dernier calcul sont reconstruites
+	void ComputeBodyBitmap(const KRCoverageBitmap* bmAllObjects, KRCoverageBitmap* bmBody);
+
+	// Affichage
+	void Write(ostream& ost) const;
+
+	///////////////////////////////////////////////////////
+	///// Implementation
+protected:
+	// Mise a jour du corps d'une condition a partir de l'attribut de la regle, en invalidant
+	// son bitmap si le corps a change
+	void UpdateConditionBody(KRCoverageCondition* condition) const;
+
+	// Test d'appartenance de la valeur d'un objet au corps d'une condition
+	boolean IsInConditionBody(const KRCoverageCondition* condition, int nObjectRank) const;
+
+	// Construction du bitmap des rangs des objets dans le corps d'une condition
+	void BuildConditionBitmap(const KRCoverageCondition* condition, KRCoverageBitmap* bmCondition) const;
+
+	// Regle compilee (referencee, uniquement pour la detection d'un changement de regle), et conditions compilees
+	const KRRule* compiledRule;
+	ObjectArray oaConditions;
+};
+
+////////////////////////////////////////////////////////////////////
+// Classe KRCoverageCondition
+// Condition compilee d'un attribut de regle
+class KRCoverageCondition : public Object
+{
+public:
+	// Constructeur
+	KRCoverageCondition();
+	~KRCoverageCondition();
+
+	// Type de l'attribut (Symbol ou Continuous)
+	int nType;
+
+	// Attribut portant sur la cible
+	boolean bTargetFunction;
+
+	// Corps d'un attribut numerique: intervalle ]LowerBound, UpperBound], sans borne inf
+	// (valeurs manquantes comprises) pour la premiere partie
+	boolean bWithLowerBound;
+	Continuous cLowerBound;
+	Continuous cUpperBound;
+
+	// Attribut de la regle, pour le test d'appartenance d'une valeur symbolique
+	const KRRAttribute* attribute;
+
+	// Corps d'un attribut symbolique: attribut pretraite fournissant le code de la valeur
+	// de chaque objet, et ensemble des codes des valeurs du corps (NULL pour un attribut numerique)
+	const KRPreprocessedSymbolAttribute* preprocessedAttribute;
+	KRValueCodeBitset bodyValueCodes;
+
+	// Attribut numerique pretraite, fournissant la valeur de chaque objet (NULL pour un attribut symbolique)
+	const KRPreprocessedContinuousAttribute* preprocessedContinuousAttribute;
+
+	// Bitmap des rangs des objets dans le corps de la condition (cf. KRRuleCoveragePlan::ComputeBodyBitmap),
+	// et indicateur de sa validite pour le corps courant
+	KRCoverageBitmap bmCondition;
+	boolean bBitmapUpToDate;
+};
+
+#endif // KRRULECOVERAGEPLAN_H
@@ -11,6 +11,14 @@ KRRuleOptimizer::KRRuleOptimizer()
 {
 	nMaxRuleNumber = 10;
 	nTimeAllowed = 600;
+	bMiningTimeExhausted = false;
+	nPrunedRestartNumber = 0;
+	nOptimizationSampleSize = 0;
+	nBoundaryCandidateGranularity = 0;
+	bUnivariateInitialization = false;
+	nOptimizationLoopNumber = 0;
+	nOptimizedRuleNumber = 0;
+	bSampleSweep = false;
 	bIsIndexed = false;
 	classStats = NULL;
 	ruleCosts = NULL;
@@ -22,6 +30,7 @@ KRRuleOptimizer::~KRRuleOptimizer()
 	DeleteIndexingStructure();
 	//odPreprocessedAttributes.RemoveAll();
 	oaPreprocessedAttributes.DeleteAll();
+	oaTargetClassBitmaps.DeleteAll();
 }
 
 void KRRuleOptimizer::SetMaxRuleNumber(int nNumber)
@@ -44,6 +53,48 @@ const int KRRuleOptimizer::GetTimeAllowed() const
 	return nTimeAllowed;
 }
 
+void KRRuleOptimizer::SetOptimizationSampleSize(int nValue)
+{
+	require(nValue >= -1);
+	nOptimizationSampleSize = nValue;
+}
+
+int KRRuleOptimizer::GetOptimizationSampleSize() const
+{
+	return nOptimizationSampleSize;
+}
+
+void KRRuleOptimizer::SetBoundaryCandidateGranularity(int nValue)
+{
+	require(nValue >= 0);
+	nBoundaryCandidateGranularity = nValue;
+}
+
+int KRRuleOptimizer::GetBoundaryCandidateGranularity() const
+{
+	return nBoundaryCandidateGranularity;
+}
+
+void KRRuleOptimizer::SetUnivariateInitialization(boolean bValue)
+{
+	bUnivariateInitialization = bValue;
+}
+
+boolean KRRuleOptimizer::GetUnivariateInitialization() const
+{
+	return bUnivariateInitialization;
+}
+
+void KRRuleOptimizer::SetPreprocessingCacheDirectory(const ALString& sValue)
+{
+	sPreprocessingCacheDirectory = sValue;
+}
+
+const ALString& KRRuleOptimizer::GetPreprocessingCacheDirectory() const
+{
+	return sPreprocessingCacheDirectory;
+}
+
 void KRRuleOptimizer::SetClassStats(KWClassStats* stats)
 {
 	classStats = stats;
@@ -107,133 +158,186 @@ KRPreprocessedAttribute* KRRuleOptimizer::LookUpPreprocessedAttribute(const ALSt
 	return krpaAttribute;
 }
 
-void KRRuleOptimizer::InitializeObjectsCounters(KWDatabase* kwdb, KRRule* rule)
+void KRRuleOptimizer::InitializeObjectsCounters(KRRule* rule)
 {
-	int nObject;
-	KWObject* kwoObject;
-	const KWClass* kwcSortClass;
-	int nAttributeIndex;
-	KRRAttribute* krrAttribute;
-	KWAttribute* kwaAttribute;
-	KWLoadIndex liKWAttributeIndex;
-	KRRPart* krrpBodyPart;
-	Continuous cCurrentValue;
-	Symbol sCurrentValue;
+	int nObjectRank;
+	int nCount;
+	int nIncrement;
+	KRRuleCoveragePlan* coveragePlan;
+
+	require(rule != NULL);
+
+	// Plan de couverture de la regle, synchronise avec la regle
+	coveragePlan = GetRuleCoveragePlan(rule);
+
+	// Un increment par attribut dont le corps contient la valeur de l'objet
+	for (nObjectRank = 0; nObjectRank < krocCounters.GetRankNumber(); nObjectRank++)
+	{
+		nCount = coveragePlan->ComputeBodyCount(nObjectRank);
+		for (nIncrement = 0; nIncrement < nCount; nIncrement++)
+			krocCounters.IncrementBodyCountAtRank(nObjectRank);
+	}
+}
+
+boolean KRRuleOptimizer::CheckObjectCounters(KRRule* rule)
+{
+	int nObjectRank;
+	boolean bOk = true;
+	KRRuleCoveragePlan* coveragePlan;
 
 	require(rule != NULL);
-	require(kwdb->GetObjects() != NULL);
 
-	for (nObject = 0; nObject < kwdb->GetObjects()->GetSize(); nObject++)
+	// Plan de couverture de la regle, synchronise avec la regle
+	coveragePlan = GetRuleCoveragePlan(rule);
+
+	// verification des compteurs
+	for (nObjectRank = 0; nObjectRank < krocCounters.GetRankNumber(); nObjectRank++)
 	{
-		kwoObject = cast(KWObject*, kwdb->GetObjects()->GetAt(nObject));
-		kwcSortClass = kwoObject->GetClass();
-		for (nAttributeIndex = 0; nAttributeIndex < rule->GetAttributeNumber(); nAttributeIndex++)
+		if (krocCounters.GetBodyCountAtRank(nObjectRank) != coveragePlan->ComputeBodyCount(nObjectRank))
 		{
-			krrAttribute = rule->GetAttributeAt(nAttributeIndex);
-			kwaAttribute = kwcSortClass->LookupAttribute(krrAttribute->GetAttributeName());
-			liKWAttributeIndex = kwaAttribute->GetLoadIndex();
-			krrpBodyPart = krrAttribute->GetPartAt(krrAttribute->GetBodyPartIndex());
-			// cas categoriel
-			if (krrAttribute->GetAttributeType() == KWType::Symbol)
-			{
-				sCurrentValue = kwoObject->GetSymbolValueAt(liKWAttributeIndex);
-				if (krrAttribute->IsInBodySymbol(sCurrentValue))
-					//if (krrAttribute->LookupSymbolPart(sCurrentValue) == krrpBodyPart)
-					// si valeur de l'attribut de l'objet n'est pas dans la partie active du corps
-				{
-					krocCounters.IncrementBodyCountAt(kwoObject);
-				}
-			}
-			// cas numerique
-			if (krrAttribute->GetAttributeType() == KWType::Continuous)
-			{
-				cCurrentValue = kwoObject->GetContinuousValueAt(liKWAttributeIndex);
-				//if (krrpBodyPart->GetInterval()->GetLowerBound() < cCurrentValue
-				//		and krrpBodyPart->GetInterval()->GetUpperBound() >= cCurrentValue)
-				// si valeur de l'attribut de l'objet n'est pas dans la partie active du corps
-				if (krrAttribute->IsInBodyContinuous(cCurrentValue))
-				{
-					krocCounters.IncrementBodyCountAt(kwoObject);
-				}
-			}
+			bOk = false;
+			break;
 		}
 	}
+	return bOk;
 }
 
-boolean KRRuleOptimizer::CheckObjectCounters(KWDatabase* kwdb, KRRule* rule)
+void KRRuleOptimizer::UpdateContinuousObjectsCounters(KRRAttribute* krrAttribute,
+	boolean bInitialWithLowerBound,
+	Continuous cInitialLowerBound,
+	Continuous cInitialUpperBound)
 {
-	int nObject;
-	KWObject* kwoObject;
-	const KWClass* kwcSortClass;
-	int nAttributeIndex;
+	KRPreprocessedContinuousAttribute* krpcaAttribute;
+	KRRInterval* krriBodyInterval;
+	int nInitialFirstIndex;
+	int nInitialLastIndex;
+	int nFirstIndex;
+	int nLastIndex;
+	int nIndex;
+
+	require(krrAttribute != NULL);
+	require(krrAttribute->GetAttributeType() == KWType::Continuous);
+
+	krpcaAttribute = cast(KRPreprocessedContinuousAttribute*, LookUpPreprocessedAttribute(krrAttribute->GetAttributeName()));
+
+	// Plages d'index des objets du corps, initial et courant, dans l'ordre trie selon l'attribut
+	// Sans borne inf (premiere partie), le corps commence au premier objet, valeurs manquantes comprises
+	nInitialFirstIndex = 0;
+	if (bInitialWithLowerBound)
+		nInitialFirstIndex = krpcaAttribute->SearchUpperIndex(cInitialLowerBound);
+	nInitialLastIndex = krpcaAttribute->SearchUpperIndex(cInitialUpperBound);
+	krriBodyInterval = krrAttribute->GetPartAt(krrAttribute->GetBodyPartIndex())->GetInterval();
+	nFirstIndex = 0;
+	if (krrAttribute->GetBodyPartIndex() != 0)
+		nFirstIndex = krpcaAttribute->SearchUpperIndex(krriBodyInterval->GetLowerBound());
+	nLastIndex = krpcaAttribute->SearchUpperIndex(krriBodyInterval->GetUpperBound());
+
+	// Les deux corps contenant l'objet de reference, seuls les objets entre les bornes inf,
+	// et entre les bornes sup, changent d'appartenance au corps
+	assert(nInitialFirstIndex < nLastIndex and nFirstIndex < nInitialLastIndex);
+
+	// Objets sortant du corps par la borne inf
+	for (nIndex = nInitialFirstIndex; nIndex < nFirstIndex; nIndex++)
+		krocCounters.DecrementBodyCountAtRank(krpcaAttribute->GetObjectRankAt(nIndex));
+	// Objets entrant dans le corps par la borne inf
+	for (nIndex = nFirstIndex; nIndex < nInitialFirstIndex; nIndex++)
+		krocCounters.IncrementBodyCountAtRank(krpcaAttribute->GetObjectRankAt(nIndex));
+	// Objets sortant du corps par la borne sup
+	for (nIndex = nLastIndex; nIndex < nInitialLastIndex; nIndex++)
+		krocCounters.DecrementBodyCountAtRank(krpcaAttribute->GetObjectRankAt(nIndex));
+	// Objets entrant dans le corps par la borne sup
+	for (nIndex = nInitialLastIndex; nIndex < nLastIndex; nIndex++)
+		krocCounters.IncrementBodyCountAtRank(krpcaAttribute->GetObjectRankAt(nIndex));
+}
+
+void KRRuleOptimizer::UpdateSymbolValueObjectsCounters(KRPreprocessedSymbolAttribute* krpsaAttribute, Symbol sValue, int nDelta)
+{
+	KRPreprocessedValue* krpvValue;
+	int nIndex;
+
+	require(krpsaAttribute != NULL);
+	require(nDelta == 1 or nDelta == -1);
+
+	// Parcours de la plage des objets de la valeur dans l'ordre trie
+	krpvValue = krpsaAttribute->LookUpPreprocessedValue(sValue);
+	if (krpvValue != NULL)
+	{
+		for (nIndex = krpvValue->GetFirstIndex(); nIndex <= krpvValue->GetLastIndex(); nIndex++)
+		{
+			if (nDelta == 1)
+				krocCounters.IncrementBodyCountAtRank(krpsaAttribute->GetObjectRankAt(nIndex));
+			else
+				krocCounters.DecrementBodyCountAtRank(krpsaAttribute->GetObjectRankAt(nIndex));
+		}
+	}
+}
+
+void KRRuleOptimizer::RemoveNonInformativeAttributesFromCounters(KRRule* rule)
+{
+	int nAttribute;
 	KRRAttribute* krrAttribute;
-	KWAttribute* kwaAttribute;
-	KWLoadIndex liKWAttributeIndex;
-	KRRPart* krrpBodyPart;
-	Continuous cCurrentValue;
-	Symbol sCurrentValue;
-	boolean bOk = true;
-	int nCount;
+	KRPreprocessedContinuousAttribute* krpcaAttribute;
+	KRPreprocessedSymbolAttribute* krpsaAttribute;
+	KRPreprocessedValue* krpvValue;
+	KRRInterval* krriBodyInterval;
+	int nValue;
+	int nIndex;
+	int nFirstBodyIndex;
+	int nLastBodyIndex;
 
 	require(rule != NULL);
-	require(kwdb->GetObjects() != NULL);
 
-	for (nObject = 0; nObject < kwdb->GetObjects()->GetSize(); nObject++)
+	// Retrait de la contribution des attributs destines a etre detruits, selon le meme critere que la regle
+	for (nAttribute = 0; nAttribute < rule->GetAttributeNumber(); nAttribute++)
 	{
-		nCount = 0;
-		kwoObject = cast(KWObject*, kwdb->GetObjects()->GetAt(nObject));
-		kwcSortClass = kwoObject->GetClass();
-		for (nAttributeIndex = 0; nAttributeIndex < rule->GetAttributeNumber(); nAttributeIndex++)
+		krrAttribute = rule->GetAttributeAt(nAttribute);
+		if (krrAttribute->GetPartNumber() <= 1 and (not krrAttribute->GetAttributeTargetFunction()))
 		{
-			krrAttribute = rule->GetAttributeAt(nAttributeIndex);
-			kwaAttribute = kwcSortClass->LookupAttribute(krrAttribute->GetAttributeName());
-			liKWAttributeIndex = kwaAttribute->GetLoadIndex();
-			krrpBodyPart = krrAttribute->GetPartAt(krrAttribute->GetBodyPartIndex());
-			// cas categoriel
-			if (krrAttribute->GetAttributeType() == KWType::Symbol)
+			if (krrAttribute->GetAttributeType() == KWType::Continuous)
 			{
-				sCurrentValue = kwoObject->GetSymbolValueAt(liKWAttributeIndex);
-				if (krrAttribute->LookupSymbolPart(sCurrentValue) == krrpBodyPart)
-					// si valeur de l'attribut de l'objet n'est pas dans la partie active du corps
+				// Le corps est une plage contigue de la colonne triee
+				krpcaAttribute = cast(KRPreprocessedContinuousAttribute*, LookUpPreprocessedAttribute(krrAttribute->GetAttributeName()));
+				krriBodyInterval = krrAttribute->GetPartAt(krrAttribute->GetBodyPartIndex())->GetInterval();
+				nFirstBodyIndex = 0;
+				if (krrAttribute->GetBodyPartIndex() != 0)
+					nFirstBodyIndex = krpcaAttribute->SearchUpperIndex(krriBodyInterval->GetLowerBound());
+				nLastBodyIndex = krpcaAttribute->SearchUpperIndex(krriBodyInterval->GetUpperBound());
+				for (nIndex = nFirstBodyIndex; nIndex < nLastBodyIndex; nIndex++)
 				{
-					nCount++;
+					assert(krrAttribute->IsInBodyContinuous(krpcaAttribute->GetValueAt(nIndex)));
+					krocCounters.DecrementBodyCountAtRank(krpcaAttribute->GetObjectRankAt(nIndex));
 				}
 			}
-			// cas numerique
-			if (krrAttribute->GetAttributeType() == KWType::Continuous)
+			else
 			{
-				cCurrentValue = kwoObject->GetContinuousValueAt(liKWAttributeIndex);
-				// si valeur de l'attribut de l'objet n'est pas dans la partie active du corps
-				if (krrAttribute->IsInBodyContinuous(cCurrentValue))
+				// Test d'appartenance au corps une seule fois par valeur, par son code
+				krpsaAttribute = cast(KRPreprocessedSymbolAttribute*, LookUpPreprocessedAttribute(krrAttribute->GetAttributeName()));
+				for (nValue = 0; nValue < krpsaAttribute->GetPreprocessedValueNumber(); nValue++)
 				{
-					nCount++;
+					krpvValue = krpsaAttribute->GetPreprocessedValueAt(nValue);
+					if (krrAttribute->IsInBodySymbolCode(krpvValue->GetValueCode()))
+					{
+						for (nIndex = krpvValue->GetFirstIndex(); nIndex <= krpvValue->GetLastIndex(); nIndex++)
+							krocCounters.DecrementBodyCountAtRank(krpsaAttribute->GetObjectRankAt(nIndex));
+					}
 				}
 			}
 		}
-
-		// verification des compteurs
-		if (not krocCounters.GetBodyCountAt(kwoObject) == nCount)
-		{
-			bOk = false;
-			break;
-		}
 	}
-	return bOk;
 }
 
-void KRRuleOptimizer::OptimizeRuleSet(KWDatabase* kwdb, ObjectArray* oaRuleSet)
+void KRRuleOptimizer::OptimizeRuleSet(ObjectArray* oaRuleSet)
 {
 	require(GetClassStats() != NULL);
 
 	int nRuleStoredCounter;
 	int nRuleTestedCounter;
-	KWObject* kwoRandomObject;
-	int nRandomIndex;
-	KRRule* krrInitRule;
-	ObjectArray* oaAttributes;
+	int nCompletedRestartNumber;
+	int nDuplicateRuleNumber;
+	KRRule* krrMinedRule;
+	KRRule* krrKeptRule;
+	ALString sBodyKey;
 	//DDD MB ofstream output("output.txt", ios::out);
-	Timer tCounter;
-	Timer tExtractCounter;
 	ALString sTmp;
 
 	// Debut de tache
@@ -243,92 +347,136 @@ void KRRuleOptimizer::OptimizeRuleSet(KWDatabase* kwdb, ObjectArray* oaRuleSet)
 	// Initialisation des compteurs
 	nRuleStoredCounter = 1;
 	nRuleTestedCounter = 1;
-	//tExtractCounter.Start();
+	nCompletedRestartNumber = 0;
+	nDuplicateRuleNumber = 0;
+	nPrunedRestartNumber = 0;
+	nOptimizationLoopNumber = 0;
+	nOptimizedRuleNumber = 0;
+	odMinedRuleBodies.RemoveAll();
+
+	// Demarrage du controle du temps alloue a l'extraction des regles
+	tMiningTimer.Reset();
+	tMiningTimer.Start();
+	bMiningTimeExhausted = false;
 
 	//DDD MB cout << nTimeAllowed << endl;
 	//DDD MB cout << "oaRuleSetSize : " << oaRuleSet->GetSize() << endl;
 
+	// Relances successives
 	while (nRuleTestedCounter <= nMaxRuleNumber)
 	{
-		// Gestion du compteur temps
-		/*tExtractCounter.Stop();
-		if (tExtractCounter.GetElapsedTime() > nTimeAllowed)
-		{
-			delete oaAttributes;
-			tExtractCounter.Start();
-			break;
-		}
-		cout << tExtractCounter.GetElapsedTime() << endl;
-		tExtractCounter.Start();*/
-
 		// Taux d'avancement
 		TaskProgression::DisplayLabel(sTmp + "Rules (stored/tested/total): " + IntToString(nRuleStoredCounter - 1) + "/" + IntToString(nRuleTestedCounter - 1) + "/" + IntToString(nMaxRuleNumber));
 		TaskProgression::DisplayProgression((int)(100 * (nRuleTestedCounter * 1.0) / nMaxRuleNumber));
-		if (TaskProgression::IsInterruptionRequested())
-		{
-			oaRuleSet->SetSize(nRuleStoredCounter - 1);
+		if (TaskProgression::IsInterruptionRequested() or IsMiningTimeExhausted())
 			break;
-		}
 
-		// Choix de l'objet au hasard
-		nRandomIndex = RandomInt(GetClassStats()->GetInstanceNumber() - 1);
-		//DDD MB output << "\nnRandomIndex = " << nRandomIndex << endl;
-		kwoRandomObject = cast(KWObject*, kwdb->GetObjects()->GetAt(nRandomIndex));
-		//output << "randomObject : \n";
-		//DDD MB kwoRandomObject->Write(output);
-
-		// Choix des index des attributs au hasard
-		oaAttributes = new ObjectArray;
-		RandomAttributeSubsetSelection(kwdb, oaAttributes);
-		//oaAttributes->Write(cout);
-
-		// Initialisation de la regle avec un ensemble d'attributs et un objet au hasard
-		krrInitRule = new KRRule;
-
-		InitializeRule(kwdb, oaAttributes, kwoRandomObject, krrInitRule);
-		InitializeObjectsCounters(kwdb, krrInitRule);
-		ensure(CheckObjectCounters(kwdb, krrInitRule));
-		//DDD MB krrInitRule->Write(output);
-
-		// Optimisation de la regle
-		tCounter.Start();
-		OptimizeRule(kwdb, kwoRandomObject, krrInitRule);
-		tCounter.Stop();
-		assert(krrInitRule->GetTotalCost() != KWContinuous::GetMissingValue() and krrInitRule->GetTotalCost() != KWContinuous::GetForbiddenValue());
-		//DDD MB output << "Time to optimize rule #" << nRuleTestedCounter << " : " << tCounter.GetElapsedTime() << "\nFinal Level : " << krrInitRule->GetLevel() << "\n";
-		tCounter.Reset();
+		// Extraction d'une regle
+		krrMinedRule = MineRandomRule();
+
+		// Une relance interrompue par le temps alloue garde sa regle courante, mais n'est pas achevee
+		if (not IsMiningTimeExhausted())
+			nCompletedRestartNumber++;
+
+		// Seules les regles de corps nouveau sont conservees, chaque relance voyant les regles
+		// de toutes les relances precedentes
+		if (krrMinedRule->GetLevel() > dEpsilon)
+		{
+			sBodyKey = krrMinedRule->ComputeBodyKey();
+			if (odMinedRuleBodies.Lookup(sBodyKey) != NULL)
+			{
+				nDuplicateRuleNumber++;
+				delete krrMinedRule;
+				krrMinedRule = NULL;
+			}
+			else
+			{
+				// Recopie de la regle conservee hors du pool de valeurs des relances
+				krrKeptRule = krrMinedRule->Clone();
+				delete krrMinedRule;
+				krrMinedRule = krrKeptRule;
+				odMinedRuleBodies.SetAt(sBodyKey, krrMinedRule);
+			}
+		}
 
 		// Ecriture de la regle dans un fichier de sortie temporaire
-		//DDD MB krrInitRule->Write(output);
+		//DDD MB krrMinedRule->Write(output);
 		//DDD MB output << "\n**************************************\n";
 
-		// Ajout de la regle au tableau si interessante
-		if (krrInitRule->GetLevel() > dEpsilon)
+		// Ajout de la regle au tableau si interessante (les doublons sont deja detruits)
+		if (krrMinedRule != NULL and krrMinedRule->GetLevel() > dEpsilon)
 		{
-			oaRuleSet->SetAt(nRuleStoredCounter - 1, krrInitRule);
+			oaRuleSet->SetAt(nRuleStoredCounter - 1, krrMinedRule);
 			nRuleStoredCounter++;
 		}
 		else
 		{
-			delete krrInitRule;
+			delete krrMinedRule;
 		}
 		nRuleTestedCounter++;
-
-		// liberation de memoire
-		delete oaAttributes;
 	}
 
-	//tExtractCounter.Stop();
+	tMiningTimer.Stop();
 
 	oaRuleSet->SetSize(nRuleStoredCounter - 1);
 	//DDD MB cout << "oaRuleSetSize : " << oaRuleSet->GetSize() << endl;
 
 	Global::AddSimpleMessage(sTmp + "Rules extracted and stored: " + IntToString(nRuleStoredCounter - 1));
+	if (nDuplicateRuleNumber > 0)
+		Global::AddSimpleMessage(sTmp + "Duplicate rules discarded: " + IntToString(nDuplicateRuleNumber));
+	if (nPrunedRestartNumber > 0)
+		Global::AddSimpleMessage(sTmp + "Hopeless restarts abandoned: " + IntToString(nPrunedRestartNumber));
+	if (nOptimizedRuleNumber > 0)
+		Global::AddSimpleMessage(sTmp + "Mean optimization loops per restart: " +
+			DoubleToString(nOptimizationLoopNumber * 1.0 / nOptimizedRuleNumber));
+	odMinedRuleBodies.RemoveAll();
+	krvpValuePool.DeleteAll();
+	if (bMiningTimeExhausted)
+		Global::AddWarning("Rule mining", "", sTmp + "Time allowed for training (" + IntToString(nTimeAllowed) + " s) exceeded: " + IntToString(nCompletedRestartNumber) + " completed restarts out of " + IntToString(nMaxRuleNumber));
 
 	// Fin de tache
 	TaskProgression::EndTask();
 }
 
+KRRule* KRRuleOptimizer::MineRandomRule()
+{
+	int nRandomObjectRank;
+	KRRule* krrInitRule;
+	ObjectArray oaAttributes;
+
+
+	// Choix de l'objet au hasard, designe par son rang
+	nRandomObjectRank = RandomInt(GetClassStats()->GetInstanceNumber() - 1);
+	assert(nRandomObjectRank < krocCounters.GetRankNumber());
+
+	// Choix des index des attributs au hasard
+	RandomAttributeSubsetSelection(&oaAttributes);
+
+	// Initialisation de la regle avec un ensemble d'attributs et un objet au hasard
+	// Les valeurs des attributs symboliques sont allouees dans le pool recycle d'une relance a l'autre
+	krrInitRule = new KRRule;
+	krrInitRule->SetValuePool(&krvpValuePool);
+	InitializeRule(&oaAttributes, nRandomObjectRank, krrInitRule);
+
+	// Seule reconstruction complete des compteurs d'objets, tenus a jour ensuite lors de l'optimisation
+	krocCounters.ResetCounters();
+	InitializeObjectsCounters(krrInitRule);
+	ensure(CheckObjectCounters(krrInitRule));
+
+	// Optimisation de la regle
+	OptimizeRule(nRandomObjectRank, krrInitRule);
+	assert(krrInitRule->GetTotalCost() != KWContinuous::GetMissingValue() and krrInitRule->GetTotalCost() != KWContinuous::GetForbiddenValue());
+	return krrInitRule;
+}
+
+boolean KRRuleOptimizer::IsMiningTimeExhausted()
+{
+	// Test du temps ecoule, memorise une fois le temps alloue depasse (0: pas de limite)
+	if (not bMiningTimeExhausted and nTimeAllowed > 0 and tMiningTimer.IsStarted())
+		bMiningTimeExhausted = tMiningTimer.GetElapsedTime() > nTimeAllowed;
+	return bMiningTimeExhausted;
+}
+
 void KRRuleOptimizer::WritePreprocessing(ostream& ost)
 {
 	int nIndex;
@@ -339,58 +487,474 @@ void KRRuleOptimizer::WritePreprocessing(ostream& ost)
 		ost << *oaPreprocessedAttributes.GetAt(nIndex);
 }
 
-void KRRuleOptimizer::Preprocess(KWDatabase* kwdb)
+boolean KRRuleOptimizer::Preprocess(KWDatabase* kwdb)
 {
+	boolean bOk;
 	int nIndex;
 	KWClass* kwcClass;
 	KWAttribute* attribute;
-	KRPreprocessedContinuousAttribute* krpcAttribute;
-	KRPreprocessedSymbolAttribute* krpsAttribute;
+	KRPreprocessedAttribute* krpaAttribute;
+	KRAttributeColumn* column;
+	KRAttributeColumn* targetColumn;
+	ObjectArray oaColumns;
+	ObjectArray oaSortedColumns;
+	ObjectArray oaSortedObjectRanks;
+	KRPreprocessingTask preprocessingTask;
+	int nObjectNumber;
+	KRPreprocessingCache preprocessingCache;
+	KRSortOrder* sortOrder;
+	int nCachedSortOrderNumber;
+	boolean bCacheUpdateNeeded;
+	int nContinuousAttributeNumber;
+	int nCandidateIntervalNumber;
+	ALString sTmp;
 
 	require(kwdb != NULL);
+	require(oaPreprocessedAttributes.GetSize() == 0);
 
 	// Acces a la classe
 	kwcClass = GetClassStats()->GetClass();
 	/*cout << "NB attributes : " << GetClassStats()->GetClass()->GetAttributeNumber() << endl;;
 	cout << "NB Loaded attributes : " << GetClassStats()->GetClass()->GetLoadedAttributeNumber() << endl;;*/
 
-	// Initialisation pour pretraitement de chaque attribut de la base
+	// Precalcul des tables de couts, une fois pour toutes les regles
+	if (GetRuleCosts() != NULL)
+		GetRuleCosts()->InitializeCostTables();
+
+	// Creation des attributs a pretraiter, chacun avec la colonne de ses valeurs, de meme index
+	// En classification, la colonne de l'attribut cible est ajoutee en dernier, sans attribut pretraite
+	targetColumn = NULL;
 	for (nIndex = 0; nIndex < kwcClass->GetLoadedAttributeNumber(); nIndex++)
 	{
 		attribute = kwcClass->GetLoadedAttributeAt(nIndex);
 		if (attribute->GetName() != GetClassStats()->GetTargetAttributeName() or GetClassStats()->GetTargetAttributeType() == KWType::Continuous)
 		{
-			// cas attribut continu
-			//if (KWType::IsSimple(attribute->GetType()) and attribute->GetType() == KWType::Continuous)
+			// cas attribut continu ou categoriel
+			//if (KWType::IsSimple(attribute->GetType()))
+			krpaAttribute = NULL;
 			if (attribute->GetType() == KWType::Continuous)
+				krpaAttribute = new KRPreprocessedContinuousAttribute;
+			else if (attribute->GetType() == KWType::Symbol)
+				krpaAttribute = new KRPreprocessedSymbolAttribute;
+			if (krpaAttribute != NULL)
 			{
-				krpcAttribute = new KRPreprocessedContinuousAttribute;
-				krpcAttribute->SetClassStats(GetClassStats());
-				krpcAttribute->Initialize(kwdb, attribute);
-				oaPreprocessedAttributes.Add(krpcAttribute);
+				krpaAttribute->SetClassStats(GetClassStats());
+				krpaAttribute->SetObjectCounters(&krocCounters);
+				oaPreprocessedAttributes.Add(krpaAttribute);
+				column = new KRAttributeColumn;
+				column->Initialize(attribute);
+				oaColumns.Add(column);
 			}
+		}
+		else if (attribute->GetType() == KWType::Symbol)
+		{
+			targetColumn = new KRAttributeColumn;
+			targetColumn->Initialize(attribute);
+		}
+	}
+	if (targetColumn != NULL)
+		oaColumns.Add(targetColumn);
+
+	// Lecture de la base en une seule passe, les objets etant detruits des que leurs valeurs sont memorisees
+	bOk = ReadDatabaseColumns(kwdb, &oaColumns, nObjectNumber);
+
+	// Initialisation de la structure de compteurs d'objets, qui definit les rangs des objets
+	// partages par les attributs pretraites
+	if (bOk)
+		krocCounters.Initialize(nObjectNumber);
+
+	// Lecture des ordres de tri memorises dans le cache, s'il correspond a la base
+	nCachedSortOrderNumber = 0;
+	bCacheUpdateNeeded = false;
+	if (bOk and sPreprocessingCacheDirectory != "")
+	{
+		preprocessingCache.SetCacheDirectory(sPreprocessingCacheDirectory);
+		preprocessingCache.Load(kwdb, kwcClass, nObjectNumber);
+	}
+
+	// Pretraitement des attributs dont l'ordre de tri est dans le cache, les autres colonnes restant a trier
+	// Chaque colonne est detruite des que son attribut est pretraite
+	if (bOk)
+		oaSortedColumns.SetSize(oaPreprocessedAttributes.GetSize());
+	for (nIndex = 0; bOk and nIndex < oaPreprocessedAttributes.GetSize(); nIndex++)
+	{
+		column = cast(KRAttributeColumn*, oaColumns.GetAt(nIndex));
+		if (PreprocessAttributeFromCache(column, cast(KRPreprocessedAttribute*, oaPreprocessedAttributes.GetAt(nIndex)),
+						 &preprocessingCache))
+		{
+			nCachedSortOrderNumber++;
+			delete column;
+			oaColumns.SetAt(nIndex, NULL);
+		}
+		else
+		{
+			oaSortedColumns.SetAt(nIndex, column);
+			bCacheUpdateNeeded = true;
+		}
+	}
 
-			//cas attribut categoriel
-			//if (KWType::IsSimple(attribute->GetType()) and attribute->GetType() == KWType::Symbol)
-			if (attribute->GetType() == KWType::Symbol)
+	// Tri des autres attributs en parallele, chaque attribut etant trie independamment (cf. KRPreprocessingTask)
+	if (bOk and bCacheUpdateNeeded)
+		bOk = preprocessingTask.SortColumns(&oaSortedColumns, &oaSortedObjectRanks);
+
+	// Pretraitement de ces attributs a partir de leurs rangs tries, sans nouveau tri
+	for (nIndex = 0; bOk and nIndex < oaSortedColumns.GetSize(); nIndex++)
+	{
+		column = cast(KRAttributeColumn*, oaSortedColumns.GetAt(nIndex));
+		if (column != NULL)
+		{
+			assert(oaSortedObjectRanks.GetAt(nIndex) != NULL);
+			cast(KRPreprocessedAttribute*, oaPreprocessedAttributes.GetAt(nIndex))
+			    ->InitializeFromSortedObjectRanks(column, cast(IntVector*, oaSortedObjectRanks.GetAt(nIndex)));
+			delete column;
+			oaColumns.SetAt(nIndex, NULL);
+		}
+	}
+	oaSortedColumns.SetSize(0);
+	oaSortedObjectRanks.DeleteAll();
+
+	// Memorisation dans le cache des ordres de tri de tous les attributs, si certains ont ete recalcules
+	if (bOk and sPreprocessingCacheDirectory != "")
+	{
+		if (nCachedSortOrderNumber > 0)
+			Global::AddSimpleMessage(sTmp + "Sort orders read from preprocessing cache: " + IntToString(nCachedSortOrderNumber));
+		preprocessingCache.DeleteAll();
+		if (bCacheUpdateNeeded)
+		{
+			for (nIndex = 0; nIndex < oaPreprocessedAttributes.GetSize(); nIndex++)
 			{
-				krpsAttribute = new KRPreprocessedSymbolAttribute;
-				krpsAttribute->SetClassStats(GetClassStats());
-				krpsAttribute->Initialize(kwdb, attribute);
-				oaPreprocessedAttributes.Add(krpsAttribute);
-				//krpsAttribute->Test();
+				sortOrder = new KRSortOrder;
+				cast(KRPreprocessedAttribute*, oaPreprocessedAttributes.GetAt(nIndex))->ExportSortOrder(sortOrder);
+				preprocessingCache.AddSortOrder(sortOrder);
 			}
+			preprocessingCache.Save(kwdb, kwcClass, nObjectNumber);
+			preprocessingCache.DeleteAll();
 		}
 	}
 
-	// construction de la structure d'indexation
-	BuildIndexingStructure();
+	// Intervalles des bornes candidates des attributs numeriques, a partir des discretisations univariees
+	if (bOk and nBoundaryCandidateGranularity > 0)
+	{
+		nContinuousAttributeNumber = 0;
+		nCandidateIntervalNumber = 0;
+		for (nIndex = 0; nIndex < oaPreprocessedAttributes.GetSize(); nIndex++)
+		{
+			krpaAttribute = cast(KRPreprocessedAttribute*, oaPreprocessedAttributes.GetAt(nIndex));
+			if (krpaAttribute->GetAttributeType() == KWType::Continuous)
+			{
+				cast(KRPreprocessedContinuousAttribute*, krpaAttribute)->InitializeCandidateIntervals(nBoundaryCandidateGranularity);
+				nContinuousAttributeNumber++;
+				nCandidateIntervalNumber += cast(KRPreprocessedContinuousAttribute*, krpaAttribute)->GetCandidateIntervalNumber();
+			}
+		}
+		if (nContinuousAttributeNumber > 0)
+			Global::AddSimpleMessage(sTmp + "Candidate intervals for numerical bounds: " + IntToString(nCandidateIntervalNumber) +
+				" over " + IntToString(nContinuousAttributeNumber) + " numerical variables");
+	}
+
+	if (bOk)
+	{
+		// construction de la structure d'indexation
+		BuildIndexingStructure();
+
+		// Codes des classes cibles ou rangs des valeurs cibles, par rang d'objet
+		BuildObjectTargetCodes(targetColumn);
+
+		// Echantillon pour l'optimisation des bornes numeriques
+		BuildStratifiedSample();
+	}
+
+	// Nettoyage des colonnes restantes, et des attributs pretraites en cas d'erreur
+	oaColumns.DeleteAll();
+	if (not bOk)
+	{
+		oaPreprocessedAttributes.DeleteAll();
+		krocCounters.CleanObjects();
+	}
+	return bOk;
+}
+
+boolean KRRuleOptimizer::ReadDatabaseColumns(KWDatabase* kwdb, ObjectArray* oaColumns, int& nObjectNumber)
+{
+	boolean bOk;
+	KWObject* kwoObject;
+	int nColumn;
+	ALString sTmp;
+
+	require(kwdb != NULL);
+	require(oaColumns != NULL);
+
+	// Lecture des objets un a un
+	nObjectNumber = 0;
+	bOk = kwdb->OpenForRead();
+	if (bOk)
+	{
+		TaskProgression::DisplayLabel("Read database " + kwdb->GetDatabaseName());
+		while (not kwdb->IsEnd())
+		{
+			kwoObject = kwdb->Read();
+			if (kwoObject != NULL)
+			{
+				// Les objets etant identifies par un rang entier, leur nombre est limite
+				if (nObjectNumber == INT_MAX)
+				{
+					kwdb->AddError(sTmp + "Too many records for rule mining (more than " + IntToString(INT_MAX) + ")");
+					delete kwoObject;
+					bOk = false;
+					break;
+				}
+
+				// Memorisation des valeurs de l'objet au rang suivant, puis destruction de l'objet
+				for (nColumn = 0; nColumn < oaColumns->GetSize(); nColumn++)
+					cast(KRAttributeColumn*, oaColumns->GetAt(nColumn))->AddObjectValue(kwoObject);
+				nObjectNumber++;
+				delete kwoObject;
+			}
+			// Arret en cas d'erreur de lecture
+			else if (kwdb->IsError())
+			{
+				bOk = false;
+				break;
+			}
+
+			// Arret en cas d'interruption utilisateur
+			if (TaskProgression::IsRefreshNecessary() and TaskProgression::IsInterruptionRequested())
+			{
+				bOk = false;
+				break;
+			}
+		}
+		bOk = kwdb->Close() and bOk;
+	}
+	return bOk;
+}
+
+boolean KRRuleOptimizer::PreprocessAttributeFromCache(const KRAttributeColumn* column, KRPreprocessedAttribute* krpaAttribute,
+						       const KRPreprocessingCache* preprocessingCache)
+{
+	KRSortOrder* sortOrder;
+
+	require(column != NULL);
+	require(krpaAttribute != NULL);
+	require(krpaAttribute->GetAttributeType() == column->GetAttributeType());
+	require(preprocessingCache != NULL);
+
+	// Utilisation de l'ordre de tri du cache s'il est valide
+	sortOrder = preprocessingCache->LookupSortOrder(column->GetAttributeName());
+	return sortOrder != NULL and krpaAttribute->InitializeFromSortOrder(column, sortOrder);
+}
+
+void KRRuleOptimizer::BuildObjectTargetCodes(const KRAttributeColumn* targetColumn)
+{
+	KWDGSAttributeSymbolValues* kwdgsasvTarget;
+	KRPreprocessedContinuousAttribute* krpcaTarget;
+	IntVector ivValueTargetCodes;
+	int nTargetValueNumber;
+	int nObjectRank;
+	int nIndex;
+	int nValue;
+	int nCode;
+	KRCoverageBitmap* bmTargetClass;
+
+	require(GetClassStats()->GetTargetAttributeType() == KWType::Symbol or targetColumn == NULL);
+	require(targetColumn == NULL or targetColumn->GetObjectNumber() == krocCounters.GetRankNumber());
+
+	ivObjectTargetCodes.SetSize(0);
+	ivObjectTargetRanks.SetSize(0);
+	cvTargetValues.SetSize(0);
+	oaTargetClassBitmaps.DeleteAll();
+
+	// Bitmap de tous les objets
+	bmAllObjects.SetSize(krocCounters.GetRankNumber());
+	for (nObjectRank = 0; nObjectRank < krocCounters.GetRankNumber(); nObjectRank++)
+		bmAllObjects.Add(nObjectRank);
+
+	// Classification supervisee: code de la classe de chaque objet, a partir de la colonne de l'attribut cible
+	if (GetClassStats()->GetTargetAttributeType() == KWType::Symbol)
+	{
+		require(targetColumn != NULL);
+
+		// Valeurs cibles dans l'ordre utilise par les regles (cf. InitializeRule)
+		kwdgsasvTarget = cast(KWDGSAttributeSymbolValues*,
+			GetClassStats()->GetTargetValueStats()->GetAttributeAt(GetClassStats()->GetTargetValueStats()->GetFirstTargetAttributeIndex()));
+		nTargetValueNumber = GetClassStats()->GetTargetDescriptiveStats()->GetValueNumber();
+
+		// Code de la classe de chaque valeur de la colonne, recherche une seule fois par valeur
+		ivValueTargetCodes.SetSize(targetColumn->GetSymbolValueNumber());
+		for (nValue = 0; nValue < targetColumn->GetSymbolValueNumber(); nValue++)
+		{
+			for (nCode = 0; nCode < nTargetValueNumber; nCode++)
+			{
+				if (kwdgsasvTarget->GetValueAt(nCode) == targetColumn->GetSymbolValueAt(nValue))
+					break;
+			}
+			assert(nCode < nTargetValueNumber);
+			ivValueTargetCodes.SetAt(nValue, nCode);
+		}
+
+		ivObjectTargetCodes.SetSize(krocCounters.GetRankNumber());
+		for (nCode = 0; nCode < nTargetValueNumber; nCode++)
+		{
+			bmTargetClass = new KRCoverageBitmap;
+			bmTargetClass->SetSize(krocCounters.GetRankNumber());
+			oaTargetClassBitmaps.Add(bmTargetClass);
+		}
+		for (nObjectRank = 0; nObjectRank < krocCounters.GetRankNumber(); nObjectRank++)
+		{
+			nCode = ivValueTargetCodes.GetAt(targetColumn->GetSymbolCodeAt(nObjectRank));
+			ivObjectTargetCodes.SetAt(nObjectRank, nCode);
+			cast(KRCoverageBitmap*, oaTargetClassBitmaps.GetAt(nCode))->Add(nObjectRank);
+		}
+	}
+	// Regression: rang de la valeur cible de chaque objet parmi les valeurs cibles distinctes,
+	// a partir de l'attribut cible pretraite (deja trie)
+	else
+	{
+		krpcaTarget = cast(KRPreprocessedContinuousAttribute*, LookUpPreprocessedAttribute(GetClassStats()->GetTargetAttributeName()));
+		check(krpcaTarget);
+
+		ivObjectTargetRanks.SetSize(krocCounters.GetRankNumber());
+		for (nIndex = 0; nIndex < krpcaTarget->GetObjectNumber(); nIndex++)
+		{
+			if (nIndex == 0 or krpcaTarget->GetValueAt(nIndex) > cvTargetValues.GetAt(cvTargetValues.GetSize() - 1))
+				cvTargetValues.Add(krpcaTarget->GetValueAt(nIndex));
+			ivObjectTargetRanks.SetAt(krpcaTarget->GetObjectRankAt(nIndex), cvTargetValues.GetSize() - 1);
+		}
+	}
+}
+
+void KRRuleOptimizer::BuildStratifiedSample()
+{
+	const int nMinAutomaticSampleSize = 10000;
+	ObjectArray oaTargetRanks;
+	IntVector* ivTargetRanks;
+	KRPreprocessedAttribute* krpaAttribute;
+	int nInstanceNumber;
+	int nSampleSize;
+	int nSampleFrequency;
+	int nTarget;
+	int nRank;
+	int nIndex;
+	int nRandomIndex;
+	int nAttribute;
+	ALString sTmp;
+
+	require(krocCounters.GetRankNumber() == bmAllObjects.GetSize());
+
+	bmSampleObjects.SetSize(0);
+	ivSampleTargetFrequencies.SetSize(0);
+	ivTargetFrequencies.SetSize(0);
+
+	// Echantillonnage en classification uniquement
+	if (nOptimizationSampleSize == 0 or GetClassStats()->GetTargetAttributeType() != KWType::Symbol)
+		return;
+
+	// Taille de l'echantillon, explicite ou en racine du nombre d'instances
+	nInstanceNumber = bmAllObjects.GetCount();
+	if (nOptimizationSampleSize > 0)
+		nSampleSize = nOptimizationSampleSize;
+	else
+		nSampleSize = max(nMinAutomaticSampleSize, (int)(100 * sqrt(nInstanceNumber * 1.0)));
+	if (nSampleSize >= nInstanceNumber)
+		return;
+
+	// Rangs des objets de chaque classe
+	for (nTarget = 0; nTarget < oaTargetClassBitmaps.GetSize(); nTarget++)
+		oaTargetRanks.Add(new IntVector);
+	for (nRank = 0; nRank < bmAllObjects.GetSize(); nRank++)
+	{
+		if (bmAllObjects.Contains(nRank))
+			cast(IntVector*, oaTargetRanks.GetAt(ivObjectTargetCodes.GetAt(nRank)))->Add(nRank);
+	}
+
+	// Tirage sans remise dans chaque classe, proportionnellement a son effectif,
+	// avec au moins une instance par classe presente dans la base
+	bmSampleObjects.SetSize(krocCounters.GetRankNumber());
+	ivSampleTargetFrequencies.SetSize(oaTargetRanks.GetSize());
+	ivTargetFrequencies.SetSize(oaTargetRanks.GetSize());
+	for (nTarget = 0; nTarget < oaTargetRanks.GetSize(); nTarget++)
+	{
+		ivTargetRanks = cast(IntVector*, oaTargetRanks.GetAt(nTarget));
+		nSampleFrequency = (int)floor(ivTargetRanks->GetSize() * (double)nSampleSize / nInstanceNumber + 0.5);
+		if (nSampleFrequency == 0 and ivTargetRanks->GetSize() > 0)
+			nSampleFrequency = 1;
+		for (nIndex = 0; nIndex < nSampleFrequency; nIndex++)
+		{
+			nRandomIndex = nIndex + RandomInt(ivTargetRanks->GetSize() - nIndex - 1);
+			nRank = ivTargetRanks->GetAt(nRandomIndex);
+			ivTargetRanks->SetAt(nRandomIndex, ivTargetRanks->GetAt(nIndex));
+			ivTargetRanks->SetAt(nIndex, nRank);
+			bmSampleObjects.Add(nRank);
+		}
+		ivSampleTargetFrequencies.SetAt(nTarget, nSampleFrequency);
+		ivTargetFrequencies.SetAt(nTarget, ivTargetRanks->GetSize());
+	}
+	oaTargetRanks.DeleteAll();
+
+	// Index des objets de l'echantillon dans l'ordre de tri de chaque attribut numerique
+	for (nAttribute = 0; nAttribute < oaPreprocessedAttributes.GetSize(); nAttribute++)
+	{
+		krpaAttribute = cast(KRPreprocessedAttribute*, oaPreprocessedAttributes.GetAt(nAttribute));
+		if (krpaAttribute->GetAttributeType() == KWType::Continuous)
+			cast(KRPreprocessedContinuousAttribute*, krpaAttribute)->InitializeSample(&bmSampleObjects);
+	}
+	Global::AddSimpleMessage(sTmp + "Stratified sample for rule optimization: " + IntToString(bmSampleObjects.GetCount()) +
+		" instances out of " + IntToString(nInstanceNumber));
+}
+
+boolean KRRuleOptimizer::IsSampleOptimizationUsed(const KRRule* rule) const
+{
+	require(rule != NULL);
+	return bmSampleObjects.GetSize() > 0 and rule->GetTargetType() == KWType::Symbol;
+}
+
+int KRRuleOptimizer::EstimateTargetFrequency(int nTarget, int nSampleFrequency) const
+{
+	int nFrequency;
+
+	require(0 <= nTarget and nTarget < ivSampleTargetFrequencies.GetSize());
+	require(nSampleFrequency >= 0);
+
+	// Mise a l'echelle par le taux d'echantillonnage de la classe, sans depasser son effectif
+	// (l'objet de reference d'une regle peut s'ajouter aux instances de l'echantillon)
+	if (ivSampleTargetFrequencies.GetAt(nTarget) == 0)
+		return 0;
+	nFrequency = (int)floor(nSampleFrequency * (double)ivTargetFrequencies.GetAt(nTarget) / ivSampleTargetFrequencies.GetAt(nTarget) + 0.5);
+	return min(nFrequency, ivTargetFrequencies.GetAt(nTarget));
+}
+
+int KRRuleOptimizer::ComputeFrequencyIncrement(int nTarget, IntVector* ivSampleFrequencies) const
+{
+	int nSampleFrequency;
+
+	require(ivSampleFrequencies != NULL);
+
+	if (not bSampleSweep)
+		return 1;
+	nSampleFrequency = ivSampleFrequencies->GetAt(nTarget);
+	ivSampleFrequencies->SetAt(nTarget, nSampleFrequency + 1);
+	return EstimateTargetFrequency(nTarget, nSampleFrequency + 1) - EstimateTargetFrequency(nTarget, nSampleFrequency);
+}
+
+void KRRuleOptimizer::ComputeTargetRankPartIndexes(KRRule* rule, IntVector* ivTargetRankPartIndexes) const
+{
+	int nTargetRank;
+
+	require(rule != NULL);
+	require(rule->GetTargetType() == KWType::Continuous);
+	require(ivTargetRankPartIndexes != NULL);
 
-	// Initialisation de la structure de compteurs d'objets
-	krocCounters.InitializeObjects(kwdb->GetObjects());
+	// Partie de l'attribut cible de chaque valeur cible distincte
+	ivTargetRankPartIndexes->SetSize(cvTargetValues.GetSize());
+	for (nTargetRank = 0; nTargetRank < cvTargetValues.GetSize(); nTargetRank++)
+	{
+		ivTargetRankPartIndexes->SetAt(nTargetRank, rule->ComputeContinuousTargetValuePartIndex(cvTargetValues.GetAt(nTargetRank)));
+		assert(0 <= ivTargetRankPartIndexes->GetAt(nTargetRank) and
+		       ivTargetRankPartIndexes->GetAt(nTargetRank) < rule->GetTargetAttribute()->GetPartNumber());
+	}
 }
 
-void KRRuleOptimizer::RandomAttributeSubsetSelection(KWDatabase* kwdb, ObjectArray* oaAttributes)
+void KRRuleOptimizer::RandomAttributeSubsetSelection(ObjectArray* oaAttributes)
 {
 	KWClass* kwcClass;
 	//ObjectArray* oaAttributes; // Parametre contenbant le resultat en sortie
@@ -430,13 +994,11 @@ void KRRuleOptimizer::RandomAttributeSubsetSelection(KWDatabase* kwdb, ObjectArr
 	}
 }
 
-double KRRuleOptimizer::InitializeRule(KWDatabase* kwdb,
-	ObjectArray* oaAttributes,
-	KWObject* kwoInBody,
+double KRRuleOptimizer::InitializeRule(ObjectArray* oaAttributes,
+	int nInBodyObjectRank,
 	KRRule* krrInitRule)
 {
 	int nIndex;
-	const KWClass* kwcSortClass;
 	const KWClass* kwcClass;
 	KWAttribute* kwaAttribute;
 	KRRAttribute* krrAttribute;
@@ -456,7 +1018,7 @@ double KRRuleOptimizer::InitializeRule(KWDatabase* kwdb,
 	else // regression case
 		krrInitRule->Initialize(oaAttributes->GetSize(), GetClassStats()->GetTargetAttributeType(), 0);
 
-	krrInitRule->SetTotalFrequency(kwdb->GetObjects()->GetSize());
+	krrInitRule->SetTotalFrequency(krocCounters.GetRankNumber());
 
 	// Init distribution des classes dans la base et dans le corps pour la classification supervise simple
 	if (GetClassStats()->GetTargetAttributeType() == KWType::Symbol)
@@ -487,20 +1049,19 @@ double KRRuleOptimizer::InitializeRule(KWDatabase* kwdb,
 
 	for (nIndex = 0; nIndex < oaAttributes->GetSize(); nIndex++)
 	{
-		kwcSortClass = kwoInBody->GetClass();
 		kwaAttribute = cast(KWAttribute*, oaAttributes->GetAt(nIndex));
-		kwaAttribute = kwcSortClass->LookupAttribute(kwaAttribute->GetName());
+		kwaAttribute = kwcClass->LookupAttribute(kwaAttribute->GetName());
 		//cout << "att : " << kwaAttribute->GetName() << endl;
 		// attributs numeriques
 		// Construction de l'attribut de la regle
 		krrAttribute = krrInitRule->GetAttributeAt(nIndex);
 		if (kwaAttribute->GetType() == KWType::Continuous)
 		{
-			InitAttributeIntervals(kwdb, kwoInBody, kwaAttribute, krrAttribute);
+			InitAttributeIntervals(nInBodyObjectRank, kwaAttribute, krrAttribute);
 		}
 		if (kwaAttribute->GetType() == KWType::Symbol)
 		{
-			InitAttributeValueSets(kwdb, kwoInBody, kwaAttribute, krrAttribute);
+			InitAttributeValueSets(nInBodyObjectRank, kwaAttribute, krrAttribute);
 		}
 		//krrAttribute->Write(cout);
 	}
@@ -508,12 +1069,11 @@ double KRRuleOptimizer::InitializeRule(KWDatabase* kwdb,
 	krrInitRule->DeleteNonInformativeAttributes();
 	nInformativeAttributeNumber = krrInitRule->ComputeInformativeAttributeNumber();
 	/*cout << "*****************\n";
-	kwoInBody->Write(cout);
 	krrInitRule->Write(cout);
 	cout << "*****************\n";*/
 
-	assert(IsInBody(kwoInBody, krrInitRule));
-	UpdateAllStatistics(kwdb, krrInitRule);
+	assert(IsInBody(nInBodyObjectRank, krrInitRule));
+	UpdateAllStatistics(krrInitRule);
 
 	//nInformativeAttributeNumber = krrInitRule->ComputeInformativeAttributeNumber();
 	//krrInitRule->InitializeAllCosts(GetRuleCosts());
@@ -523,11 +1083,9 @@ double KRRuleOptimizer::InitializeRule(KWDatabase* kwdb,
 	return 0;
 }
 
-void KRRuleOptimizer::InitAttributeIntervals(KWDatabase* database, KWObject* kwoRandomObject, KWAttribute* kwaAttribute, KRRAttribute* krrAttribute)
+void KRRuleOptimizer::InitAttributeIntervals(int nRandomObjectRank, KWAttribute* kwaAttribute, KRRAttribute* krrAttribute)
 {
-	KWLoadIndex liAttributeLoadIndex;
 	Continuous cRandomObjectValue;
-	KWObject* kwoObject;
 	int nObjectIndex;
 	int nLowerIndex;
 	int nUpperIndex;
@@ -537,10 +1095,9 @@ void KRRuleOptimizer::InitAttributeIntervals(KWDatabase* database, KWObject* kwo
 	KRRInterval* interval;
 	Continuous cLowerBound;
 	Continuous cUpperBound;
-	KRPreprocessedAttribute* krpcaAttribute;
+	KRPreprocessedContinuousAttribute* krpcaAttribute;
 
-	require(database != NULL);
-	require(kwoRandomObject != NULL);
+	require(0 <= nRandomObjectRank and nRandomObjectRank < krocCounters.GetRankNumber());
 	require(kwaAttribute != NULL);
 	require(kwaAttribute->GetType() == KWType::Continuous);
 	require(krrAttribute != NULL);
@@ -549,26 +1106,26 @@ void KRRuleOptimizer::InitAttributeIntervals(KWDatabase* database, KWObject* kwo
 	// Initilaisation de base de l'attribut de la regle
 	krrAttribute->SetAttributeName(kwaAttribute->GetName());
 	krrAttribute->SetAttributeType(kwaAttribute->GetType());
-	krrAttribute->SetValueNumber(database->GetObjects()->GetSize());
-
-	// Acces a l'index de l'objet dans la base
-	liAttributeLoadIndex = kwaAttribute->GetLoadIndex();
-
-	// Acces a la valeur "centrale" de l'objet random
-	cRandomObjectValue = kwoRandomObject->GetContinuousValueAt(liAttributeLoadIndex);
+	krrAttribute->SetValueNumber(krocCounters.GetRankNumber());
 
 	// Tri de la base selon l'attribut
 	krpcaAttribute = cast(KRPreprocessedContinuousAttribute*, LookUpPreprocessedAttribute(krrAttribute->GetAttributeName()));
 	//database->SortObjectsOnContinuous(kwaAttribute->GetName());
 
-	// Recherche de l'index de l'objet random, selon cet ordre
-	for (nObjectIndex = 0; nObjectIndex < krpcaAttribute->GetObjects()->GetSize(); nObjectIndex++)
+	// Acces a la valeur "centrale" de l'objet random
+	cRandomObjectValue = krpcaAttribute->GetValueAtRank(nRandomObjectRank);
+
+	// Initialisation a partir de la discretisation univariee si demande, sinon bornes au hasard
+	if (bUnivariateInitialization and InitAttributeIntervalsFromUnivariatePartition(krpcaAttribute, cRandomObjectValue, krrAttribute))
+		return;
+
+	// Recherche de l'index de l'objet random, selon cet ordre, parmi les objets de meme valeur
+	for (nObjectIndex = krpcaAttribute->SearchUpperIndex(cRandomObjectValue) - 1; nObjectIndex >= 0; nObjectIndex--)
 	{
-		kwoObject = cast(KWObject*, krpcaAttribute->GetObjects()->GetAt(nObjectIndex));
-		if (kwoObject == kwoRandomObject)
+		if (krpcaAttribute->GetObjectRankAt(nObjectIndex) == nRandomObjectRank)
 			break;
 	}
-	assert(0 <= nObjectIndex and nObjectIndex < krpcaAttribute->GetObjects()->GetSize());
+	assert(0 <= nObjectIndex and nObjectIndex < krpcaAttribute->GetObjectNumber());
 
 	// Recherche d'une borne d'intervalle precedent l'objet courant
 	nLowerIndex = RandomInt(nObjectIndex);
@@ -576,8 +1133,7 @@ void KRRuleOptimizer::InitAttributeIntervals(KWDatabase* database, KWObject* kwo
 	cLowerBound = KWContinuous::GetForbiddenValue();
 	while (nLowerIndex >= 0)
 	{
-		kwoObject = cast(KWObject*, krpcaAttribute->GetObjects()->GetAt(nLowerIndex));
-		cLowerValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
+		cLowerValue = krpcaAttribute->GetValueAt(nLowerIndex);
 
 		// Arret des que l'on a une valeur strictement inferieure a la valeur de l'objet random
 		if (cLowerValue < cRandomObjectValue)
@@ -585,8 +1141,7 @@ void KRRuleOptimizer::InitAttributeIntervals(KWDatabase* database, KWObject* kwo
 			// Calcul de la borne de l'intervalle, valeur moyenne de la valeur avec la suivante
 			while (nLowerIndex <= nObjectIndex)
 			{
-				kwoObject = cast(KWObject*, krpcaAttribute->GetObjects()->GetAt(nLowerIndex));
-				cValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
+				cValue = krpcaAttribute->GetValueAt(nLowerIndex);
 				if (cValue > cLowerValue)
 				{
 					cLowerBound = KWContinuous::GetLowerMeanValue(cLowerValue, cValue);
@@ -601,13 +1156,12 @@ void KRRuleOptimizer::InitAttributeIntervals(KWDatabase* database, KWObject* kwo
 	assert(cLowerValue != KWContinuous::GetForbiddenValue() and cLowerValue <= cRandomObjectValue);
 
 	// Recherche d'une borne d'intervalle suivant l'objet courant
-	nUpperIndex = nObjectIndex + RandomInt(database->GetObjects()->GetSize() - nObjectIndex - 1);
+	nUpperIndex = nObjectIndex + RandomInt(krocCounters.GetRankNumber() - nObjectIndex - 1);
 	cUpperValue = KWContinuous::GetForbiddenValue();
 	cUpperBound = KWContinuous::GetForbiddenValue();
-	while (nUpperIndex < database->GetObjects()->GetSize())
+	while (nUpperIndex < krocCounters.GetRankNumber())
 	{
-		kwoObject = cast(KWObject*, krpcaAttribute->GetObjects()->GetAt(nUpperIndex));
-		cUpperValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
+		cUpperValue = krpcaAttribute->GetValueAt(nUpperIndex);
 
 		// Arret des que l'on a une valeur strictement superieure a la valeur de l'objet random
 		if (cUpperValue > cRandomObjectValue)
@@ -615,8 +1169,7 @@ void KRRuleOptimizer::InitAttributeIntervals(KWDatabase* database, KWObject* kwo
 			// Calcul de la borne de l'intervalle, valeur moyenne de la valeur avec la precedente
 			while (nUpperIndex >= nObjectIndex)
 			{
-				kwoObject = cast(KWObject*, krpcaAttribute->GetObjects()->GetAt(nUpperIndex));
-				cValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
+				cValue = krpcaAttribute->GetValueAt(nUpperIndex);
 				if (cValue < cUpperValue)
 				{
 					cUpperBound = KWContinuous::GetLowerMeanValue(cValue, cUpperValue);
@@ -697,25 +1250,93 @@ void KRRuleOptimizer::InitAttributeIntervals(KWDatabase* database, KWObject* kwo
 	}
 }
 
-void KRRuleOptimizer::InitAttributeValueSets(KWDatabase* database, KWObject* kwoRandomObject, KWAttribute* kwaAttribute, KRRAttribute* krrAttribute)
+boolean KRRuleOptimizer::InitAttributeIntervalsFromUnivariatePartition(KRPreprocessedContinuousAttribute* krpcaAttribute,
+	Continuous cRandomObjectValue,
+	KRRAttribute* krrAttribute)
+{
+	const int nExtensionRate = 4;
+	const KWDGSAttributeDiscretization* discretization;
+	int nBoundNumber;
+	int nObjectInterval;
+	int nLowerBound;
+	int nUpperBound;
+	Continuous cLowerBound;
+	Continuous cUpperBound;
+	KRRInterval* interval;
+
+	require(krpcaAttribute != NULL);
+	require(krrAttribute != NULL);
+	require(krrAttribute->GetAttributeType() == KWType::Continuous);
+	require(krrAttribute->GetPartNumber() == 0);
+
+	// Discretisation univariee, et valeur de l'objet non manquante
+	discretization = cast(const KWDGSAttributeDiscretization*, krpcaAttribute->GetUnivariatePartition());
+	if (discretization == NULL or cRandomObjectValue == KWContinuous::GetMissingValue())
+		return false;
+	nBoundNumber = discretization->GetIntervalBoundNumber();
+
+	// Intervalle de l'objet (intervalles de la forme ]a;b]): nombre de bornes strictement inferieures a sa valeur
+	nObjectInterval = 0;
+	while (nObjectInterval < nBoundNumber and discretization->GetIntervalBoundAt(nObjectInterval) < cRandomObjectValue)
+		nObjectInterval++;
+
+	// Bornes de l'intervalle, chacune etant repoussee au hasard d'un intervalle pour la diversite des relances
+	nLowerBound = nObjectInterval - 1;
+	if (RandomInt(nExtensionRate - 1) == 0)
+		nLowerBound--;
+	nUpperBound = nObjectInterval;
+	if (RandomInt(nExtensionRate - 1) == 0)
+		nUpperBound++;
+	cLowerBound = KRRInterval::GetMinLowerBound();
+	if (nLowerBound >= 0 and discretization->GetIntervalBoundAt(nLowerBound) > KRRInterval::GetMinLowerBound())
+		cLowerBound = discretization->GetIntervalBoundAt(nLowerBound);
+	cUpperBound = KRRInterval::GetMaxUpperBound();
+	if (nUpperBound < nBoundNumber)
+		cUpperBound = discretization->GetIntervalBoundAt(nUpperBound);
+	assert(cLowerBound < cRandomObjectValue and cRandomObjectValue <= cUpperBound);
+
+	// Creation de l'intervalle du corps, precede et suivi si necessaire d'un intervalle hors du corps
+	if (cLowerBound > KRRInterval::GetMinLowerBound())
+	{
+		krrAttribute->AddPart();
+		interval = krrAttribute->GetPartAt(0)->GetInterval();
+		interval->SetLowerBound(KRRInterval::GetMinLowerBound());
+		interval->SetUpperBound(cLowerBound);
+	}
+	krrAttribute->AddPart();
+	krrAttribute->SetBodyPartIndex(krrAttribute->GetPartNumber() - 1);
+	interval = krrAttribute->GetPartAt(krrAttribute->GetBodyPartIndex())->GetInterval();
+	interval->SetLowerBound(cLowerBound);
+	interval->SetUpperBound(cUpperBound);
+	if (cUpperBound < KRRInterval::GetMaxUpperBound())
+	{
+		krrAttribute->AddPart();
+		interval = krrAttribute->GetPartAt(krrAttribute->GetPartNumber() - 1)->GetInterval();
+		interval->SetLowerBound(cUpperBound);
+		interval->SetUpperBound(KRRInterval::GetMaxUpperBound());
+	}
+	return true;
+}
+
+void KRRuleOptimizer::InitAttributeValueSets(int nRandomObjectRank, KWAttribute* kwaAttribute, KRRAttribute* krrAttribute)
 {
-	KWLoadIndex liAttributeLoadIndex;
+	const int nExtensionRate = 4;
 	int nTotalValueNumber;
-	int nObjectIndex;
+	int nValue;
 	int nRandomPartIndex;
-	KWObject* kwoObject;
+	IntVector ivValueGroupIndexes;
+	IntVector ivBodyGroups;
+	int nUnivariateGroupNumber;
+	int nObjectGroup;
+	int nGroup;
 	Symbol sRandomObjectValue;
-	Symbol sCurrentValue;
-	Symbol sPrecValue;
 	SymbolVector svAttributeValues;
 	Symbol sSourceValue;
 	Symbol sSourceRef;
-	int nValueFrequency;
-	int nValueSmallestFrequency;
 	KRPreprocessedSymbolAttribute* krpsaAttribute;
+	KRPreprocessedValue* krpvValue;
 
-	require(database != NULL);
-	require(kwoRandomObject != NULL);
+	require(0 <= nRandomObjectRank and nRandomObjectRank < krocCounters.GetRankNumber());
 	require(kwaAttribute != NULL);
 	require(kwaAttribute->GetType() == KWType::Symbol);
 	require(krrAttribute != NULL);
@@ -725,72 +1346,64 @@ void KRRuleOptimizer::InitAttributeValueSets(KWDatabase* database, KWObject* kwo
 	krrAttribute->SetAttributeName(kwaAttribute->GetName());
 	krrAttribute->SetAttributeType(kwaAttribute->GetType());
 
-	// Acces a l'index de l'objet dans la base
-	liAttributeLoadIndex = kwaAttribute->GetLoadIndex();
-
-	// Acces a la valeur "centrale" de l'objet random
-	sRandomObjectValue = kwoRandomObject->GetSymbolValueAt(liAttributeLoadIndex);
-
 	// Tri de la base sur cet attribut
 	// DDDdatabase->SortObjectsOnSymbol(kwaAttribute->GetName());
 	krpsaAttribute = cast(KRPreprocessedSymbolAttribute*, LookUpPreprocessedAttribute(krrAttribute->GetAttributeName()));
 
+	// Acces a la valeur "centrale" de l'objet random, par son code
+	sRandomObjectValue = krpsaAttribute->GetPreprocessedValueAt(krpsaAttribute->GetObjectValueCodeAtRank(nRandomObjectRank))->GetValue();
+
+	// Initialisation a partir du groupement univarie si demande: le corps contient les valeurs du groupe
+	// de l'objet, et chaque autre groupe y est ajoute au hasard pour la diversite des relances
+	nUnivariateGroupNumber = 0;
+	if (bUnivariateInitialization)
+		nUnivariateGroupNumber = krpsaAttribute->ComputeUnivariateGroupIndexes(&ivValueGroupIndexes);
+	if (nUnivariateGroupNumber > 0)
+	{
+		nObjectGroup = ivValueGroupIndexes.GetAt(krpsaAttribute->GetObjectValueCodeAtRank(nRandomObjectRank));
+		ivBodyGroups.SetSize(nUnivariateGroupNumber);
+		ivBodyGroups.Initialize();
+		for (nGroup = 0; nGroup < nUnivariateGroupNumber; nGroup++)
+		{
+			if (nGroup == nObjectGroup or RandomInt(nExtensionRate - 1) == 0)
+				ivBodyGroups.SetAt(nGroup, 1);
+		}
+	}
+
 	// Creation des deux parties de l'attribut (dans et hors du corps)
 	krrAttribute->AddPart(); // part 0 dans le corps
 	krrAttribute->AddPart(); // part 1 hors du corps
 	krrAttribute->SetBodyPartIndex(0);
-	nTotalValueNumber = 1;
-	nValueFrequency = 0;
-	nValueSmallestFrequency = krpsaAttribute->GetObjects()->GetSize() + 1;
-	sPrecValue = cast(KWObject*, krpsaAttribute->GetObjects()->GetAt(0))->GetSymbolValueAt(liAttributeLoadIndex);
-	//DDD nValueSmallestFrequency = database->GetObjects()->GetSize()+1;
-	//DDD sPrecValue = cast(KWObject*, database->GetObjects()->GetAt(0))->GetSymbolValueAt(liAttributeLoadIndex);
-	// Recherche de l'index de l'objet random, selon cet ordre
-	//DDDfor (nObjectIndex = 0; nObjectIndex < database->GetObjects()->GetSize(); nObjectIndex++)
-	for (nObjectIndex = 0; nObjectIndex < krpsaAttribute->GetObjects()->GetSize(); nObjectIndex++)
-	{
-		kwoObject = cast(KWObject*, krpsaAttribute->GetObjects()->GetAt(nObjectIndex));
-		//DDD kwoObject = cast(KWObject*, database->GetObjects()->GetAt(nObjectIndex));
-		sCurrentValue = kwoObject->GetSymbolValueAt(liAttributeLoadIndex);
-
-		if (sCurrentValue != sPrecValue)
-		{
-			assert(nValueFrequency > 0);
-			// La base est censee triee
-			assert(nObjectIndex == 0 or sCurrentValue.GetNumericKey() > sPrecValue.GetNumericKey());
+	krrAttribute->GetBodyValueCodes()->SetSize(krpsaAttribute->GetPreprocessedValueNumber());
+	nTotalValueNumber = 0;
 
-			// Incrementation du nombre de valeurs de l'attribut
-			nTotalValueNumber++;
+	// Parcours des valeurs pretraitees, dans l'ordre de leur code
+	for (nValue = 0; nValue < krpsaAttribute->GetPreprocessedValueNumber(); nValue++)
+	{
+		krpvValue = krpsaAttribute->GetPreprocessedValueAt(nValue);
 
-			// Ajout de la valeur precedente dans un des valueSet (dans ou hors du corps) au hasard
-			nRandomPartIndex = RandomInt(1);
-			if (sPrecValue == sRandomObjectValue) // valeur de l'objet reference dans le corps
-			{
-				krrAttribute->GetPartAt(0)->GetValueSet()->AddValue(sPrecValue, nValueFrequency);
-			}
-			else
-			{
-				krrAttribute->GetPartAt(nRandomPartIndex)->GetValueSet()->AddValue(sPrecValue, nValueFrequency);
-			}
+		// Incrementation du nombre de valeurs de l'attribut
+		nTotalValueNumber++;
 
-			// Reinitialisation des variables de travail
-			sPrecValue = sCurrentValue;
-			nValueFrequency = 1;
-		}
-		else
+		// Partie de la valeur (dans ou hors du corps) au hasard, ou selon son groupe univarie
+		// Comme lors du parcours des objets tries, le tirage n'est omis que pour la derniere valeur
+		// si c'est celle de l'objet reference
+		nRandomPartIndex = 0;
+		if (nValue < krpsaAttribute->GetPreprocessedValueNumber() - 1 or krpvValue->GetValue() != sRandomObjectValue)
 		{
-			nValueFrequency++;
-		}
-
-		// Pour la derniere valeur
-		if (nObjectIndex == krpsaAttribute->GetObjects()->GetSize() - 1)
-			if (sCurrentValue == sRandomObjectValue)
-				krrAttribute->GetPartAt(0)->GetValueSet()->AddValue(sCurrentValue, nValueFrequency);
+			if (nUnivariateGroupNumber > 0)
+				nRandomPartIndex = 1 - ivBodyGroups.GetAt(ivValueGroupIndexes.GetAt(nValue));
 			else
-			{
 				nRandomPartIndex = RandomInt(1);
-				krrAttribute->GetPartAt(nRandomPartIndex)->GetValueSet()->AddValue(sCurrentValue, nValueFrequency);
-			}
+		}
+
+		// Ajout de la valeur dans un des valueSet, la valeur de l'objet reference etant dans le corps
+		// Le code de la valeur est memorise dans l'ensemble des codes du corps le cas echeant
+		if (krpvValue->GetValue() == sRandomObjectValue)
+			nRandomPartIndex = 0;
+		krrAttribute->GetPartAt(nRandomPartIndex)->GetValueSet()->AddValue(krpvValue->GetValue(), krpvValue->GetValueFrequency());
+		if (nRandomPartIndex == 0)
+			krrAttribute->GetBodyValueCodes()->Add(krpvValue->GetValueCode());
 	}
 
 	// Ajout de la modalite speciale dans le corps
@@ -809,37 +1422,32 @@ void KRRuleOptimizer::InitAttributeValueSets(KWDatabase* database, KWObject* kwo
 	krrAttribute->GetPartAt(1)->GetValueSet()->BuildIndexingStructure();*/
 }
 
-void KRRuleOptimizer::UpdateSubStatistics(ObjectArray* oaWorkingInstances, KRRule* krrInitRule)
+void KRRuleOptimizer::UpdateSubStatistics(const IntVector* ivWorkingObjectRanks, KRRule* krrInitRule)
 {
 	int nObjectIndex;
 	int nIndex;
-	KWObject* kwoTempObject;
-	const KWClass* kwcSortClass;
-	Symbol sCurrentValue;
-	KWLoadIndex liTargetAttributeIndex;
-	Symbol sObjectTargetValue;
+	int nObjectRank;
 	int nObjectTargetValueIndex;
 	int nInformativeAttributeNumber;
 
+	require(krrInitRule->GetTargetType() == KWType::Symbol);
+
 	// remise a zero des vecteurs de frequence par classe avant update
 	for (nIndex = 0; nIndex < krrInitRule->GetTargetValueNumber(); nIndex++)
 	{
 		krrInitRule->SetInBodyTargetValueFrequencyAt(nIndex, 0);
 	}
 
-	for (nObjectIndex = 0; nObjectIndex < oaWorkingInstances->GetSize(); nObjectIndex++)
+	for (nObjectIndex = 0; nObjectIndex < ivWorkingObjectRanks->GetSize(); nObjectIndex++)
 	{
-		kwoTempObject = cast(KWObject*, oaWorkingInstances->GetAt(nObjectIndex));
-		kwcSortClass = kwoTempObject->GetClass();
+		nObjectRank = ivWorkingObjectRanks->GetAt(nObjectIndex);
 
 		// si l'objet est couvert par la regle
-		if (krocCounters.GetBodyCountAt(kwoTempObject) == krrInitRule->GetAttributeNumber())
+		if (krocCounters.GetBodyCountAtRank(nObjectRank) == krrInitRule->GetAttributeNumber())
 		{
-			// modification des vecteurs de frequences de la ragle
-			liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
-			sObjectTargetValue = kwoTempObject->GetSymbolValueAt(liTargetAttributeIndex);
-			nObjectTargetValueIndex = krrInitRule->ComputeTargetValueIndex(sObjectTargetValue);
-			require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrInitRule->GetTargetValueNumber());
+			// modification des vecteurs de frequences de la ragle, a partir du code de classe precalcule
+			nObjectTargetValueIndex = ivObjectTargetCodes.GetAt(nObjectRank);
+			assert(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrInitRule->GetTargetValueNumber());
 			krrInitRule->SetInBodyTargetValueFrequencyAt(nObjectTargetValueIndex,
 				krrInitRule->GetInBodyTargetValueFrequencyAt(nObjectTargetValueIndex) + 1);
 		}
@@ -850,29 +1458,19 @@ void KRRuleOptimizer::UpdateSubStatistics(ObjectArray* oaWorkingInstances, KRRul
 	//ruleCosts->ComputeRuleTotalCost(krrInitRule);
 	ruleCosts->ComputeRuleCompressionCoefficient(krrInitRule);
 	assert(krrInitRule->CheckAllCosts(GetRuleCosts()));
-	//krrInitRule->SetLevel(ComputeRuleLevel(database, krrInitRule));
+	//krrInitRule->SetLevel(ComputeRuleLevel(krrInitRule));
 }
 
 ///DDD
-void KRRuleOptimizer::UpdateAllStatistics(KWDatabase* database, KRRule* krrInitRule)
+void KRRuleOptimizer::UpdateAllStatistics(KRRule* krrInitRule)
 {
-	int nObjectIndex;
 	int nIndex;
-	int nAttributeIndex;
-	KWObject* kwoTempObject;
-	bool bCovered;
-	KWAttribute* kwaAttribute;
-	const KWClass* kwcSortClass;
-	KRRAttribute* krrAttribute;
-	KWLoadIndex liAttributeIndex;
-	Continuous cCurrentValue;
-	Symbol sCurrentValue;
-	KRRPart* krrpBodyPart;
-	KWLoadIndex liTargetAttributeIndex;
-	Symbol sObjectTargetValue;
-	Continuous cObjectTargetValue;
+	int nObjectRank;
 	int nObjectTargetValueIndex;
 	int nInformativeAttributeNumber;
+	IntVector ivTargetRankPartIndexes;
+	KRRuleCoveragePlan* coveragePlan;
+	KRCoverageBitmap bmBody;
 
 	// remise a zero des vecteurs inBody de frequence par classe avant update
 	for (nIndex = 0; nIndex < krrInitRule->GetTargetValueNumber(); nIndex++)
@@ -889,83 +1487,43 @@ void KRRuleOptimizer::UpdateAllStatistics(KWDatabase* database, KRRule* krrInitR
 		{
 			krrInitRule->SetTargetValueFrequencyAt(nIndex, 0);
 		}
+
+		// Partie de l'attribut cible par rang de valeur cible, calculee une seule fois par mise a jour
+		ComputeTargetRankPartIndexes(krrInitRule, &ivTargetRankPartIndexes);
 	}
 
-	for (nObjectIndex = 0; nObjectIndex < database->GetObjects()->GetSize(); nObjectIndex++)
+	// Plan de couverture de la regle, synchronise avec la regle, puis calcul des objets couverts
+	// par intersection des bitmaps des conditions
+	coveragePlan = GetRuleCoveragePlan(krrInitRule);
+	coveragePlan->ComputeBodyBitmap(&bmAllObjects, &bmBody);
+
+	// classification supervisee: effectif de chaque classe dans le corps par comptage des bits
+	// de l'intersection du corps avec le bitmap de la classe
+	if (krrInitRule->GetTargetType() == KWType::Symbol)
 	{
-		kwoTempObject = cast(KWObject*, database->GetObjects()->GetAt(nObjectIndex));
-		kwcSortClass = kwoTempObject->GetClass();
-		bCovered = true;
-		for (nAttributeIndex = 0; nAttributeIndex < krrInitRule->GetAttributeNumber(); nAttributeIndex++)
-		{
-			krrAttribute = krrInitRule->GetAttributeAt(nAttributeIndex);
-			kwaAttribute = kwcSortClass->LookupAttribute(krrAttribute->GetAttributeName());
-			liAttributeIndex = kwaAttribute->GetLoadIndex();
-			krrpBodyPart = krrAttribute->GetPartAt(krrAttribute->GetBodyPartIndex());
-			// cas categoriel : test de couverture
-			if (krrAttribute->GetAttributeType() == KWType::Symbol and (not krrAttribute->GetAttributeTargetFunction()))
-			{
-				//krrAttribute->BuildIndexingStructure();
-				sCurrentValue = kwoTempObject->GetSymbolValueAt(liAttributeIndex);
-				//if (not (krrAttribute->LookupSymbolPart(sCurrentValue) == krrpBodyPart))
-				if (not krrAttribute->IsInBodySymbol(sCurrentValue))
-					// si valeur de l'attribut de l'objet n'est pas dans la partie active du corps
-				{
-					bCovered = false;
-					//krrAttribute->DeleteIndexingStructure();
-					break;
-				}
-			}
-			// cas numerique : test de couverture
-			if (krrAttribute->GetAttributeType() == KWType::Continuous and (not krrAttribute->GetAttributeTargetFunction()))
-			{
-				cCurrentValue = kwoTempObject->GetContinuousValueAt(liAttributeIndex);
-				//if (not (krrpBodyPart->GetInterval()->GetLowerBound() < cCurrentValue
-				//		and krrpBodyPart->GetInterval()->GetUpperBound() >= cCurrentValue))
-				if (not krrAttribute->IsInBodyContinuous(cCurrentValue))
-					// si valeur de l'attribut de l'objet n'est pas dans la partie active du corps
-				{
-					bCovered = false;
-					break;
-				}
-			}
-		}
-		// Mise a jour du InBodyTargetValueFrequency pour les objects couverts par la regle
-		if (bCovered) // Si l'objet est couvert par la regle
+		assert(oaTargetClassBitmaps.GetSize() == krrInitRule->GetTargetValueNumber());
+		for (nIndex = 0; nIndex < krrInitRule->GetTargetValueNumber(); nIndex++)
+			krrInitRule->SetInBodyTargetValueFrequencyAt(nIndex,
+				bmBody.GetIntersectionCount(cast(KRCoverageBitmap*, oaTargetClassBitmaps.GetAt(nIndex))));
+		assert(CheckBodyStatistics(krrInitRule));
+	}
+	// regression: les classes dependent de la partition de l'attribut cible de la regle,
+	// et sont obtenues par objet a partir du rang de sa valeur cible
+	else
+	{
+		require(krrInitRule->GetTargetType() == KWType::Continuous);
+		for (nObjectRank = 0; nObjectRank < krocCounters.GetRankNumber(); nObjectRank++)
 		{
-			// Modification des vecteurs de frequences de la regle
+			assert(bmBody.Contains(nObjectRank) == coveragePlan->IsCovered(nObjectRank));
+			nObjectTargetValueIndex = ivTargetRankPartIndexes.GetAt(ivObjectTargetRanks.GetAt(nObjectRank));
+			assert(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrInitRule->GetTargetAttribute()->GetPartNumber());
 
-			// classification supervise
-			if (krrInitRule->GetTargetType() == KWType::Symbol)
-			{
-				liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
-				sObjectTargetValue = kwoTempObject->GetSymbolValueAt(liTargetAttributeIndex);
-				nObjectTargetValueIndex = krrInitRule->ComputeTargetValueIndex(sObjectTargetValue);
-				require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrInitRule->GetTargetValueNumber());
-				krrInitRule->SetInBodyTargetValueFrequencyAt(nObjectTargetValueIndex,
-					krrInitRule->GetInBodyTargetValueFrequencyAt(nObjectTargetValueIndex) + 1);
-			}
-			else // regression
-			{
-				require(krrInitRule->GetTargetType() == KWType::Continuous);
-				/*krrInitRule->UpdateTargetVectorsFrequency();
-				ensure(krrInitRule->IsTargetVectorSizeValid());*/
-				liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
-				cObjectTargetValue = kwoTempObject->GetContinuousValueAt(liTargetAttributeIndex);
-				nObjectTargetValueIndex = krrInitRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-				require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrInitRule->GetTargetAttribute()->GetPartNumber());
+			// Mise a jour du InBodyTargetValueFrequency pour les objects couverts par la regle
+			if (bmBody.Contains(nObjectRank))
 				krrInitRule->SetInBodyTargetValueFrequencyAt(nObjectTargetValueIndex,
 					krrInitRule->GetInBodyTargetValueFrequencyAt(nObjectTargetValueIndex) + 1);
-			}
-		}
 
-		// Mise a jour du TargetValueFrequency pour tous les objets
-		if (krrInitRule->GetTargetType() == KWType::Continuous)
-		{
-			liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
-			cObjectTargetValue = kwoTempObject->GetContinuousValueAt(liTargetAttributeIndex);
-			nObjectTargetValueIndex = krrInitRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-			require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrInitRule->GetTargetAttribute()->GetPartNumber());
+			// Mise a jour du TargetValueFrequency pour tous les objets
 			krrInitRule->SetTargetValueFrequencyAt(nObjectTargetValueIndex,
 				krrInitRule->GetTargetValueFrequencyAt(nObjectTargetValueIndex) + 1);
 		}
@@ -976,101 +1534,119 @@ void KRRuleOptimizer::UpdateAllStatistics(KWDatabase* database, KRRule* krrInitR
 	//ruleCosts->ComputeRuleTotalCost(krrInitRule);
 	ruleCosts->ComputeRuleCompressionCoefficient(krrInitRule);
 	assert(krrInitRule->CheckAllCosts(GetRuleCosts()));
-	//krrInitRule->SetLevel(ComputeRuleLevel(database, krrInitRule));
-}
-
-void KRRuleOptimizer::UpdateBodyStatistics(KWDatabase* database, KRRule* krrInitRule, IntVector* ivTargetValuesFrequencyDiff)
-{
-	//int nIndex;
-	//int nInformativeAttributeNumber;
-
-	//require(ivTargetValuesFrequencyDiff != NULL);
-	//require(ivTargetValuesFrequencyDiff->GetSize() == krrInitRule->GetTargetValueNumber()
-	//	or (krrInitRule->GetTargetAttribute() != NULL
-	//	and ivTargetValuesFrequencyDiff->GetSize() == krrInitRule->GetTargetAttribute()->GetPartNumber()));
-
-	//// intuitivement, ce qui est rajoute au corps N_X est enlevede l'exterieur du corps N_nonX
-	//
-
-	////// calcul de la somme des objets supplementaires dans le corps
-	////nInBodyDiffSum = 0;
-	////for (nIndex = 0; nIndex < ivTargetValuesFrequencyDiff->GetSize(); nIndex++)
-	////{
-	////	require(ivTargetValuesFrequencyDiff->GetAt(nIndex) >= 0);
-	////	nInBodyDiffSum += ivTargetValuesFrequencyDiff->GetAt(nIndex);
-	////}
-	////
-	////// calcul du differentiel de cout
-	////// en quatre partie N_X, N_nonX, N_Xcj et N_nonXcj
-	////dDiffBodyCost = 0;
-	////dDiffOutBodyCost = 0;
-	////
-	////// partie du corps : ajout de log de N_X + J  N_X + J + nInBodySum
-	////for (nIndex = krrInitRule->GetInBodyTotalFrequency() + krrInitRule->GetTargetValueNumber();
-	////	nIndex <= krrInitRule->GetInBodyTotalFrequency() + krrInitRule->GetTargetValueNumber() + nInBodyDiffSum - 1;
-	////	nIndex++)
-	////{
-	////	dDiffBodyCost += log(nIndex * 1.0);
-	////}
-
-	////// et hors du corps : soustraction de log de N_nonX + J  N_X + J + nInBodySum
-	////nOutBodyFrequency = krrInitRule->GetTotalFrequency() - krrInitRule->GetInBodyTotalFrequency();
-	////for (nIndex = nOutBodyFrequency + krrInitRule->GetTargetValueNumber() - 1;
-	////	nIndex >= nOutBodyFrequency + krrInitRule->GetTargetValueNumber() - nInBodyDiffSum;
-	////	nIndex--)
-	////{
-	////	dDiffOutBodyCost -= log(nIndex * 1.0);
-	////}
-	////// distribution des classes
-	////for (nIndex = 0; nIndex < ivTargetValuesFrequencyDiff->GetSize(); nIndex++)
-	////{
-	////	// in body
-	////	for (nCpt = krrInitRule->GetInBodyTargetValueFrequencyAt(nIndex) + 1;
-	////		nCpt <= krrInitRule->GetInBodyTargetValueFrequencyAt(nIndex) + ivTargetValuesFrequencyDiff->GetAt(nIndex);
-	////		nCpt++)
-	////	{
-	////		dDiffBodyCost -= log(nCpt * 1.0);
-	////	}
-	////
-	////	// out body
-	////	nOutBodyTargetValueFrequency = krrInitRule->GetTargetValueFrequencyAt(nIndex) - krrInitRule->GetInBodyTargetValueFrequencyAt(nIndex);
-	////	for (nCpt = nOutBodyTargetValueFrequency;
-	////		nCpt >= nOutBodyTargetValueFrequency - ivTargetValuesFrequencyDiff->GetAt(nIndex);
-	////		nCpt--)
-	////	{
-	////		dDiffOutBodyCost += log(nCpt * 1.0);
-	////	}
-	////}
-	////
-	////// MAJ a jour des couts de la regle
-	////krrInitRule->SetBodyCost(krrInitRule->GetBodyCost() + dDiffBodyCost);
-	////krrInitRule->SetOutBodyCost(krrInitRule->GetOutBodyCost() + dDiffOutBodyCost);
-
-	//// Modification des vecteurs de frequence de la regle
-	//for (nIndex = 0; nIndex < ivTargetValuesFrequencyDiff->GetSize(); nIndex++)
-	//{
-	//	//cout << krrInitRule->GetInBodyTargetValueFrequencyAt(nIndex) << " : " << ivTargetValuesFrequencyDiff->GetAt(nIndex) << endl;
-	//	assert(krrInitRule->GetInBodyTargetValueFrequencyAt(nIndex) >= 0);
-	//	krrInitRule->SetInBodyTargetValueFrequencyAt(nIndex,
-	//			krrInitRule->GetInBodyTargetValueFrequencyAt(nIndex) + ivTargetValuesFrequencyDiff->GetAt(nIndex));
-	//	assert(krrInitRule->GetInBodyTargetValueFrequencyAt(nIndex) >= 0);
-	//}
-	//
-	//nInformativeAttributeNumber = krrInitRule->ComputeInformativeAttributeNumber();
-	//// recalcul de tous les cous locaux pour le moment
-	//krrInitRule->InitializeAllCosts(GetRuleCosts());
-	////ruleCosts->ComputeRuleTotalCost(krrInitRule);
-	//ruleCosts->ComputeRuleCompressionCoefficient(krrInitRule);
-	//assert(krrInitRule->CheckAllCosts(GetRuleCosts()));
+	//krrInitRule->SetLevel(ComputeRuleLevel(krrInitRule));
+}
+
+void KRRuleOptimizer::UpdateBodyStatistics(KRRule* krrInitRule, IntVector* ivTargetValuesFrequencyDiff)
+{
+	int nIndex;
+
+	require(ivTargetValuesFrequencyDiff != NULL);
+
+	// En regression, les effectifs par classe dependent de la partition de l'attribut cible,
+	// qui peut etre celui en cours d'optimisation: mise a jour complete dans ce cas
+	if (krrInitRule->GetTargetType() == KWType::Continuous)
+	{
+		UpdateAllStatistics(krrInitRule);
+		return;
+	}
+	require(ivTargetValuesFrequencyDiff->GetSize() == krrInitRule->GetTargetValueNumber());
+
+	// Modification des vecteurs de frequence du corps de la regle
+	// Intuitivement, ce qui est rajoute au corps N_X est enleve de l'exterieur du corps N_nonX
+	for (nIndex = 0; nIndex < ivTargetValuesFrequencyDiff->GetSize(); nIndex++)
+	{
+		krrInitRule->SetInBodyTargetValueFrequencyAt(nIndex,
+			krrInitRule->GetInBodyTargetValueFrequencyAt(nIndex) + ivTargetValuesFrequencyDiff->GetAt(nIndex));
+		assert(krrInitRule->GetInBodyTargetValueFrequencyAt(nIndex) >= 0);
+		assert(krrInitRule->GetInBodyTargetValueFrequencyAt(nIndex) <= krrInitRule->GetTargetValueFrequencyAt(nIndex));
+	}
+
+	// Seuls les couts du corps et de l'exterieur dependent des effectifs, en O(J)
+	krrInitRule->SetBodyCost(GetRuleCosts()->ComputeBodyCost(krrInitRule));
+	krrInitRule->SetOutBodyCost(GetRuleCosts()->ComputeOutBodyCost(krrInitRule));
+	ruleCosts->ComputeRuleCompressionCoefficient(krrInitRule);
 
-	//DDD
-	// UpdateAllStatistics pour le moment car bug
-	// lors de l'optimisation de l'attribut cible
-	// et de la mise a jour des statistiques li a cette optimisation
-	UpdateAllStatistics(database, krrInitRule);
+	// La verification par parcours complet de la base (cf. CheckBodyStatistics), en O(N), n'est pas effectuee
+	// a chaque borne candidate, mais une seule fois par parcours, pour le corps retenu
 }
 
-void KRRuleOptimizer::UpdateAttributeStatistics(KWDatabase* database, KRRule* krrInitRule, KRRAttribute* attribute)
+void KRRuleOptimizer::UpdateStructureStatistics(KRRule* krrInitRule)
+{
+	// Mise a jour complete en regression, les vecteurs d'effectifs cibles dependant de la structure
+	if (krrInitRule->GetTargetType() == KWType::Continuous)
+	{
+		UpdateAllStatistics(krrInitRule);
+		return;
+	}
+
+	// Recalcul de tous les couts locaux, a effectifs du corps inchanges
+	krrInitRule->ComputeInformativeAttributeNumber();
+	krrInitRule->InitializeAllCosts(GetRuleCosts());
+	ruleCosts->ComputeRuleCompressionCoefficient(krrInitRule);
+	assert(krrInitRule->CheckAllCosts(GetRuleCosts()));
+	assert(bSampleSweep or CheckBodyStatistics(krrInitRule));
+}
+
+boolean KRRuleOptimizer::CheckBodyStatistics(KRRule* krrInitRule)
+{
+	boolean bOk = true;
+	int nObjectRank;
+	int nIndex;
+	IntVector ivInBodyFrequencies;
+	KRRuleCoveragePlan* coveragePlan;
+	ALString sTmp;
+
+	require(krrInitRule != NULL);
+	require(krrInitRule->GetTargetType() == KWType::Symbol);
+
+	// Calcul des effectifs par classe du corps par parcours complet de la base
+	coveragePlan = GetRuleCoveragePlan(krrInitRule);
+	ivInBodyFrequencies.SetSize(krrInitRule->GetTargetValueNumber());
+	for (nObjectRank = 0; nObjectRank < krocCounters.GetRankNumber(); nObjectRank++)
+	{
+		if (coveragePlan->IsCovered(nObjectRank))
+			ivInBodyFrequencies.UpgradeAt(ComputeObjectTargetIndex(nObjectRank, krrInitRule), 1);
+	}
+
+	// Comparaison avec les effectifs de la regle
+	for (nIndex = 0; nIndex < ivInBodyFrequencies.GetSize(); nIndex++)
+	{
+		if (ivInBodyFrequencies.GetAt(nIndex) != krrInitRule->GetInBodyTargetValueFrequencyAt(nIndex))
+		{
+			krrInitRule->AddError(sTmp + "In-body frequency of target value " + IntToString(nIndex) + " (" +
+				IntToString(krrInitRule->GetInBodyTargetValueFrequencyAt(nIndex)) + ") differs from the database (" +
+				IntToString(ivInBodyFrequencies.GetAt(nIndex)) + ")");
+			bOk = false;
+			break;
+		}
+	}
+	return bOk;
+}
+
+int KRRuleOptimizer::ComputeObjectTargetIndex(int nObjectRank, KRRule* rule) const
+{
+	int nObjectTargetValueIndex;
+
+	require(0 <= nObjectRank and nObjectRank < krocCounters.GetRankNumber());
+	require(rule != NULL);
+
+	// classification supervisee: code precalcule lors du pretraitement
+	if (rule->GetTargetType() == KWType::Symbol)
+	{
+		nObjectTargetValueIndex = ivObjectTargetCodes.GetAt(nObjectRank);
+		ensure(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < rule->GetTargetValueNumber());
+	}
+	// regression: valeur cible obtenue a partir de son rang precalcule
+	else
+	{
+		nObjectTargetValueIndex = rule->ComputeContinuousTargetValuePartIndex(cvTargetValues.GetAt(ivObjectTargetRanks.GetAt(nObjectRank)));
+		ensure(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < rule->GetTargetAttribute()->GetPartNumber());
+	}
+	return nObjectTargetValueIndex;
+}
+
+void KRRuleOptimizer::UpdateAttributeStatistics(KRRule* krrInitRule, KRRAttribute* attribute)
 {
 	// pour le passage de 3 a 2 parties
 	// numerique
@@ -1088,7 +1664,7 @@ void KRRuleOptimizer::UpdateAttributeStatistics(KWDatabase* database, KRRule* kr
 	//assert(krrInitRule->CheckAllCosts(GetRuleCosts()));
 }
 
-void KRRuleOptimizer::UpdateRuleStatistics(KWDatabase* database, KRRule* krrInitRule)
+void KRRuleOptimizer::UpdateRuleStatistics(KRRule* krrInitRule)
 {
 	double dRuleCost;
 
@@ -1099,7 +1675,7 @@ void KRRuleOptimizer::UpdateRuleStatistics(KWDatabase* database, KRRule* krrInit
 	assert(krrInitRule->CheckAllCosts(GetRuleCosts()));
 }
 
-double KRRuleOptimizer::ComputeRuleLevel(KWDatabase* database, KRRule* krrInitRule)
+double KRRuleOptimizer::ComputeRuleLevel(KRRule* krrInitRule)
 {
 	KRRuleCosts rCosts;
 	double dRuleCost;
@@ -1112,362 +1688,270 @@ double KRRuleOptimizer::ComputeRuleLevel(KWDatabase* database, KRRule* krrInitRu
 	return 1 - (dRuleCost / dNullRuleCost);
 }
 
-boolean KRRuleOptimizer::IsInBody(KWObject* kwoOject, KRRule* rule)
+KRRuleCoveragePlan* KRRuleOptimizer::GetRuleCoveragePlan(const KRRule* rule)
 {
-	boolean bOk;
-	int nIndex;
-	KWLoadIndex liAttributeLoadIndex;
-	KRRAttribute* attribute;
+	require(rule != NULL);
 
-	bOk = true;
-	for (nIndex = 0; nIndex < rule->GetAttributeNumber(); nIndex++)
-	{
-		attribute = rule->GetAttributeAt(nIndex);
-		//require(KWType::IsSimple(attribute->GetAttributeType()));
-		liAttributeLoadIndex = GetClassStats()->GetClass()->LookupAttribute(attribute->GetAttributeName())->GetLoadIndex();
-		// attribut numerique
-		if (attribute->GetAttributeTargetFunction())
-			continue;
-		if (attribute->GetAttributeType() == KWType::Continuous and
-			not attribute->IsInBodyContinuous(kwoOject->GetContinuousValueAt(liAttributeLoadIndex)))
-		{
-			//cout << "Attribute failed : " << attribute->GetAttributeName() << endl;
-			bOk = false;
-			break;
-		}
-		//attribut symbolique
-		if (attribute->GetAttributeType() == KWType::Symbol and
-			not attribute->IsInBodySymbol(kwoOject->GetSymbolValueAt(liAttributeLoadIndex)))
-		{
-			bOk = false;
-			break;
-		}
-	}
-	return bOk;
+	rulePlan.Synchronize(rule, GetClassStats()->GetClass(), &odPreprocessedAttributes);
+	return &rulePlan;
 }
 
-double KRRuleOptimizer::OptimizeRuleAttribute(KWDatabase* database,
-	KRRAttribute* krrAttribute,
-	KWObject* kwoInBody,
-	KRRule* krrCurrentRule)
+boolean KRRuleOptimizer::IsInBody(int nObjectRank, KRRule* rule)
+{
+	require(0 <= nObjectRank and nObjectRank < krocCounters.GetRankNumber());
+	require(rule != NULL);
+
+	return GetRuleCoveragePlan(rule)->IsCovered(nObjectRank);
+}
+
+double KRRuleOptimizer::OptimizeRuleAttribute(KRRAttribute* krrAttribute,
+	int nInBodyObjectRank,
+	KRRule* krrCurrentRule,
+	const IntVector* ivAllWorkingInstances)
 {
 	require(KWType::IsSimple(krrAttribute->GetAttributeType()));
 
 	if (krrAttribute->GetAttributeType() == KWType::Continuous)
 	{
 		//cout << "Optimizing Attribute : " << krrAttribute->GetAttributeName() << endl;
-		return OptimizeContinuousAttribute(database, krrAttribute, kwoInBody, krrCurrentRule);
+		return OptimizeContinuousAttribute(krrAttribute, nInBodyObjectRank, krrCurrentRule, ivAllWorkingInstances);
 	}
 	else
 	{
 		assert(krrAttribute->GetAttributeType() == KWType::Symbol);
 		//cout << "Optimizing Attribute : " << krrAttribute->GetAttributeName() << endl;
-		return OptimizeSymbolAttribute(database, krrAttribute, kwoInBody, krrCurrentRule);
+		return OptimizeSymbolAttribute(krrAttribute, nInBodyObjectRank, krrCurrentRule);
 	}
 }
 
-double KRRuleOptimizer::OptimizeContinuousAttribute(KWDatabase* database,
-	KRRAttribute* krrAttribute,
-	KWObject* kwoInBody,
-	KRRule* krrCurrentRule)
+double KRRuleOptimizer::OptimizeContinuousAttribute(KRRAttribute* krrAttribute,
+	int nInBodyObjectRank,
+	KRRule* krrCurrentRule,
+	const IntVector* ivAllWorkingInstances)
 {
-	require(database != NULL);
 	require(krrAttribute != NULL);
-	require(kwoInBody != NULL);
+	require(0 <= nInBodyObjectRank and nInBodyObjectRank < krocCounters.GetRankNumber());
 	require(krrCurrentRule != NULL);
 	require(krrAttribute->GetPartNumber() == 2 or krrAttribute->GetPartNumber() == 3);
 
+	// Optimisation sur l'echantillon si disponible: les effectifs du corps sont alors estimes pendant
+	// le parcours des bornes, puis recalcules sur toutes les instances pour la borne retenue
+	bSampleSweep = IsSampleOptimizationUsed(krrCurrentRule);
+
 	// Si deux parties
 	if (krrAttribute->GetPartNumber() == 2)
 	{
-		Optimize2PartsContinuousAttribute(database, krrAttribute, kwoInBody, krrCurrentRule);
+		Optimize2PartsContinuousAttribute(krrAttribute, nInBodyObjectRank, krrCurrentRule, ivAllWorkingInstances);
 		//cout << "attribute optim ok?\n";
 	}
 
 	// Si trois parties
 	if (krrAttribute->GetPartNumber() == 3)
 	{
-		Optimize3PartsContinuousAttribute(database, krrAttribute, kwoInBody, krrCurrentRule);
+		Optimize3PartsContinuousAttribute(krrAttribute, nInBodyObjectRank, krrCurrentRule, ivAllWorkingInstances);
 	}
+	bSampleSweep = false;
 	return krrCurrentRule->GetLevel();
 }
 
-void KRRuleOptimizer::Optimize2PartsContinuousAttribute(KWDatabase* database,
-	KRRAttribute* krrAttribute,
-	KWObject* kwoInBody,
-	KRRule* krrCurrentRule)
+void KRRuleOptimizer::Optimize2PartsContinuousAttribute(KRRAttribute* krrAttribute,
+	int nInBodyObjectRank,
+	KRRule* krrCurrentRule,
+	const IntVector* ivAllWorkingInstances)
 {
-	KWLoadIndex liAttributeLoadIndex;
 	Continuous cValue;
 	Continuous cPrecValue;
-	Continuous cInBodyObjectValue;
 	int nObjectIndex;
-	KWObject* kwoObject;
+	int nIndex;
+	int nTarget;
+	int nObjectRank;
 	double dMaxRuleLevel;
-	int nLowerIndex;
+	boolean bFirstBound;
 	Continuous cLowerBound;
 	Continuous cOptimizedLowerBound;
-	int nUpperIndex;
 	Continuous cUpperBound;
 	Continuous cOptimizedUpperBound;
 	KRPreprocessedContinuousAttribute* krpcaAttribute;
-	ObjectArray* oaWorkingInstances;
+	IntVector ivSampleWorkingInstances;
+	const IntVector* ivWorkingInstances;
 	IntVector ivTargetFrequencyValuesDiff;
-	KWLoadIndex liTargetAttributeIndex;
-	Symbol sObjectTargetValue;
-	Continuous cObjectTargetValue;
-	int nObjectTargetValueIndex;
-
-	require(database != NULL);
-	//kwoInBody->Write(cout);
-	//krrCurrentRule->Write(cout);
-	require(IsInBody(kwoInBody, krrCurrentRule));
-	//require(KWType::IsSimple(krrAttribute->GetAttributeType()));
+	IntVector ivOptimizedInBodyFrequencies;
+	IntVector ivMissingValueFrequencies;
+	IntVector ivSampleFrequencies;
+	IntVector ivSampleMissingValueFrequencies;
+	boolean bInitialWithLowerBound;
+	Continuous cInitialLowerBound;
+	Continuous cInitialUpperBound;
+
+	require(IsInBody(nInBodyObjectRank, krrCurrentRule));
 	require(krrAttribute->GetBodyPartIndex() == 0 or krrAttribute->GetBodyPartIndex() == 1);
+	require(ivAllWorkingInstances != NULL);
+	require(CheckObjectCounters(krrCurrentRule));
 
 	// level de la regle a ameliorer
-	//dMaxRuleLevel = ruleCosts->ComputeRuleCompressionCoefficient(krrCurrentRule);
 	dMaxRuleLevel = krrCurrentRule->GetLevel();
 
-	// Index dans la base de l'attribut a optimiser
-	liAttributeLoadIndex = GetClassStats()->GetClass()->LookupAttribute(krrAttribute->GetAttributeName())->GetLoadIndex();
+	// Corps initial de l'attribut, pour la mise a jour des compteurs d'objets en fin d'optimisation
+	bInitialWithLowerBound = (krrAttribute->GetBodyPartIndex() != 0);
+	cInitialLowerBound = krrAttribute->GetPartAt(krrAttribute->GetBodyPartIndex())->GetInterval()->GetLowerBound();
+	cInitialUpperBound = krrAttribute->GetPartAt(krrAttribute->GetBodyPartIndex())->GetInterval()->GetUpperBound();
 
-	// valeur de l'objet reference dans le corps
-	cInBodyObjectValue = kwoInBody->GetContinuousValueAt(liAttributeLoadIndex);
 
 	// Tri de la base selon l'attribut a optimiser
 	krpcaAttribute = cast(KRPreprocessedContinuousAttribute*, LookUpPreprocessedAttribute(krrAttribute->GetAttributeName()));
 
-	krocCounters.ResetCounters();
-	InitializeObjectsCounters(database, krrCurrentRule);
-	ensure(CheckObjectCounters(database, krrCurrentRule));
-	//cout << krocCounters;
-
-	oaWorkingInstances = new ObjectArray;
-	krpcaAttribute->PrepareWorkingInstances(krrAttribute, krrCurrentRule, &krocCounters, oaWorkingInstances);
+	// Instances couvertes par toutes les autres conditions de la regle, par index dans l'ordre trie selon l'attribut,
+	// restreintes a l'echantillon et a l'objet de reference le cas echeant
+	if (bSampleSweep)
+	{
+		krpcaAttribute->PrepareSampleWorkingInstances(krrAttribute, krrCurrentRule, &krocCounters, nInBodyObjectRank, &ivSampleWorkingInstances);
+		ivWorkingInstances = &ivSampleWorkingInstances;
+	}
+	else
+		ivWorkingInstances = ivAllWorkingInstances;
 
-	for (nObjectIndex = 0; nObjectIndex < oaWorkingInstances->GetSize(); nObjectIndex++)
+	// Recherche de l'objet de reference par son rang
+	for (nObjectIndex = 0; nObjectIndex < ivWorkingInstances->GetSize(); nObjectIndex++)
 	{
-		kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nObjectIndex));
-		if (kwoObject == kwoInBody)
+		if (krpcaAttribute->GetObjectRankAt(ivWorkingInstances->GetAt(nObjectIndex)) == nInBodyObjectRank)
 			break;
 	}
-
-	assert(0 <= nObjectIndex and nObjectIndex < oaWorkingInstances->GetSize());
+	assert(0 <= nObjectIndex and nObjectIndex < ivWorkingInstances->GetSize());
 
 	cOptimizedLowerBound = KWContinuous::GetForbiddenValue();
 	cOptimizedUpperBound = KWContinuous::GetForbiddenValue();
-	kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nObjectIndex));
 
-	//tableau des differentielles de frequences par classe
+	// Tableau des differentielles de frequences par classe
+	// Le corps est reconstruit a partir d'un corps vide: les instances de travail y entrent
+	// au fur et a mesure du deplacement de la borne, chaque borne candidate etant evaluee en O(J)
 	if (krrCurrentRule->GetTargetType() == KWType::Symbol)
 		ivTargetFrequencyValuesDiff.SetSize(krrCurrentRule->GetTargetValueNumber());
-	if (krrCurrentRule->GetTargetType() == KWType::Continuous)
+	else
 		ivTargetFrequencyValuesDiff.SetSize(krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-	ivTargetFrequencyValuesDiff.Initialize();
+	ivOptimizedInBodyFrequencies.SetSize(ivTargetFrequencyValuesDiff.GetSize());
+	ivMissingValueFrequencies.SetSize(ivTargetFrequencyValuesDiff.GetSize());
+	ivMissingValueFrequencies.Initialize();
+	ivSampleFrequencies.SetSize(ivTargetFrequencyValuesDiff.GetSize());
+	ivSampleFrequencies.Initialize();
+	ivSampleMissingValueFrequencies.SetSize(ivTargetFrequencyValuesDiff.GetSize());
+	ivSampleMissingValueFrequencies.Initialize();
+	for (nTarget = 0; nTarget < ivTargetFrequencyValuesDiff.GetSize(); nTarget++)
+	{
+		ivTargetFrequencyValuesDiff.SetAt(nTarget, -krrCurrentRule->GetInBodyTargetValueFrequencyAt(nTarget));
+		ivOptimizedInBodyFrequencies.SetAt(nTarget, krrCurrentRule->GetInBodyTargetValueFrequencyAt(nTarget));
+	}
 
-	// la parite 0 est active dans le corps
+	// la partie 0 est active dans le corps: parcours des valeurs croissantes
 	if (krrAttribute->GetBodyPartIndex() == 0)
 	{
-		nUpperIndex = nObjectIndex;
-		cPrecValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
 		cOptimizedUpperBound = krrAttribute->GetPartAt(0)->GetInterval()->GetUpperBound();
-
-		// Positionnement au point de depart de l'optimisation d'une borne juste a cote de l'objet
-		while (nUpperIndex < oaWorkingInstances->GetSize())
-		{
-			kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nUpperIndex));
-			cValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
-			if (cValue > cPrecValue)
-			{
-				cUpperBound = KWContinuous::GetLowerMeanValue(cValue, cPrecValue);
-				krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cUpperBound);
-				krrAttribute->GetPartAt(1)->GetInterval()->SetLowerBound(cUpperBound);
-				UpdateAllStatistics(database, krrCurrentRule);
-				cPrecValue = cValue;
-				break;
-			}
-			nUpperIndex++;
-		}
-
-		while (nUpperIndex < oaWorkingInstances->GetSize())
+		bFirstBound = true;
+		cPrecValue = KWContinuous::GetMissingValue();
+		for (nIndex = 0; nIndex < ivWorkingInstances->GetSize(); nIndex++)
 		{
-			//kwoObject = cast(KWObject*, krpcaAttribute->GetObjects()->GetAt(nUpperIndex));
-			kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nUpperIndex));
-			cValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
+			nObjectRank = krpcaAttribute->GetObjectRankAt(ivWorkingInstances->GetAt(nIndex));
+			cValue = krpcaAttribute->GetValueAt(ivWorkingInstances->GetAt(nIndex));
 
-			// MAJ de ivTargetFrequencyValuesDiff
-			if (cValue == cPrecValue)
-			{
-				liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
-				if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-				{
-					sObjectTargetValue = kwoObject->GetSymbolValueAt(liTargetAttributeIndex);
-					nObjectTargetValueIndex = krrCurrentRule->ComputeTargetValueIndex(sObjectTargetValue);
-					require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetValueNumber());
-					ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-				}
-				if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-				{
-					cObjectTargetValue = kwoObject->GetContinuousValueAt(liTargetAttributeIndex);
-					nObjectTargetValueIndex = krrCurrentRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-					require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-					ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-				}
-			}
-			if (cValue > cPrecValue)
+			// Borne candidate entre deux valeurs distinctes, au dela de l'objet de reference
+			// La premiere borne est toujours evaluee, les suivantes uniquement entre deux intervalles candidats
+			if (nIndex > nObjectIndex and cValue > cPrecValue and
+			    (bFirstBound or krpcaAttribute->IsCandidateBoundBetween(ivWorkingInstances->GetAt(nIndex - 1), ivWorkingInstances->GetAt(nIndex))))
 			{
 				cUpperBound = KWContinuous::GetLowerMeanValue(cValue, cPrecValue);
 				krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cUpperBound);
 				krrAttribute->GetPartAt(1)->GetInterval()->SetLowerBound(cUpperBound);
-				UpdateAllStatistics(database, krrCurrentRule);
-				//DDD UpdateSubStatistics(oaWorkingInstances, krrCurrentRule);
-				//DDD UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-				if (krrCurrentRule->GetLevel() > dMaxRuleLevel)
+				UpdateBodyStatistics(krrCurrentRule, &ivTargetFrequencyValuesDiff);
+				ivTargetFrequencyValuesDiff.Initialize();
+
+				// La premiere borne sert uniquement de point de depart de l'optimisation
+				if (not bFirstBound and krrCurrentRule->GetLevel() > dMaxRuleLevel)
 				{
 					dMaxRuleLevel = krrCurrentRule->GetLevel();
 					cOptimizedUpperBound = cUpperBound;
-					//krrCurrentRule->Write(cout);
+					for (nTarget = 0; nTarget < ivOptimizedInBodyFrequencies.GetSize(); nTarget++)
+						ivOptimizedInBodyFrequencies.SetAt(nTarget, krrCurrentRule->GetInBodyTargetValueFrequencyAt(nTarget));
 				}
-				// reinitialisation  du vecteur de difference et prise en compte de l'objet en cours
-				ivTargetFrequencyValuesDiff.Initialize();
-				liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
-				if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-				{
-					sObjectTargetValue = kwoObject->GetSymbolValueAt(liTargetAttributeIndex);
-					nObjectTargetValueIndex = krrCurrentRule->ComputeTargetValueIndex(sObjectTargetValue);
-					require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetValueNumber());
-					ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-				}
-				if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-				{
-					cObjectTargetValue = kwoObject->GetContinuousValueAt(liTargetAttributeIndex);
-					nObjectTargetValueIndex = krrCurrentRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-					require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-					ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-				}
-
-				cPrecValue = cValue;
+				bFirstBound = false;
 			}
-			nUpperIndex++;
+
+			// Entree de l'objet dans le corps
+			nTarget = ComputeObjectTargetIndex(nObjectRank, krrCurrentRule);
+			ivTargetFrequencyValuesDiff.UpgradeAt(nTarget, ComputeFrequencyIncrement(nTarget, &ivSampleFrequencies));
+			cPrecValue = cValue;
 		}
 
 		// cas borne extreme ~> vers un seul intervalle donc attribut non-informatif
 		cUpperBound = KRRInterval::GetMaxUpperBound();
 		krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cUpperBound);
 		krrAttribute->GetPartAt(1)->GetInterval()->SetLowerBound(cUpperBound);
-		UpdateAllStatistics(database, krrCurrentRule); // calcul fausse par 2 intervalles au lieu de 1.
-		//DDD UpdateSubStatistics(oaWorkingInstances, krrCurrentRule);
-		//DDD UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-		UpdateRuleStatistics(database, krrCurrentRule); // car changement du nb d'attributs informatifs
+		UpdateBodyStatistics(krrCurrentRule, &ivTargetFrequencyValuesDiff); // calcul fausse par 2 intervalles au lieu de 1.
+		UpdateRuleStatistics(krrCurrentRule); // car changement du nb d'attributs informatifs
 		if (krrCurrentRule->GetLevel() >= dMaxRuleLevel)
 		{
 			dMaxRuleLevel = krrCurrentRule->GetLevel();
 			cOptimizedUpperBound = cUpperBound;
-			//krrCurrentRule->Write(cout);
+			for (nTarget = 0; nTarget < ivOptimizedInBodyFrequencies.GetSize(); nTarget++)
+				ivOptimizedInBodyFrequencies.SetAt(nTarget, krrCurrentRule->GetInBodyTargetValueFrequencyAt(nTarget));
 		}
 
 		krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cOptimizedUpperBound);
 		krrAttribute->GetPartAt(1)->GetInterval()->SetLowerBound(cOptimizedUpperBound);
 	}
-	else // alors krrAttribute->GetBodyPartIndex() ==1
+	// la partie 1 est active dans le corps: parcours des valeurs decroissantes
+	else
 	{
-		nLowerIndex = nObjectIndex;
-		cPrecValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
 		cOptimizedLowerBound = krrAttribute->GetPartAt(1)->GetInterval()->GetLowerBound();
-
-		// Positionnement au point de depart de l'optimisation d'une borne juste a cote de l'objet
-		while (nLowerIndex >= 0)
+		bFirstBound = true;
+		cPrecValue = KWContinuous::GetMaxValue();
+		for (nIndex = ivWorkingInstances->GetSize() - 1; nIndex >= 0; nIndex--)
 		{
-			kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nLowerIndex));
-			cValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
-			if (cValue < cPrecValue)
-			{
-				cLowerBound = KWContinuous::GetLowerMeanValue(cValue, cPrecValue);
-				krrAttribute->GetPartAt(1)->GetInterval()->SetLowerBound(cLowerBound);
-				krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cLowerBound);
-				//UpdateSubStatistics(oaWorkingInstances, krrCurrentRule);
-				UpdateAllStatistics(database, krrCurrentRule);
-				cPrecValue = cValue;
-				break;
-			}
-			nLowerIndex--;
-		}
-		while (nLowerIndex >= 0)
-		{
-			kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nLowerIndex));
-			cValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
-
-			// MAJ de ivTargetFrequencyValuesDiff
-			if (cValue == cPrecValue)
-			{
-				liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
-				if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-				{
-					sObjectTargetValue = kwoObject->GetSymbolValueAt(liTargetAttributeIndex);
-					nObjectTargetValueIndex = krrCurrentRule->ComputeTargetValueIndex(sObjectTargetValue);
-					require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetValueNumber());
-					ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-				}
-				if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-				{
-					cObjectTargetValue = kwoObject->GetContinuousValueAt(liTargetAttributeIndex);
-					nObjectTargetValueIndex = krrCurrentRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-					require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-					ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-				}
-			}
+			nObjectRank = krpcaAttribute->GetObjectRankAt(ivWorkingInstances->GetAt(nIndex));
+			cValue = krpcaAttribute->GetValueAt(ivWorkingInstances->GetAt(nIndex));
 
-			if (cValue < cPrecValue)
+			// Borne candidate entre deux valeurs distinctes, en deca de l'objet de reference
+			// La premiere borne est toujours evaluee, les suivantes uniquement entre deux intervalles candidats
+			if (nIndex < nObjectIndex and cValue < cPrecValue and
+			    (bFirstBound or krpcaAttribute->IsCandidateBoundBetween(ivWorkingInstances->GetAt(nIndex), ivWorkingInstances->GetAt(nIndex + 1))))
 			{
 				cLowerBound = KWContinuous::GetLowerMeanValue(cValue, cPrecValue);
 				krrAttribute->GetPartAt(1)->GetInterval()->SetLowerBound(cLowerBound);
 				krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cLowerBound);
-				UpdateAllStatistics(database, krrCurrentRule);
-				//DDD UpdateSubStatistics(oaWorkingInstances, krrCurrentRule);
-				//DDD UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-				if (krrCurrentRule->GetLevel() > dMaxRuleLevel)
+				UpdateBodyStatistics(krrCurrentRule, &ivTargetFrequencyValuesDiff);
+				ivTargetFrequencyValuesDiff.Initialize();
+
+				// La premiere borne sert uniquement de point de depart de l'optimisation
+				if (not bFirstBound and krrCurrentRule->GetLevel() > dMaxRuleLevel)
 				{
 					dMaxRuleLevel = krrCurrentRule->GetLevel();
 					cOptimizedLowerBound = cLowerBound;
-					//krrCurrentRule->Write(cout);
-				}
-				// reinitialisation  du vecteur de difference et prise en compte de l'objet en cours
-				ivTargetFrequencyValuesDiff.Initialize();
-				liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
-				if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-				{
-					sObjectTargetValue = kwoObject->GetSymbolValueAt(liTargetAttributeIndex);
-					nObjectTargetValueIndex = krrCurrentRule->ComputeTargetValueIndex(sObjectTargetValue);
-					require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetValueNumber());
-					ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-				}
-				if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-				{
-					cObjectTargetValue = kwoObject->GetContinuousValueAt(liTargetAttributeIndex);
-					nObjectTargetValueIndex = krrCurrentRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-					require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-					ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
+					for (nTarget = 0; nTarget < ivOptimizedInBodyFrequencies.GetSize(); nTarget++)
+						ivOptimizedInBodyFrequencies.SetAt(nTarget, krrCurrentRule->GetInBodyTargetValueFrequencyAt(nTarget));
 				}
-
-				cPrecValue = cValue;
+				bFirstBound = false;
 			}
-			nLowerIndex--;
+
+			// Entree de l'objet dans le corps
+			// Les valeurs manquantes restent hors de l'intervalle tant qu'il a une borne inf
+			nTarget = ComputeObjectTargetIndex(nObjectRank, krrCurrentRule);
+			if (cValue > KRRInterval::GetMinLowerBound())
+				ivTargetFrequencyValuesDiff.UpgradeAt(nTarget, ComputeFrequencyIncrement(nTarget, &ivSampleFrequencies));
+			else
+				ivMissingValueFrequencies.UpgradeAt(nTarget, ComputeFrequencyIncrement(nTarget, &ivSampleMissingValueFrequencies));
+			cPrecValue = cValue;
 		}
 
 		// cas borne extreme ~> 1 intervalle
 		cLowerBound = KRRInterval::GetMinLowerBound();
 		krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cLowerBound);
 		krrAttribute->GetPartAt(1)->GetInterval()->SetLowerBound(cLowerBound);
-		UpdateAllStatistics(database, krrCurrentRule); // calcul fausse par 2 intervalles au lieu de 1.
-		//DDD UpdateSubStatistics(oaWorkingInstances, krrCurrentRule);
-		//DDD UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-		UpdateRuleStatistics(database, krrCurrentRule); // car changement du nb d'attributs informatifs
+		UpdateBodyStatistics(krrCurrentRule, &ivTargetFrequencyValuesDiff); // calcul fausse par 2 intervalles au lieu de 1.
+		UpdateRuleStatistics(krrCurrentRule); // car changement du nb d'attributs informatifs
 		if (krrCurrentRule->GetLevel() >= dMaxRuleLevel)
 		{
 			dMaxRuleLevel = krrCurrentRule->GetLevel();
 			cOptimizedLowerBound = cLowerBound;
-			//krrCurrentRule->Write(cout);
+			for (nTarget = 0; nTarget < ivOptimizedInBodyFrequencies.GetSize(); nTarget++)
+				ivOptimizedInBodyFrequencies.SetAt(nTarget, krrCurrentRule->GetInBodyTargetValueFrequencyAt(nTarget));
 		}
 
 		krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cOptimizedLowerBound);
@@ -1479,458 +1963,535 @@ void KRRuleOptimizer::Optimize2PartsContinuousAttribute(KWDatabase* database,
 	{
 		krrAttribute->DeletePart(krrAttribute->GetPartAt(0));
 		krrAttribute->SetBodyPartIndex(0);
+
+		// L'intervalle restant couvre alors les valeurs manquantes
+		for (nTarget = 0; nTarget < ivOptimizedInBodyFrequencies.GetSize(); nTarget++)
+			ivOptimizedInBodyFrequencies.UpgradeAt(nTarget, ivMissingValueFrequencies.GetAt(nTarget));
 	}
 	if (cOptimizedUpperBound == KRRInterval::GetMaxUpperBound())
 		krrAttribute->DeletePart(krrAttribute->GetPartAt(1));
 
-	// mise jour sur toute la base obligatoire avec la nouvelle borne ?
-	//DDD
-	//krrCurrentRule->DeleteNonInformativeAttributes();
-	UpdateAllStatistics(database, krrCurrentRule);
-	//UpdateSubStatistics(oaWorkingInstances, krrCurrentRule);
+	// Effectifs du corps correspondant a la borne retenue, recalcules sur toutes les instances s'ils sont estimes
+	if (bSampleSweep)
+		UpdateAllStatistics(krrCurrentRule);
+	else
+	{
+		if (krrCurrentRule->GetTargetType() == KWType::Symbol)
+		{
+			for (nTarget = 0; nTarget < ivOptimizedInBodyFrequencies.GetSize(); nTarget++)
+				krrCurrentRule->SetInBodyTargetValueFrequencyAt(nTarget, ivOptimizedInBodyFrequencies.GetAt(nTarget));
+		}
+
+		// Mise a jour des couts suite a l'eventuel changement du nombre de parties
+		UpdateStructureStatistics(krrCurrentRule);
+	}
 
-	delete oaWorkingInstances;
+	// Mise a jour des compteurs des seuls objets ayant change d'appartenance au corps de l'attribut
+	UpdateContinuousObjectsCounters(krrAttribute, bInitialWithLowerBound, cInitialLowerBound, cInitialUpperBound);
+	ensure(CheckObjectCounters(krrCurrentRule));
 }
 
-void KRRuleOptimizer::Optimize3PartsContinuousAttribute(KWDatabase* database,
-	KRRAttribute* krrAttribute,
-	KWObject* kwoInBody,
-	KRRule* krrCurrentRule)
+void KRRuleOptimizer::Optimize3PartsContinuousAttribute(KRRAttribute* krrAttribute,
+	int nInBodyObjectRank,
+	KRRule* krrCurrentRule,
+	const IntVector* ivAllWorkingInstances)
 {
-	KWLoadIndex liAttributeLoadIndex;
 	Continuous cValue;
-	Continuous cPrecValue;
 	Continuous cInBodyObjectValue;
 	int nObjectIndex;
-	KWObject* kwoObject;
+	int nTarget;
+	int nTargetNumber;
+	int nGroup;
+	int nGroupNumber;
+	int nObjectGroup;
+	int nMinFirstGroup;
+	int nLastGroup;
+	int nOptimizedFirstGroup;
+	int nOptimizedLastGroup;
+	int nObjectRank;
 	double dMaxRuleLevel;
-	int nLowerIndex;
 	Continuous cLowerBound;
 	Continuous cOptimizedLowerBound;
-	int nUpperIndex;
 	Continuous cUpperBound;
 	Continuous cOptimizedUpperBound;
 	KRPreprocessedContinuousAttribute* krpcaAttribute;
-	ObjectArray* oaWorkingInstances;
+	IntVector ivSampleWorkingInstances;
+	const IntVector* ivWorkingInstances;
+	ContinuousVector cvGroupValues;
+	IntVector ivGroupSortedIndexes;
+	IntVector ivCumulatedFrequencies;
 	IntVector ivTargetFrequencyValuesDiff;
-	KWLoadIndex liTargetAttributeIndex;
-	Symbol sObjectTargetValue;
-	Continuous cObjectTargetValue;
-	int nObjectTargetValueIndex;
+	Continuous cInitialLowerBound;
+	Continuous cInitialUpperBound;
 
-	//kwoInBody->Write(cout);
-	//krrCurrentRule->Write(cout);
-	require(IsInBody(kwoInBody, krrCurrentRule));
+	require(IsInBody(nInBodyObjectRank, krrCurrentRule));
+	require(krrAttribute->GetPartNumber() == 3);
+	require(krrAttribute->GetBodyPartIndex() == 1);
+	require(ivAllWorkingInstances != NULL);
+	require(CheckObjectCounters(krrCurrentRule));
 
 	// level de la regle a ameliorer
 	dMaxRuleLevel = krrCurrentRule->GetLevel();
 
-	// Index dans la base de l'attribut a optimiser
-	liAttributeLoadIndex = GetClassStats()->GetClass()->LookupAttribute(krrAttribute->GetAttributeName())->GetLoadIndex();
+	// Corps initial de l'attribut, pour la mise a jour des compteurs d'objets en fin d'optimisation
+	cInitialLowerBound = krrAttribute->GetPartAt(1)->GetInterval()->GetLowerBound();
+	cInitialUpperBound = krrAttribute->GetPartAt(1)->GetInterval()->GetUpperBound();
 
-	// valeur de l'objet reference dans le corps
-	cInBodyObjectValue = kwoInBody->GetContinuousValueAt(liAttributeLoadIndex);
-	assert(krrAttribute->IsInBodyContinuous(cInBodyObjectValue));
 
 	// Tri de la base selon l'attribut a optimiser
 	krpcaAttribute = cast(KRPreprocessedContinuousAttribute*, LookUpPreprocessedAttribute(krrAttribute->GetAttributeName()));
 
-	krocCounters.ResetCounters();
-	//cout << krocCounters;
-	InitializeObjectsCounters(database, krrCurrentRule);
-	assert(krocCounters.GetBodyCountAt(kwoInBody) == krrCurrentRule->GetAttributeNumber());
-	ensure(CheckObjectCounters(database, krrCurrentRule));
-	//cout << krocCounters;
-	oaWorkingInstances = new ObjectArray;
-	krpcaAttribute->PrepareWorkingInstances(krrAttribute, krrCurrentRule, &krocCounters, oaWorkingInstances);
-	assert(CheckObjectCounters(database, krrCurrentRule));
-
-	// Calcul de l'index de l'objet reference dans la nouvelle structure oaWorkingInstances
-	for (nObjectIndex = 0; nObjectIndex < oaWorkingInstances->GetSize(); nObjectIndex++)
-	{
-		kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nObjectIndex));
-		if (kwoObject == kwoInBody)
-			break;
-	}
-	//cout << "oaWorking Instances Size : " << oaWorkingInstances->GetSize() << " ; nObjectIndex : " << nObjectIndex << endl;
-	assert(0 <= nObjectIndex and nObjectIndex < oaWorkingInstances->GetSize());
+	// valeur de l'objet reference dans le corps
+	cInBodyObjectValue = krpcaAttribute->GetValueAtRank(nInBodyObjectRank);
+	assert(krrAttribute->IsInBodyContinuous(cInBodyObjectValue));
+	assert(krocCounters.GetBodyCountAtRank(nInBodyObjectRank) == krrCurrentRule->GetAttributeNumber());
 
-	//krrCurrentRule->Write(cout);
+	// Instances couvertes par toutes les autres conditions de la regle, par index dans l'ordre trie selon l'attribut,
+	// restreintes a l'echantillon et a l'objet de reference le cas echeant
+	// Cet ensemble ne depend pas des bornes de l'attribut optimise: hors echantillon, il est fourni par l'appelant,
+	// qui l'a deja calcule pour le majorant du level de l'attribut
+	if (bSampleSweep)
+	{
+		krpcaAttribute->PrepareSampleWorkingInstances(krrAttribute, krrCurrentRule, &krocCounters, nInBodyObjectRank, &ivSampleWorkingInstances);
+		ivWorkingInstances = &ivSampleWorkingInstances;
+	}
+	else
+		ivWorkingInstances = ivAllWorkingInstances;
 
-	//tableau des differentielles de frequences par classe
+	// Nombre de valeurs cibles (classes ou parties de l'attribut cible en regression)
 	if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-		ivTargetFrequencyValuesDiff.SetSize(krrCurrentRule->GetTargetValueNumber());
-	if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-		ivTargetFrequencyValuesDiff.SetSize(krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-	ivTargetFrequencyValuesDiff.Initialize();
-
-	////////////
-	// recherche de la borne inferieure optimale
-	nLowerIndex = nObjectIndex;
-	kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nObjectIndex));
-	cPrecValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
-	cOptimizedLowerBound = krrAttribute->GetPartAt(1)->GetInterval()->GetLowerBound();
-
-	// Positionnement au point de depart de l'optimisation d'une borne juste a cote de l'objet
-	while (nLowerIndex >= 0)
+		nTargetNumber = krrCurrentRule->GetTargetValueNumber();
+	else
+		nTargetNumber = krrCurrentRule->GetTargetAttribute()->GetPartNumber();
+
+	// Calcul des effectifs cumules par classe pour chaque valeur distincte, en une seule passe
+	// La ligne g+1 de ivCumulatedFrequencies contient les effectifs des valeurs d'index 0 a g,
+	// la ligne 0 etant vide
+	ivCumulatedFrequencies.SetSize(nTargetNumber);
+	ivCumulatedFrequencies.Initialize();
+	nObjectGroup = -1;
+	for (nObjectIndex = 0; nObjectIndex < ivWorkingInstances->GetSize(); nObjectIndex++)
 	{
-		kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nLowerIndex));
-		cValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
-		if (cValue < cPrecValue)
+		nObjectRank = krpcaAttribute->GetObjectRankAt(ivWorkingInstances->GetAt(nObjectIndex));
+		cValue = krpcaAttribute->GetValueAt(ivWorkingInstances->GetAt(nObjectIndex));
+
+		// Nouvelle valeur distincte: ajout d'une ligne initialisee avec les effectifs cumules precedents
+		if (cvGroupValues.GetSize() == 0 or cValue > cvGroupValues.GetAt(cvGroupValues.GetSize() - 1))
 		{
-			cLowerBound = KWContinuous::GetLowerMeanValue(cValue, cPrecValue);
-			krrAttribute->GetPartAt(1)->GetInterval()->SetLowerBound(cLowerBound);
-			krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cLowerBound);
-			//UpdateSubStatistics(oaWorkingInstances, krrCurrentRule);
-			UpdateAllStatistics(database, krrCurrentRule);
-			cPrecValue = cValue;
-			break;
+			cvGroupValues.Add(cValue);
+			ivGroupSortedIndexes.Add(ivWorkingInstances->GetAt(nObjectIndex));
+			for (nTarget = 0; nTarget < nTargetNumber; nTarget++)
+				ivCumulatedFrequencies.Add(ivCumulatedFrequencies.GetAt((cvGroupValues.GetSize() - 1) * nTargetNumber + nTarget));
 		}
-		nLowerIndex--;
+		assert(cValue == cvGroupValues.GetAt(cvGroupValues.GetSize() - 1));
+
+		nTarget = ComputeObjectTargetIndex(nObjectRank, krrCurrentRule);
+		ivCumulatedFrequencies.UpgradeAt(cvGroupValues.GetSize() * nTargetNumber + nTarget, 1);
+		if (nObjectRank == nInBodyObjectRank)
+			nObjectGroup = cvGroupValues.GetSize() - 1;
 	}
+	nGroupNumber = cvGroupValues.GetSize();
+	assert(0 <= nObjectGroup and nObjectGroup < nGroupNumber);
+	assert(cvGroupValues.GetAt(nObjectGroup) == cInBodyObjectValue);
 
-	while (nLowerIndex >= 0)
+	// Sur l'echantillon, effectifs cumules remplaces par leur estimation sur toutes les instances
+	if (bSampleSweep)
 	{
-		kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nLowerIndex));
-		cValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
+		for (nObjectIndex = 0; nObjectIndex < ivCumulatedFrequencies.GetSize(); nObjectIndex++)
+			ivCumulatedFrequencies.SetAt(nObjectIndex,
+				EstimateTargetFrequency(nObjectIndex % nTargetNumber, ivCumulatedFrequencies.GetAt(nObjectIndex)));
+	}
 
-		// MAJ de ivTargetFrequencyValuesDiff
-		if (cValue == cPrecValue)
-		{
-			liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
-			if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-			{
-				sObjectTargetValue = kwoObject->GetSymbolValueAt(liTargetAttributeIndex);
-				nObjectTargetValueIndex = krrCurrentRule->ComputeTargetValueIndex(sObjectTargetValue);
-				require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetValueNumber());
-				ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-			}
-			if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-			{
-				cObjectTargetValue = kwoObject->GetContinuousValueAt(liTargetAttributeIndex);
-				nObjectTargetValueIndex = krrCurrentRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-				require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-				ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-			}
-		}
+	// Premiere valeur non manquante, seule susceptible d'etre dans un intervalle ayant une borne inf
+	nMinFirstGroup = 0;
+	if (cvGroupValues.GetAt(0) <= KRRInterval::GetMinLowerBound())
+		nMinFirstGroup = 1;
 
-		if (cValue < cPrecValue)
-		{
-			cLowerBound = KWContinuous::GetLowerMeanValue(cValue, cPrecValue);
-			krrAttribute->GetPartAt(1)->GetInterval()->SetLowerBound(cLowerBound);
-			krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cLowerBound);
-			UpdateAllStatistics(database, krrCurrentRule);
-			//DDD UpdateSubStatistics(oaWorkingInstances, krrCurrentRule);
-			//DDD UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-			if (krrCurrentRule->GetLevel() > dMaxRuleLevel)
-			{
-				dMaxRuleLevel = krrCurrentRule->GetLevel();
-				cOptimizedLowerBound = cLowerBound;
-				//krrCurrentRule->Write(cout);
-			}
-			// reinitialisation  du vecteur de difference et prise en compte de l'objet en cours
-			ivTargetFrequencyValuesDiff.Initialize();
-			liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
-			if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-			{
-				sObjectTargetValue = kwoObject->GetSymbolValueAt(liTargetAttributeIndex);
-				nObjectTargetValueIndex = krrCurrentRule->ComputeTargetValueIndex(sObjectTargetValue);
-				require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetValueNumber());
-				ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-			}
-			if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-			{
-				cObjectTargetValue = kwoObject->GetContinuousValueAt(liTargetAttributeIndex);
-				nObjectTargetValueIndex = krrCurrentRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-				require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-				ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-			}
+	// Derniere valeur couverte par la borne superieure courante
+	nLastGroup = nGroupNumber - 1;
+	while (cvGroupValues.GetAt(nLastGroup) > krrAttribute->GetPartAt(1)->GetInterval()->GetUpperBound())
+		nLastGroup--;
+	assert(nObjectGroup <= nLastGroup);
 
-			cPrecValue = cValue;
+	// Tableau des differentielles de frequences par classe
+	ivTargetFrequencyValuesDiff.SetSize(nTargetNumber);
+
+	////////////
+	// recherche de la borne inferieure optimale, a borne superieure fixee
+	cOptimizedLowerBound = krrAttribute->GetPartAt(1)->GetInterval()->GetLowerBound();
+	nOptimizedFirstGroup = nObjectGroup;
+	while (nOptimizedFirstGroup > 0 and cvGroupValues.GetAt(nOptimizedFirstGroup - 1) > cOptimizedLowerBound)
+		nOptimizedFirstGroup--;
+	for (nGroup = nObjectGroup - 1; nGroup >= 0; nGroup--)
+	{
+		// Hormis la premiere, bornes evaluees uniquement entre deux intervalles candidats
+		if (nGroup < nObjectGroup - 1 and
+		    not krpcaAttribute->IsCandidateBoundBetween(ivGroupSortedIndexes.GetAt(nGroup), ivGroupSortedIndexes.GetAt(nGroup + 1)))
+			continue;
+
+		cLowerBound = KWContinuous::GetLowerMeanValue(cvGroupValues.GetAt(nGroup), cvGroupValues.GetAt(nGroup + 1));
+		krrAttribute->GetPartAt(1)->GetInterval()->SetLowerBound(cLowerBound);
+		krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cLowerBound);
+		ComputeGroupRangeFrequencyDiff(krrCurrentRule, &ivCumulatedFrequencies, nGroup + 1, nLastGroup, &ivTargetFrequencyValuesDiff);
+		UpdateBodyStatistics(krrCurrentRule, &ivTargetFrequencyValuesDiff);
+
+		// La premiere borne, juste a cote de l'objet, sert uniquement de point de depart de l'optimisation
+		if (nGroup < nObjectGroup - 1 and krrCurrentRule->GetLevel() > dMaxRuleLevel)
+		{
+			dMaxRuleLevel = krrCurrentRule->GetLevel();
+			cOptimizedLowerBound = cLowerBound;
+			nOptimizedFirstGroup = nGroup + 1;
 		}
-		nLowerIndex--;
 	}
+
 	// cas borne extreme ~> 2 intervalles dont 1 apres l'objet
 	cLowerBound = KRRInterval::GetMinLowerBound();
 	krrAttribute->GetPartAt(1)->GetInterval()->SetLowerBound(cLowerBound);
 	krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cLowerBound);
-	UpdateAllStatistics(database, krrCurrentRule); // calcul fausse par 3 intervalles au lieu de 2.
-	//DDD UpdateSubStatistics(oaWorkingInstances, krrCurrentRule);
-	//DDD UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-	UpdateAttributeStatistics(database, krrCurrentRule, krrAttribute);
+	ComputeGroupRangeFrequencyDiff(krrCurrentRule, &ivCumulatedFrequencies, nMinFirstGroup, nLastGroup, &ivTargetFrequencyValuesDiff);
+	UpdateBodyStatistics(krrCurrentRule, &ivTargetFrequencyValuesDiff); // calcul fausse par 3 intervalles au lieu de 2.
+	UpdateAttributeStatistics(krrCurrentRule, krrAttribute);
 	if (krrCurrentRule->GetLevel() >= dMaxRuleLevel)
 	{
 		dMaxRuleLevel = krrCurrentRule->GetLevel();
 		cOptimizedLowerBound = cLowerBound;
-		//krrCurrentRule->Write(cout);
+
+		// Apres suppression de la partie 0, l'intervalle restant couvre les valeurs manquantes
+		nOptimizedFirstGroup = 0;
 	}
 
 	krrAttribute->GetPartAt(1)->GetInterval()->SetLowerBound(cOptimizedLowerBound);
 	krrAttribute->GetPartAt(0)->GetInterval()->SetUpperBound(cOptimizedLowerBound);
-
 	if (cOptimizedLowerBound == KRRInterval::GetMinLowerBound())
 	{
 		krrAttribute->DeletePart(krrAttribute->GetPartAt(0));
 		krrAttribute->SetBodyPartIndex(0);
-		//cout << "extreme lower bound set \n";
 	}
 
-	UpdateAllStatistics(database, krrCurrentRule);
-
-	require(IsInBody(kwoInBody, krrCurrentRule));
-	//krrCurrentRule->Write(cout);
-
-	if (krrAttribute->GetPartNumber() == 2)
-	{
-		delete oaWorkingInstances;
-		Optimize2PartsContinuousAttribute(database, krrAttribute, kwoInBody, krrCurrentRule);
-	}
+	// Effectifs du corps correspondant a la borne retenue, recalcules sur toutes les instances s'ils sont estimes
+	if (bSampleSweep)
+		UpdateAllStatistics(krrCurrentRule);
 	else
 	{
-
-		///////////
-		//Re initalisation avant d'optimiser l'autre borne
-		krocCounters.ResetCounters();
-		//cout << krocCounters << endl;
-		InitializeObjectsCounters(database, krrCurrentRule);
-		ensure(CheckObjectCounters(database, krrCurrentRule));
-		//cout << krocCounters << endl;
-		oaWorkingInstances->SetSize(0);
-		delete oaWorkingInstances;
-		//oaWorkingInstances = NULL;
-		oaWorkingInstances = new ObjectArray;
-		krpcaAttribute->PrepareWorkingInstances(krrAttribute, krrCurrentRule, &krocCounters, oaWorkingInstances);
-		assert(CheckObjectCounters(database, krrCurrentRule));
-		// recherche de l'index de l'object dans la nouvelle structure
-		for (nObjectIndex = 0; nObjectIndex < oaWorkingInstances->GetSize(); nObjectIndex++)
-		{
-			kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nObjectIndex));
-			if (kwoObject == kwoInBody)
-				break;
-		}
-		//cout << "oaWorking Instances Size : " << oaWorkingInstances->GetSize() << " ; nObjectIndex : " << nObjectIndex << endl;
-		assert(0 <= nObjectIndex and nObjectIndex < oaWorkingInstances->GetSize());
-		//tableau des differentielles de frequences par classe
-		ivTargetFrequencyValuesDiff.Initialize();
-
-		////////
-		// recherche de la borne superieure optimale
-		nUpperIndex = nObjectIndex;
-		kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nObjectIndex));
-		cPrecValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
-		cOptimizedUpperBound = krrAttribute->GetPartAt(1)->GetInterval()->GetUpperBound();
-
-		// Positionnement au point de depart de l'optimisation d'une borne juste a cote de l'objet
-		while (nUpperIndex < oaWorkingInstances->GetSize())
+		if (krrCurrentRule->GetTargetType() == KWType::Symbol)
 		{
-			kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nUpperIndex));
-			cValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
-			if (cValue > cPrecValue)
-			{
-				cUpperBound = KWContinuous::GetLowerMeanValue(cValue, cPrecValue);
-				krrAttribute->GetPartAt(1)->GetInterval()->SetUpperBound(cUpperBound);
-				krrAttribute->GetPartAt(2)->GetInterval()->SetLowerBound(cUpperBound);
-				UpdateAllStatistics(database, krrCurrentRule);
-				cPrecValue = cValue;
-				break;
-			}
-			nUpperIndex++;
+			ComputeGroupRangeFrequencyDiff(krrCurrentRule, &ivCumulatedFrequencies, nOptimizedFirstGroup, nLastGroup, &ivTargetFrequencyValuesDiff);
+			for (nTarget = 0; nTarget < nTargetNumber; nTarget++)
+				krrCurrentRule->SetInBodyTargetValueFrequencyAt(nTarget,
+					krrCurrentRule->GetInBodyTargetValueFrequencyAt(nTarget) + ivTargetFrequencyValuesDiff.GetAt(nTarget));
 		}
+		UpdateStructureStatistics(krrCurrentRule);
+	}
+	require(IsInBody(nInBodyObjectRank, krrCurrentRule));
 
-		while (nUpperIndex < oaWorkingInstances->GetSize())
-		{
-			kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nUpperIndex));
-			cValue = kwoObject->GetContinuousValueAt(liAttributeLoadIndex);
-
-			// MAJ de ivTargetFrequencyValuesDiff
-			if (cValue == cPrecValue)
-			{
-				liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
-				if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-				{
-					sObjectTargetValue = kwoObject->GetSymbolValueAt(liTargetAttributeIndex);
-					nObjectTargetValueIndex = krrCurrentRule->ComputeTargetValueIndex(sObjectTargetValue);
-					require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetValueNumber());
-					ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-				}
-				if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-				{
-					cObjectTargetValue = kwoObject->GetContinuousValueAt(liTargetAttributeIndex);
-					nObjectTargetValueIndex = krrCurrentRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-					require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-					ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-				}
-			}
+	// Optimisation de la borne restante dans le cas de deux parties, a partir de compteurs d'objets a jour
+	// Les instances de travail, couvertes par les autres conditions de la regle, sont inchangees
+	if (krrAttribute->GetPartNumber() == 2)
+	{
+		UpdateContinuousObjectsCounters(krrAttribute, true, cInitialLowerBound, cInitialUpperBound);
+		Optimize2PartsContinuousAttribute(krrAttribute, nInBodyObjectRank, krrCurrentRule, ivAllWorkingInstances);
+		return;
+	}
 
-			if (cValue > cPrecValue)
-			{
-				cUpperBound = KWContinuous::GetLowerMeanValue(cValue, cPrecValue);
-				krrAttribute->GetPartAt(1)->GetInterval()->SetUpperBound(cUpperBound);
-				krrAttribute->GetPartAt(2)->GetInterval()->SetLowerBound(cUpperBound);
-				UpdateAllStatistics(database, krrCurrentRule);
-				//DDD UpdateSubStatistics(oaWorkingInstances, krrCurrentRule);
-				//DDD UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-				if (krrCurrentRule->GetLevel() > dMaxRuleLevel)
-				{
-					dMaxRuleLevel = krrCurrentRule->GetLevel();
-					cOptimizedUpperBound = cUpperBound;
-					//krrCurrentRule->Write(cout);
-				}
-				// reinitialisation  du vecteur de difference et prise en compte de l'objet en cours
-				ivTargetFrequencyValuesDiff.Initialize();
-				liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
-				if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-				{
-					sObjectTargetValue = kwoObject->GetSymbolValueAt(liTargetAttributeIndex);
-					nObjectTargetValueIndex = krrCurrentRule->ComputeTargetValueIndex(sObjectTargetValue);
-					require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetValueNumber());
-					ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-				}
-				if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-				{
-					cObjectTargetValue = kwoObject->GetContinuousValueAt(liTargetAttributeIndex);
-					nObjectTargetValueIndex = krrCurrentRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-					require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-					ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-				}
+	////////
+	// recherche de la borne superieure optimale, a borne inferieure fixee
+	// Les effectifs cumules restent valides: aucun passage supplementaire sur la base n'est necessaire
+	cOptimizedUpperBound = krrAttribute->GetPartAt(1)->GetInterval()->GetUpperBound();
+	nOptimizedLastGroup = nLastGroup;
+	for (nGroup = nObjectGroup; nGroup < nGroupNumber - 1; nGroup++)
+	{
+		// Hormis la premiere, bornes evaluees uniquement entre deux intervalles candidats
+		if (nGroup > nObjectGroup and
+		    not krpcaAttribute->IsCandidateBoundBetween(ivGroupSortedIndexes.GetAt(nGroup), ivGroupSortedIndexes.GetAt(nGroup + 1)))
+			continue;
 
-				cPrecValue = cValue;
-			}
-			nUpperIndex++;
-		}
-		// cas borne extreme ~> 2 intervalles dont 1 avant l'objet
-		cUpperBound = KRRInterval::GetMaxUpperBound();
+		cUpperBound = KWContinuous::GetLowerMeanValue(cvGroupValues.GetAt(nGroup + 1), cvGroupValues.GetAt(nGroup));
 		krrAttribute->GetPartAt(1)->GetInterval()->SetUpperBound(cUpperBound);
 		krrAttribute->GetPartAt(2)->GetInterval()->SetLowerBound(cUpperBound);
-		UpdateAllStatistics(database, krrCurrentRule); // calcul fausse par 3 intervalles au lieu de 2.
-		//DDD UpdateSubStatistics(oaWorkingInstances, krrCurrentRule);
-		//DDD UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-		UpdateAttributeStatistics(database, krrCurrentRule, krrAttribute);
-		if (krrCurrentRule->GetLevel() >= dMaxRuleLevel)
+		ComputeGroupRangeFrequencyDiff(krrCurrentRule, &ivCumulatedFrequencies, nOptimizedFirstGroup, nGroup, &ivTargetFrequencyValuesDiff);
+		UpdateBodyStatistics(krrCurrentRule, &ivTargetFrequencyValuesDiff);
+
+		// La premiere borne, juste a cote de l'objet, sert uniquement de point de depart de l'optimisation
+		if (nGroup > nObjectGroup and krrCurrentRule->GetLevel() > dMaxRuleLevel)
 		{
 			dMaxRuleLevel = krrCurrentRule->GetLevel();
 			cOptimizedUpperBound = cUpperBound;
-			//krrCurrentRule->Write(cout);
+			nOptimizedLastGroup = nGroup;
 		}
+	}
 
-		krrAttribute->GetPartAt(1)->GetInterval()->SetUpperBound(cOptimizedUpperBound);
-		krrAttribute->GetPartAt(2)->GetInterval()->SetLowerBound(cOptimizedUpperBound);
+	// cas borne extreme ~> 2 intervalles dont 1 avant l'objet
+	cUpperBound = KRRInterval::GetMaxUpperBound();
+	krrAttribute->GetPartAt(1)->GetInterval()->SetUpperBound(cUpperBound);
+	krrAttribute->GetPartAt(2)->GetInterval()->SetLowerBound(cUpperBound);
+	ComputeGroupRangeFrequencyDiff(krrCurrentRule, &ivCumulatedFrequencies, nOptimizedFirstGroup, nGroupNumber - 1, &ivTargetFrequencyValuesDiff);
+	UpdateBodyStatistics(krrCurrentRule, &ivTargetFrequencyValuesDiff); // calcul fausse par 3 intervalles au lieu de 2.
+	UpdateAttributeStatistics(krrCurrentRule, krrAttribute);
+	if (krrCurrentRule->GetLevel() >= dMaxRuleLevel)
+	{
+		dMaxRuleLevel = krrCurrentRule->GetLevel();
+		cOptimizedUpperBound = cUpperBound;
+		nOptimizedLastGroup = nGroupNumber - 1;
+	}
 
-		//krrCurrentRule->Write(cout);
+	krrAttribute->GetPartAt(1)->GetInterval()->SetUpperBound(cOptimizedUpperBound);
+	krrAttribute->GetPartAt(2)->GetInterval()->SetLowerBound(cOptimizedUpperBound);
 
-		// regularisation si parties vides
-		if (cOptimizedUpperBound == KRRInterval::GetMaxUpperBound())
+	// regularisation si parties vides
+	if (cOptimizedUpperBound == KRRInterval::GetMaxUpperBound())
+		krrAttribute->DeletePart(krrAttribute->GetPartAt(2));
+
+	// Effectifs du corps correspondant a la borne retenue, recalcules sur toutes les instances s'ils sont estimes
+	if (bSampleSweep)
+		UpdateAllStatistics(krrCurrentRule);
+	else
+	{
+		if (krrCurrentRule->GetTargetType() == KWType::Symbol)
 		{
-			krrAttribute->DeletePart(krrAttribute->GetPartAt(2));
-			//cout << "extreme upper bound set\n";
+			ComputeGroupRangeFrequencyDiff(krrCurrentRule, &ivCumulatedFrequencies, nOptimizedFirstGroup, nOptimizedLastGroup, &ivTargetFrequencyValuesDiff);
+			for (nTarget = 0; nTarget < nTargetNumber; nTarget++)
+				krrCurrentRule->SetInBodyTargetValueFrequencyAt(nTarget,
+					krrCurrentRule->GetInBodyTargetValueFrequencyAt(nTarget) + ivTargetFrequencyValuesDiff.GetAt(nTarget));
 		}
+		UpdateStructureStatistics(krrCurrentRule);
+	}
+	require(IsInBody(nInBodyObjectRank, krrCurrentRule));
+
+	// Mise a jour des compteurs des seuls objets ayant change d'appartenance au corps de l'attribut
+	UpdateContinuousObjectsCounters(krrAttribute, true, cInitialLowerBound, cInitialUpperBound);
+	ensure(CheckObjectCounters(krrCurrentRule));
+}
+
+void KRRuleOptimizer::ComputeGroupRangeFrequencyDiff(KRRule* rule,
+	const IntVector* ivCumulatedFrequencies,
+	int nFirstGroup,
+	int nLastGroup,
+	IntVector* ivTargetValuesFrequencyDiff) const
+{
+	int nTargetNumber;
+	int nTarget;
+
+	require(rule != NULL);
+	require(ivCumulatedFrequencies != NULL);
+	require(ivTargetValuesFrequencyDiff != NULL);
+	require(ivTargetValuesFrequencyDiff->GetSize() > 0);
+	require(ivCumulatedFrequencies->GetSize() % ivTargetValuesFrequencyDiff->GetSize() == 0);
+	require(0 <= nFirstGroup and nFirstGroup <= nLastGroup + 1);
+	require((nLastGroup + 2) * ivTargetValuesFrequencyDiff->GetSize() <= ivCumulatedFrequencies->GetSize());
+
+	// Effectifs de la plage de valeurs par difference des effectifs cumules, moins ceux du corps courant
+	nTargetNumber = ivTargetValuesFrequencyDiff->GetSize();
+	for (nTarget = 0; nTarget < nTargetNumber; nTarget++)
+		ivTargetValuesFrequencyDiff->SetAt(nTarget,
+			ivCumulatedFrequencies->GetAt((nLastGroup + 1) * nTargetNumber + nTarget) -
+			ivCumulatedFrequencies->GetAt(nFirstGroup * nTargetNumber + nTarget) -
+			rule->GetInBodyTargetValueFrequencyAt(nTarget));
+}
+
+void KRRuleOptimizer::RefineContinuousAttributeBounds(KRRAttribute* krrAttribute,
+	int nInBodyObjectRank,
+	KRRule* krrCurrentRule)
+{
+	KRPreprocessedContinuousAttribute* krpcaAttribute;
+	IntVector ivWorkingInstances;
+	ContinuousVector cvGroupValues;
+	IntVector ivGroupSortedIndexes;
+	IntVector ivCumulatedFrequencies;
+	IntVector ivSampledGroups;
+	IntVector ivTargetFrequencyValuesDiff;
+	Continuous cValue;
+	Continuous cOptimizedBound;
+	boolean bInitialWithLowerBound;
+	Continuous cInitialLowerBound;
+	Continuous cInitialUpperBound;
+	double dMaxRuleLevel;
+	double dLevel;
+	int nBodyPartIndex;
+	int nTargetNumber;
+	int nTarget;
+	int nObjectIndex;
+	int nObjectRank;
+	int nObjectGroup;
+	int nGroupNumber;
+	int nGroup;
+	int nFirstGroup;
+	int nLastGroup;
+	int nWindowFirstGroup;
+	int nWindowLastGroup;
+	int nOptimizedGroup;
 
-		//krrCurrentRule->Write(cout);
-		//DDD
-		UpdateAllStatistics(database, krrCurrentRule);
-		//UpdateSubStatistics(oaWorkingInstances, krrCurrentRule);
+	require(krrAttribute != NULL);
+	require(krrAttribute->GetAttributeType() == KWType::Continuous);
+	require(krrCurrentRule != NULL);
+	require(krrCurrentRule->GetTargetType() == KWType::Symbol);
+	require(IsInBody(nInBodyObjectRank, krrCurrentRule));
+	require(CheckObjectCounters(krrCurrentRule));
+
+	// level de la regle a ameliorer
+	dMaxRuleLevel = krrCurrentRule->GetLevel();
+
+	// Corps initial de l'attribut
+	nBodyPartIndex = krrAttribute->GetBodyPartIndex();
+	bInitialWithLowerBound = (nBodyPartIndex != 0);
+	cInitialLowerBound = krrAttribute->GetPartAt(nBodyPartIndex)->GetInterval()->GetLowerBound();
+	cInitialUpperBound = krrAttribute->GetPartAt(nBodyPartIndex)->GetInterval()->GetUpperBound();
+
+	// Instances de travail sur toutes les instances, regroupees par valeur distincte avec leurs effectifs
+	// cumules par classe (cf. Optimize3PartsContinuousAttribute), en reperant les valeurs de l'echantillon
+	krpcaAttribute = cast(KRPreprocessedContinuousAttribute*, LookUpPreprocessedAttribute(krrAttribute->GetAttributeName()));
+	krpcaAttribute->PrepareWorkingInstances(krrAttribute, krrCurrentRule, &krocCounters, &ivWorkingInstances);
+	nTargetNumber = krrCurrentRule->GetTargetValueNumber();
+	ivCumulatedFrequencies.SetSize(nTargetNumber);
+	ivCumulatedFrequencies.Initialize();
+	nObjectGroup = -1;
+	for (nObjectIndex = 0; nObjectIndex < ivWorkingInstances.GetSize(); nObjectIndex++)
+	{
+		nObjectRank = krpcaAttribute->GetObjectRankAt(ivWorkingInstances.GetAt(nObjectIndex));
+		cValue = krpcaAttribute->GetValueAt(ivWorkingInstances.GetAt(nObjectIndex));
+		if (cvGroupValues.GetSize() == 0 or cValue > cvGroupValues.GetAt(cvGroupValues.GetSize() - 1))
+		{
+			cvGroupValues.Add(cValue);
+			ivGroupSortedIndexes.Add(ivWorkingInstances.GetAt(nObjectIndex));
+			ivSampledGroups.Add(0);
+			for (nTarget = 0; nTarget < nTargetNumber; nTarget++)
+				ivCumulatedFrequencies.Add(ivCumulatedFrequencies.GetAt((cvGroupValues.GetSize() - 1) * nTargetNumber + nTarget));
+		}
+		ivCumulatedFrequencies.UpgradeAt(cvGroupValues.GetSize() * nTargetNumber + ivObjectTargetCodes.GetAt(nObjectRank), 1);
+		if (bmSampleObjects.Contains(nObjectRank) or nObjectRank == nInBodyObjectRank)
+			ivSampledGroups.SetAt(cvGroupValues.GetSize() - 1, 1);
+		if (nObjectRank == nInBodyObjectRank)
+			nObjectGroup = cvGroupValues.GetSize() - 1;
+	}
+	nGroupNumber = cvGroupValues.GetSize();
+	assert(0 <= nObjectGroup and nObjectGroup < nGroupNumber);
 
-		//krrCurrentRule->Write(cout);
-		require(IsInBody(kwoInBody, krrCurrentRule));
+	// Groupes extremes du corps courant
+	nFirstGroup = 0;
+	if (bInitialWithLowerBound)
+	{
+		while (cvGroupValues.GetAt(nFirstGroup) <= cInitialLowerBound)
+			nFirstGroup++;
+	}
+	nLastGroup = nGroupNumber - 1;
+	while (cvGroupValues.GetAt(nLastGroup) > cInitialUpperBound)
+		nLastGroup--;
+	assert(nFirstGroup <= nObjectGroup and nObjectGroup <= nLastGroup);
+	ivTargetFrequencyValuesDiff.SetSize(nTargetNumber);
+
+	// Affinage de la borne inferieure entre les valeurs de l'echantillon qui l'entourent,
+	// le corps commencant au plus tard a la valeur de l'objet de reference
+	if (bInitialWithLowerBound)
+	{
+		nWindowFirstGroup = nFirstGroup - 1;
+		while (nWindowFirstGroup > 0 and ivSampledGroups.GetAt(nWindowFirstGroup) == 0)
+			nWindowFirstGroup--;
+		nWindowLastGroup = nFirstGroup;
+		while (nWindowLastGroup < nObjectGroup and ivSampledGroups.GetAt(nWindowLastGroup) == 0)
+			nWindowLastGroup++;
+		nOptimizedGroup = nFirstGroup;
+		cOptimizedBound = cInitialLowerBound;
+		for (nGroup = max(nWindowFirstGroup, 0); nGroup < nWindowLastGroup; nGroup++)
+		{
+			if (not krpcaAttribute->IsCandidateBoundBetween(ivGroupSortedIndexes.GetAt(nGroup), ivGroupSortedIndexes.GetAt(nGroup + 1)))
+				continue;
+			ComputeGroupRangeFrequencyDiff(krrCurrentRule, &ivCumulatedFrequencies, nGroup + 1, nLastGroup, &ivTargetFrequencyValuesDiff);
+			dLevel = GetRuleCosts()->ComputeRuleLevelWithDiff(krrCurrentRule, &ivTargetFrequencyValuesDiff);
+			if (dLevel > dMaxRuleLevel)
+			{
+				dMaxRuleLevel = dLevel;
+				nOptimizedGroup = nGroup + 1;
+				cOptimizedBound = KWContinuous::GetLowerMeanValue(cvGroupValues.GetAt(nGroup), cvGroupValues.GetAt(nGroup + 1));
+			}
+		}
+		krrAttribute->GetPartAt(nBodyPartIndex)->GetInterval()->SetLowerBound(cOptimizedBound);
+		krrAttribute->GetPartAt(nBodyPartIndex - 1)->GetInterval()->SetUpperBound(cOptimizedBound);
+		ComputeGroupRangeFrequencyDiff(krrCurrentRule, &ivCumulatedFrequencies, nOptimizedGroup, nLastGroup, &ivTargetFrequencyValuesDiff);
+		UpdateBodyStatistics(krrCurrentRule, &ivTargetFrequencyValuesDiff);
+		nFirstGroup = nOptimizedGroup;
+	}
 
-		delete oaWorkingInstances;
+	// Affinage de la borne superieure entre les valeurs de l'echantillon qui l'entourent,
+	// le corps finissant au plus tot a la valeur de l'objet de reference
+	if (nBodyPartIndex < krrAttribute->GetPartNumber() - 1)
+	{
+		nWindowFirstGroup = nLastGroup;
+		while (nWindowFirstGroup > nObjectGroup and ivSampledGroups.GetAt(nWindowFirstGroup) == 0)
+			nWindowFirstGroup--;
+		nWindowLastGroup = nLastGroup + 1;
+		while (nWindowLastGroup < nGroupNumber - 1 and ivSampledGroups.GetAt(nWindowLastGroup) == 0)
+			nWindowLastGroup++;
+		nOptimizedGroup = nLastGroup;
+		cOptimizedBound = cInitialUpperBound;
+		for (nGroup = nWindowFirstGroup; nGroup < min(nWindowLastGroup, nGroupNumber - 1); nGroup++)
+		{
+			if (not krpcaAttribute->IsCandidateBoundBetween(ivGroupSortedIndexes.GetAt(nGroup), ivGroupSortedIndexes.GetAt(nGroup + 1)))
+				continue;
+			ComputeGroupRangeFrequencyDiff(krrCurrentRule, &ivCumulatedFrequencies, nFirstGroup, nGroup, &ivTargetFrequencyValuesDiff);
+			dLevel = GetRuleCosts()->ComputeRuleLevelWithDiff(krrCurrentRule, &ivTargetFrequencyValuesDiff);
+			if (dLevel > dMaxRuleLevel)
+			{
+				dMaxRuleLevel = dLevel;
+				nOptimizedGroup = nGroup;
+				cOptimizedBound = KWContinuous::GetLowerMeanValue(cvGroupValues.GetAt(nGroup + 1), cvGroupValues.GetAt(nGroup));
+			}
+		}
+		krrAttribute->GetPartAt(nBodyPartIndex)->GetInterval()->SetUpperBound(cOptimizedBound);
+		krrAttribute->GetPartAt(nBodyPartIndex + 1)->GetInterval()->SetLowerBound(cOptimizedBound);
+		ComputeGroupRangeFrequencyDiff(krrCurrentRule, &ivCumulatedFrequencies, nFirstGroup, nOptimizedGroup, &ivTargetFrequencyValuesDiff);
+		UpdateBodyStatistics(krrCurrentRule, &ivTargetFrequencyValuesDiff);
+	}
+	assert(IsInBody(nInBodyObjectRank, krrCurrentRule));
+	assert(krrCurrentRule->GetTargetType() != KWType::Symbol or CheckBodyStatistics(krrCurrentRule));
 
-	} // end else 2 parts
+	// Mise a jour des compteurs des seuls objets ayant change d'appartenance au corps de l'attribut
+	UpdateContinuousObjectsCounters(krrAttribute, bInitialWithLowerBound, cInitialLowerBound, cInitialUpperBound);
+	ensure(CheckObjectCounters(krrCurrentRule));
 }
 
-double KRRuleOptimizer::OptimizeSymbolAttribute(KWDatabase* database,
-	KRRAttribute* krrAttribute,
-	KWObject* kwoInBody,
+double KRRuleOptimizer::OptimizeSymbolAttribute(KRRAttribute* krrAttribute,
+	int nInBodyObjectRank,
 	KRRule* krrCurrentRule)
 {
-	KWLoadIndex liAttributeLoadIndex;
 	double dMaxRuleLevel;
 	Symbol sInBodyObjectValue;
 	SymbolVector svInBodyValues;
 	SymbolVector svOutBodyValues;
-	SymbolVector svTemp;
 	KRRValueSet* krrvsInBody;
 	KRRValueSet* krrvsOutBody;
 	KRRValue* value;
 	int nRun;
 	int nRandPart;
 	KRPreprocessedSymbolAttribute* krpsaAttribute;
-	KWObject* kwoObject;
 	IntVector ivTargetFrequencyValuesDiff;
-	int nIndex;
 	Symbol sMovingValue;
-	KWLoadIndex liTargetAttributeIndex;
-	Symbol sObjectTargetValue;
-	Continuous cObjectTargetValue;
-	int nObjectTargetValueIndex;
-	Symbol sValue;
 
-	require(IsInBody(kwoInBody, krrCurrentRule));
+	require(IsInBody(nInBodyObjectRank, krrCurrentRule));
 	require(krrAttribute->GetAttributeType() == KWType::Symbol);
-	//require(krrAttribute->GetPartNumber() == 2);
 
 	// level de la regle a ameliorer
 	dMaxRuleLevel = krrCurrentRule->GetLevel();
 
-	// Index dans la base de l'attribut a optimiser
-	//cout << "Optimizing attribute : " << krrAttribute->GetAttributeName() << endl;
-	liAttributeLoadIndex = GetClassStats()->GetClass()->LookupAttribute(krrAttribute->GetAttributeName())->GetLoadIndex();
 
-	// index de la classe dans la base
-	liTargetAttributeIndex = GetClassStats()->GetClass()->LookupAttribute(GetClassStats()->GetTargetAttributeName())->GetLoadIndex();
+	// Objets de la base indexes par valeur de l'attribut a optimiser
+	krpsaAttribute = cast(KRPreprocessedSymbolAttribute*, LookUpPreprocessedAttribute(krrAttribute->GetAttributeName()));
 
 	// valeur de l'objet reference dans le corps
-	sInBodyObjectValue = kwoInBody->GetSymbolValueAt(liAttributeLoadIndex);
+	sInBodyObjectValue = krpsaAttribute->GetPreprocessedValueAt(krpsaAttribute->GetObjectValueCodeAtRank(nInBodyObjectRank))->GetValue();
 	assert(krrAttribute->IsInBodySymbol(sInBodyObjectValue));
 
-	//// Tri de la base selon l'attribut a optimiser
-	krpsaAttribute = cast(KRPreprocessedSymbolAttribute*, LookUpPreprocessedAttribute(krrAttribute->GetAttributeName()));
-
-	krocCounters.ResetCounters();
-	//cout << krocCounters;
-	InitializeObjectsCounters(database, krrCurrentRule);
-	assert(krocCounters.GetBodyCountAt(kwoInBody) == krrCurrentRule->GetAttributeNumber());
-	ensure(CheckObjectCounters(database, krrCurrentRule));
-	//cout << krocCounters;
-	//oaWorkingInstances = new ObjectArray;
-	//krpsaAttribute->PrepareWorkingInstances(krrAttribute, krrCurrentRule, &krocCounters, oaWorkingInstances);
-	//assert(CheckObjectCounters(database, krrCurrentRule));
-	//
-	//// Calcul de l'index de l'objet reference dans la nouvelle structure oaWorkingInstances
-	//for (nObjectIndex = 0; nObjectIndex < oaWorkingInstances->GetSize(); nObjectIndex++)
-	//{
-	//	kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nObjectIndex));
-	//	if (kwoObject == kwoInBody)
-	//		break;
-	//}
-	//cout << "oaWorking Instances Size : " << oaWorkingInstances->GetSize() << " ; nObjectIndex : " << nObjectIndex << endl;
-	//assert(0 <= nObjectIndex and nObjectIndex < oaWorkingInstances->GetSize());
-	//delete oaWorkingInstances;
-
 	//tableau des differentielles de frequences par classe
-
 	if (krrCurrentRule->GetTargetType() == KWType::Symbol)
 		ivTargetFrequencyValuesDiff.SetSize(krrCurrentRule->GetTargetValueNumber());
 	else
 		ivTargetFrequencyValuesDiff.SetSize(krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-	ivTargetFrequencyValuesDiff.Initialize();
 
-	//krrCurrentRule->Write(cout);
-	/*krrAttribute->WriteParts(cout);
-	krrCurrentRule->WriteContingencyTable(cout);
-	cout << krrCurrentRule->GetLevel() << endl;*/
-
-	////DDD a mettre a jour
+	// Les compteurs d'objets sont tenus a jour a chaque deplacement de valeur accepte
+	// Chaque objet n'ayant qu'une valeur, seuls les compteurs des objets de la valeur deplacee changent
 	for (nRun = 1; nRun <= 4; nRun++)
 	{
-		krocCounters.ResetCounters();
-		InitializeObjectsCounters(database, krrCurrentRule);
-		assert(krocCounters.GetBodyCountAt(kwoInBody) == krrCurrentRule->GetAttributeNumber());
-		ensure(CheckObjectCounters(database, krrCurrentRule));
-		//cout << krocCounters << endl;
+		assert(krocCounters.GetBodyCountAtRank(nInBodyObjectRank) == krrCurrentRule->GetAttributeNumber());
+		ensure(CheckObjectCounters(krrCurrentRule));
 
-		//cout << "\n*****\nRun : #" << nRun << endl;
-		ivTargetFrequencyValuesDiff.Initialize();
 		if (krrAttribute->GetPartNumber() == 2)
 		{
 			// creation des SymbolVector
@@ -1959,262 +2520,155 @@ double KRRuleOptimizer::OptimizeSymbolAttribute(KWDatabase* database,
 			//Optimisation par changement de Valueset pour chaque value
 			while (svInBodyValues.GetSize() != 0 or svOutBodyValues.GetSize() != 0)
 			{
-				ivTargetFrequencyValuesDiff.Initialize();
 				nRandPart = RandomInt(1);
+
+				// passage d'une valeur de l'interieur vers l'exterieur du corps
 				if (nRandPart == 0 and svInBodyValues.GetSize() != 0)
-					// randPart = 0 -> bodypart
 				{
-					////DDD
-					//krocCounters.ResetCounters();
-					//InitializeObjectsCounters(database, krrCurrentRule);
-					//assert(krocCounters.GetBodyCountAt(kwoInBody) == krrCurrentRule->GetAttributeNumber());
-					//ensure(CheckObjectCounters(database, krrCurrentRule));
-					////cout << krocCounters << endl;
-
-					//cout << "origin part : body\n";
-					// passage d'une valeur de l'interieur vers l'exterieur du corps
 					sMovingValue = svInBodyValues.GetAt(svInBodyValues.GetSize() - 1);
-					/*cout << sMovingValue << "(" <<
-						krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetLastIndex() - krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetFirstIndex()
-						<< ")" << "->\n";*/
-					ChangeValuePart(sMovingValue, krrAttribute->GetPartAt(0), krrAttribute->GetPartAt(1));
-
-					// Mise a jour du ivTargetFrequencyValuesDiff
-					for (nIndex = krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetFirstIndex();
-						nIndex <= krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetLastIndex();
-						nIndex++)
-					{
-						//DDD
-						kwoObject = cast(KWObject*, krpsaAttribute->GetObjects()->GetAt(nIndex));
-						sValue = kwoObject->GetSymbolValueAt(liAttributeLoadIndex);
-						require(sValue == sMovingValue);
-						//kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nIndex));
-						if (krocCounters.GetBodyCountAt(kwoObject) == krrCurrentRule->GetAttributeNumber())
-							//if ( (krrAttribute->IsInBodySymbol(sValue) and krocCounters.GetBodyCountAt(kwoObject) == krrCurrentRule->GetAttributeNumber())
-							//	or ((not krrAttribute->IsInBodySymbol(sValue)) and krocCounters.GetBodyCountAt(kwoObject) == krrCurrentRule->GetAttributeNumber() - 1) )
-						{
-							if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-							{
-								sObjectTargetValue = kwoObject->GetSymbolValueAt(liTargetAttributeIndex);
-								nObjectTargetValueIndex = krrCurrentRule->ComputeTargetValueIndex(sObjectTargetValue);
-								require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetValueNumber());
-								ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, -1);
-							}
-							if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-							{
-								cObjectTargetValue = kwoObject->GetContinuousValueAt(liTargetAttributeIndex);
-								nObjectTargetValueIndex = krrCurrentRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-								require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-								ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, -1);
-							}
-						}
-					}
-					//krrCurrentRule->Write(cout);
-					/*krrAttribute->WriteParts(cout);
-					krrCurrentRule->WriteContingencyTable(cout);
-					cout << krrCurrentRule->GetLevel() << endl;*/
-					UpdateAllStatistics(database, krrCurrentRule);
-					//DDD UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-					ivTargetFrequencyValuesDiff.Initialize();
-					if (krrCurrentRule->GetLevel() > dMaxRuleLevel)
-					{
-						dMaxRuleLevel = krrCurrentRule->GetLevel();
-						////DDD
-						//krocCounters.ResetCounters();
-						//InitializeObjectsCounters(database, krrCurrentRule);
-						//assert(krocCounters.GetBodyCountAt(kwoInBody) == krrCurrentRule->GetAttributeNumber());
-						//ensure(CheckObjectCounters(database, krrCurrentRule));
-						////cout << krocCounters << endl;
-					}
-					else
-					{
-						////DDD
-						//krocCounters.ResetCounters();
-						//InitializeObjectsCounters(database, krrCurrentRule);
-						//assert(krocCounters.GetBodyCountAt(kwoInBody) == krrCurrentRule->GetAttributeNumber());
-						//ensure(CheckObjectCounters(database, krrCurrentRule));
-						////cout << krocCounters << endl;
-
-						/*cout << sMovingValue << "(" <<
-							krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetLastIndex() - krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetFirstIndex()
-							<< ")" << "<- retour\n";*/
-						ChangeValuePart(sMovingValue, krrAttribute->GetPartAt(1), krrAttribute->GetPartAt(0));
-						// Mise a jour du ivTargetFrequencyValuesDiff
-						for (nIndex = krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetFirstIndex();
-							nIndex <= krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetLastIndex();
-							nIndex++)
-						{
-							//DDD
-							kwoObject = cast(KWObject*, krpsaAttribute->GetObjects()->GetAt(nIndex));
-							sValue = kwoObject->GetSymbolValueAt(liAttributeLoadIndex);
-							require(sValue == sMovingValue);
-							//kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nIndex));
-							if (krocCounters.GetBodyCountAt(kwoObject) == krrCurrentRule->GetAttributeNumber())
-								//if ( (krrAttribute->IsInBodySymbol(sValue) and krocCounters.GetBodyCountAt(kwoObject) == krrCurrentRule->GetAttributeNumber())
-								//	or ((not krrAttribute->IsInBodySymbol(sValue)) and krocCounters.GetBodyCountAt(kwoObject) == krrCurrentRule->GetAttributeNumber() - 1) )
-							{
-								if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-								{
-									sObjectTargetValue = kwoObject->GetSymbolValueAt(liTargetAttributeIndex);
-									nObjectTargetValueIndex = krrCurrentRule->ComputeTargetValueIndex(sObjectTargetValue);
-									require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetValueNumber());
-									ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-								}
-								if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-								{
-									cObjectTargetValue = kwoObject->GetContinuousValueAt(liTargetAttributeIndex);
-									nObjectTargetValueIndex = krrCurrentRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-									require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-									ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-								}
-							}
-						}
-						/*krrAttribute->WriteParts(cout);
-						krrCurrentRule->WriteContingencyTable(cout);
-						cout << krrCurrentRule->GetLevel() << endl;*/
-						UpdateAllStatistics(database, krrCurrentRule);
-						//DDD UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-						ivTargetFrequencyValuesDiff.Initialize();
-					}
+
+					// Les objets de la valeur couverts par la regle sortent du corps
+					ComputeSymbolValueFrequencyDiff(krpsaAttribute, sMovingValue, krrCurrentRule->GetAttributeNumber(), -1,
+						krrCurrentRule, &ivTargetFrequencyValuesDiff);
+					dMaxRuleLevel = TrySymbolValueMove(krrCurrentRule, krrAttribute, krpsaAttribute, sMovingValue, true,
+						dMaxRuleLevel, &ivTargetFrequencyValuesDiff);
 					svInBodyValues.SetSize(svInBodyValues.GetSize() - 1);
 				}
 
-				// transfert de l'exterieur vers l'interieur
+				// passage d'une valeur de l'exterieur vers l'interieur du corps
 				if (nRandPart == 1 and svOutBodyValues.GetSize() != 0)
 				{
-					////DDD
-					//krocCounters.ResetCounters();
-					//InitializeObjectsCounters(database, krrCurrentRule);
-					//assert(krocCounters.GetBodyCountAt(kwoInBody) == krrCurrentRule->GetAttributeNumber());
-					//ensure(CheckObjectCounters(database, krrCurrentRule));
-					////cout << krocCounters << endl;
-
-					//cout << "origin part : out-body\n";
-					// passage d'une valeur de l'exterieur vers l'intereiur du corps
 					sMovingValue = svOutBodyValues.GetAt(svOutBodyValues.GetSize() - 1);
-					/*cout << sMovingValue << "(" <<
-						krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetLastIndex() - krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetFirstIndex()
-						<< ")" << "<-\n";*/
-					ChangeValuePart(sMovingValue, krrAttribute->GetPartAt(1), krrAttribute->GetPartAt(0));
-					// Mise a jour du ivTargetFrequencyValuesDiff
-					for (nIndex = krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetFirstIndex();
-						nIndex <= krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetLastIndex();
-						nIndex++)
-					{
-						//DDD
-						kwoObject = cast(KWObject*, krpsaAttribute->GetObjects()->GetAt(nIndex));
-						sValue = kwoObject->GetSymbolValueAt(liAttributeLoadIndex);
-						require(sValue == sMovingValue);
-						//kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nIndex));
-						if (krocCounters.GetBodyCountAt(kwoObject) == krrCurrentRule->GetAttributeNumber() - 1)
-							//if ( (krrAttribute->IsInBodySymbol(sValue) and krocCounters.GetBodyCountAt(kwoObject) == krrCurrentRule->GetAttributeNumber())
-							//	or ((not krrAttribute->IsInBodySymbol(sValue)) and krocCounters.GetBodyCountAt(kwoObject) == krrCurrentRule->GetAttributeNumber() - 1) )
-						{
-							if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-							{
-								sObjectTargetValue = kwoObject->GetSymbolValueAt(liTargetAttributeIndex);
-								nObjectTargetValueIndex = krrCurrentRule->ComputeTargetValueIndex(sObjectTargetValue);
-								require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetValueNumber());
-								ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-							}
-							if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-							{
-								cObjectTargetValue = kwoObject->GetContinuousValueAt(liTargetAttributeIndex);
-								nObjectTargetValueIndex = krrCurrentRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-								require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-								ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, 1);
-							}
-						}
-					}
-					UpdateAllStatistics(database, krrCurrentRule);
-					/*krrAttribute->WriteParts(cout);
-					krrCurrentRule->WriteContingencyTable(cout);
-					cout << krrCurrentRule->GetLevel() << endl;*/
-					//DDD UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-					ivTargetFrequencyValuesDiff.Initialize();
-					if (krrCurrentRule->GetLevel() > dMaxRuleLevel)
-					{
-						dMaxRuleLevel = krrCurrentRule->GetLevel();
-						////DDD
-						//krocCounters.ResetCounters();
-						//InitializeObjectsCounters(database, krrCurrentRule);
-						//assert(krocCounters.GetBodyCountAt(kwoInBody) == krrCurrentRule->GetAttributeNumber());
-						//ensure(CheckObjectCounters(database, krrCurrentRule));
-						////cout << krocCounters << endl;
-					}
-					else
-					{
-						////DDD
-						//krocCounters.ResetCounters();
-						//InitializeObjectsCounters(database, krrCurrentRule);
-						//assert(krocCounters.GetBodyCountAt(kwoInBody) == krrCurrentRule->GetAttributeNumber());
-						//ensure(CheckObjectCounters(database, krrCurrentRule));
-						////cout << krocCounters << endl;
-
-						ChangeValuePart(sMovingValue, krrAttribute->GetPartAt(0), krrAttribute->GetPartAt(1));
-						/*cout << sMovingValue << "(" <<
-							krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetLastIndex() - krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetFirstIndex()
-							<< ")" << "-> retour\n";*/
-						for (nIndex = krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetFirstIndex();
-							nIndex <= krpsaAttribute->LookUpPreprocessedValue(sMovingValue)->GetLastIndex();
-							nIndex++)
-						{
-							//DDD
-							kwoObject = cast(KWObject*, krpsaAttribute->GetObjects()->GetAt(nIndex));
-							sValue = kwoObject->GetSymbolValueAt(liAttributeLoadIndex);
-							require(sValue == sMovingValue);
-							//kwoObject = cast(KWObject*, oaWorkingInstances->GetAt(nIndex));
-							if (krocCounters.GetBodyCountAt(kwoObject) == krrCurrentRule->GetAttributeNumber() - 1)
-								//if ( (krrAttribute->IsInBodySymbol(sValue) and krocCounters.GetBodyCountAt(kwoObject) == krrCurrentRule->GetAttributeNumber())
-								//	or ((not krrAttribute->IsInBodySymbol(sValue)) and krocCounters.GetBodyCountAt(kwoObject) == krrCurrentRule->GetAttributeNumber() - 1) )
-							{
-								if (krrCurrentRule->GetTargetType() == KWType::Symbol)
-								{
-									sObjectTargetValue = kwoObject->GetSymbolValueAt(liTargetAttributeIndex);
-									nObjectTargetValueIndex = krrCurrentRule->ComputeTargetValueIndex(sObjectTargetValue);
-									require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetValueNumber());
-									ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, -1);
-								}
-								if (krrCurrentRule->GetTargetType() == KWType::Continuous)
-								{
-									cObjectTargetValue = kwoObject->GetContinuousValueAt(liTargetAttributeIndex);
-									nObjectTargetValueIndex = krrCurrentRule->ComputeContinuousTargetValuePartIndex(cObjectTargetValue);
-									require(nObjectTargetValueIndex >= 0 and nObjectTargetValueIndex < krrCurrentRule->GetTargetAttribute()->GetPartNumber());
-									ivTargetFrequencyValuesDiff.UpgradeAt(nObjectTargetValueIndex, -1);
-								}
-							}
-						}
-						UpdateAllStatistics(database, krrCurrentRule);
-						/*krrAttribute->WriteParts(cout);
-						krrCurrentRule->WriteContingencyTable(cout);
-						cout << krrCurrentRule->GetLevel() << endl;*/
-						//DDD UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-						ivTargetFrequencyValuesDiff.Initialize();
-					}
+
+					// Les objets de la valeur couverts par toutes les autres conditions entrent dans le corps
+					ComputeSymbolValueFrequencyDiff(krpsaAttribute, sMovingValue, krrCurrentRule->GetAttributeNumber() - 1, 1,
+						krrCurrentRule, &ivTargetFrequencyValuesDiff);
+					dMaxRuleLevel = TrySymbolValueMove(krrCurrentRule, krrAttribute, krpsaAttribute, sMovingValue, false,
+						dMaxRuleLevel, &ivTargetFrequencyValuesDiff);
 					svOutBodyValues.SetSize(svOutBodyValues.GetSize() - 1);
 				}
-				/*cout << "InBodyValuesSize : " << svInBodyValues.GetSize() << endl;
-				cout << "OutBodyValuesSize : " << svOutBodyValues.GetSize() << endl;
-				cout << "Rule level : " << krrCurrentRule->GetLevel() << "\n";*/
 			}
-			UpdateAllStatistics(database, krrCurrentRule);
 		}
-		UpdateAllStatistics(database, krrCurrentRule);
+
+		// Resynchronisation complete des statistiques une seule fois par passe, apres verification en mode debug
+		// des effectifs du corps mis a jour par differentielles
+		assert(krrCurrentRule->GetTargetType() != KWType::Symbol or CheckBodyStatistics(krrCurrentRule));
+		UpdateAllStatistics(krrCurrentRule);
 	} // fin optim
 
 	//Regularisation si partie vide
 	// la partie vide ne peut etre que celle hors du corps (1)
 	if (krrAttribute->GetPartAt(1)->GetValueSet()->GetValueNumber() == 0)
+	{
 		krrAttribute->DeletePart(krrAttribute->GetPartAt(1));
+		UpdateStructureStatistics(krrCurrentRule);
+	}
 
-	//UpdateBodyStatistics(database, krrCurrentRule, &ivTargetFrequencyValuesDiff);
-	UpdateAllStatistics(database, krrCurrentRule);
-
-	require(IsInBody(kwoInBody, krrCurrentRule));
+	require(IsInBody(nInBodyObjectRank, krrCurrentRule));
+	ensure(CheckObjectCounters(krrCurrentRule));
 
 	return krrCurrentRule->GetLevel();
 }
 
+double KRRuleOptimizer::TrySymbolValueMove(KRRule* krrCurrentRule,
+	KRRAttribute* krrAttribute,
+	KRPreprocessedSymbolAttribute* krpsaAttribute,
+	Symbol sValue,
+	boolean bToOutBody,
+	double dMinLevel,
+	IntVector* ivTargetValuesFrequencyDiff)
+{
+	KRRPart* krrpOrigin;
+	KRRPart* krrpDestination;
+	double dCandidateLevel;
+	int nTarget;
+	int nValueCode;
+
+	require(krrAttribute->GetPartNumber() == 2);
+	require(krrAttribute->GetBodyPartIndex() == 0);
+	require(ivTargetValuesFrequencyDiff != NULL);
+
+	// Parties d'origine et de destination de la valeur
+	krrpOrigin = krrAttribute->GetPartAt(bToOutBody ? 0 : 1);
+	krrpDestination = krrAttribute->GetPartAt(bToOutBody ? 1 : 0);
+
+	// Code de la valeur, dont le bit est inverse dans l'ensemble des codes du corps a chaque changement de partie
+	nValueCode = krpsaAttribute->LookUpValueCode(sValue);
+	assert(nValueCode >= 0);
+	assert(krrAttribute->IsInBodySymbolCode(nValueCode) == bToOutBody);
+
+	// En classification, le deplacement ne modifie que les couts du corps et de l'exterieur:
+	// il est evalue sans modifier la regle, et applique uniquement s'il ameliore la regle
+	if (krrCurrentRule->GetTargetType() == KWType::Symbol)
+	{
+		dCandidateLevel = GetRuleCosts()->ComputeRuleLevelWithDiff(krrCurrentRule, ivTargetValuesFrequencyDiff);
+		if (dCandidateLevel > dMinLevel)
+		{
+			ChangeValuePart(sValue, krrpOrigin, krrpDestination);
+			krrAttribute->GetBodyValueCodes()->Flip(nValueCode);
+			UpdateBodyStatistics(krrCurrentRule, ivTargetValuesFrequencyDiff);
+			assert(fabs(krrCurrentRule->GetLevel() - dCandidateLevel) < dEpsilon);
+		}
+	}
+	// En regression, les effectifs dependent de la partition cible: application puis retour arriere
+	// par application de la differentielle opposee si le deplacement n'ameliore pas la regle
+	else
+	{
+		ChangeValuePart(sValue, krrpOrigin, krrpDestination);
+		krrAttribute->GetBodyValueCodes()->Flip(nValueCode);
+		UpdateBodyStatistics(krrCurrentRule, ivTargetValuesFrequencyDiff);
+		dCandidateLevel = krrCurrentRule->GetLevel();
+		if (dCandidateLevel <= dMinLevel)
+		{
+			ChangeValuePart(sValue, krrpDestination, krrpOrigin);
+			krrAttribute->GetBodyValueCodes()->Flip(nValueCode);
+			for (nTarget = 0; nTarget < ivTargetValuesFrequencyDiff->GetSize(); nTarget++)
+				ivTargetValuesFrequencyDiff->SetAt(nTarget, -ivTargetValuesFrequencyDiff->GetAt(nTarget));
+			UpdateBodyStatistics(krrCurrentRule, ivTargetValuesFrequencyDiff);
+		}
+	}
+
+	// Mise a jour des compteurs des objets de la valeur si le deplacement est accepte
+	if (dCandidateLevel > dMinLevel)
+	{
+		UpdateSymbolValueObjectsCounters(krpsaAttribute, sValue, bToOutBody ? -1 : 1);
+		return krrCurrentRule->GetLevel();
+	}
+	else
+		return dMinLevel;
+}
+
+void KRRuleOptimizer::ComputeSymbolValueFrequencyDiff(KRPreprocessedSymbolAttribute* krpsaAttribute,
+	Symbol sValue,
+	int nBodyCount,
+	int nDelta,
+	KRRule* rule,
+	IntVector* ivTargetValuesFrequencyDiff)
+{
+	KRPreprocessedValue* krpvValue;
+	int nObjectRank;
+	int nIndex;
+
+	require(krpsaAttribute != NULL);
+	require(rule != NULL);
+	require(ivTargetValuesFrequencyDiff != NULL);
+	require(nDelta == 1 or nDelta == -1);
+
+	ivTargetValuesFrequencyDiff->Initialize();
+
+	// Parcours de la plage des objets de la valeur dans la base triee (aucun objet pour une valeur absente)
+	krpvValue = krpsaAttribute->LookUpPreprocessedValue(sValue);
+	if (krpvValue != NULL)
+	{
+		for (nIndex = krpvValue->GetFirstIndex(); nIndex <= krpvValue->GetLastIndex(); nIndex++)
+		{
+			nObjectRank = krpsaAttribute->GetObjectRankAt(nIndex);
+			if (krocCounters.GetBodyCountAtRank(nObjectRank) == nBodyCount)
+				ivTargetValuesFrequencyDiff->UpgradeAt(ComputeObjectTargetIndex(nObjectRank, rule), nDelta);
+		}
+	}
+}
+
 void KRRuleOptimizer::ChangeValuePart(Symbol sValue, KRRPart* krrpOrigin, KRRPart* krrpDestination) const
 {
 	KRRValue* value;
@@ -2232,13 +2686,45 @@ void KRRuleOptimizer::ChangeValuePart(Symbol sValue, KRRPart* krrpOrigin, KRRPar
 	}
 }
 
-double KRRuleOptimizer::OptimizeRule(KWDatabase* kwdb, KWObject* kwoInBody, KRRule* krrCurrentRule)
+double KRRuleOptimizer::ComputeAttributeLevelUpperBound(KRRAttribute* krrAttribute, KRRule* krrCurrentRule,
+	const IntVector* ivWorkingInstances)
+{
+	KRPreprocessedAttribute* krpaAttribute;
+	IntVector ivWorkingTargetFrequencies;
+	int nIndex;
+
+	require(krrAttribute != NULL);
+	require(krrCurrentRule != NULL);
+	require(ivWorkingInstances != NULL);
+
+	// Majorant disponible uniquement en classification supervisee
+	if (krrCurrentRule->GetTargetType() != KWType::Symbol)
+		return 1;
+
+	// Effectifs par classe des instances couvertes par les autres conditions de la regle
+	krpaAttribute = LookUpPreprocessedAttribute(krrAttribute->GetAttributeName());
+	check(krpaAttribute);
+	ivWorkingTargetFrequencies.SetSize(krrCurrentRule->GetTargetValueNumber());
+	ivWorkingTargetFrequencies.Initialize();
+	for (nIndex = 0; nIndex < ivWorkingInstances->GetSize(); nIndex++)
+		ivWorkingTargetFrequencies.UpgradeAt(ivObjectTargetCodes.GetAt(krpaAttribute->GetObjectRankAt(ivWorkingInstances->GetAt(nIndex))), 1);
+	return GetRuleCosts()->ComputeAttributeLevelUpperBound(krrCurrentRule, krrAttribute, &ivWorkingTargetFrequencies);
+}
+
+double KRRuleOptimizer::OptimizeRule(int nInBodyObjectRank, KRRule* krrCurrentRule)
 {
+	const int nMaxOptimizationDepth = 10;
 	int nIndex;
 	int nOptimizationDepth;
 	double dMinLevel;
 	//double dCurrentLevel;
 	int nbAttributes;
+	int nPrunedAttributeNumber;
+	boolean bPruned;
+	double dLevelUpperBound;
+	KRRAttribute* krrAttribute;
+	KRPreprocessedAttribute* krpaAttribute;
+	IntVector ivWorkingInstances;
 
 	dMinLevel = krrCurrentRule->GetLevel();
 	//dCurrentLevel = dMinLevel;
@@ -2246,24 +2732,60 @@ double KRRuleOptimizer::OptimizeRule(KWDatabase* kwdb, KWObject* kwoInBody, KRRu
 	//cout << "Nombre d'attributs : " << krrCurrentRule->GetAttributeNumber() << endl;
 
 	// nombre d'optimisations controles
-	for (nOptimizationDepth = 1; nOptimizationDepth <= 10; nOptimizationDepth++)
+	bPruned = false;
+	for (nOptimizationDepth = 1; nOptimizationDepth <= nMaxOptimizationDepth; nOptimizationDepth++)
 	{
 		// DDD nbAttributes = krrCurrentRule->GetInformativeAttributeNumber();
 		nbAttributes = krrCurrentRule->GetAttributeNumber();
+		nPrunedAttributeNumber = 0;
 		for (nIndex = 0; nIndex < nbAttributes; nIndex++)
 		{
+			// Arret anticipe si le temps alloue est depasse: la regle courante reste valide
+			if (IsMiningTimeExhausted())
+				break;
+
 			/*cout << "************************\n";
 			cout << "Optimize Attribute : " << krrCurrentRule->GetAttributeAt(nIndex)->GetAttributeName() << endl;
 			cout << "nb inf att : " << krrCurrentRule->GetInformativeAttributeNumber() << endl;
 			cout << "nb att : " << krrCurrentRule->GetAttributeNumber() << endl;*/
-			OptimizeRuleAttribute(kwdb, krrCurrentRule->GetAttributeAt(nIndex), kwoInBody, krrCurrentRule);
+
+			// Elagage si le majorant optimiste ne depasse pas le seuil de conservation des regles
+			// Toutes les regles informatives etant conservees, ce seuil est celui des regles informatives
+			krrAttribute = krrCurrentRule->GetAttributeAt(nIndex);
+			krpaAttribute = LookUpPreprocessedAttribute(krrAttribute->GetAttributeName());
+			check(krpaAttribute);
+
+			// Instances de travail de l'attribut, calculees une seule fois pour le majorant et pour le parcours
+			// des bornes numeriques, sauf si ce parcours s'effectue sur l'echantillon
+			ivWorkingInstances.SetSize(0);
+			if (krrCurrentRule->GetTargetType() == KWType::Symbol or
+			    (krrAttribute->GetAttributeType() == KWType::Continuous and not IsSampleOptimizationUsed(krrCurrentRule)))
+				krpaAttribute->PrepareWorkingInstances(krrAttribute, krrCurrentRule, &krocCounters, &ivWorkingInstances);
+			dLevelUpperBound = ComputeAttributeLevelUpperBound(krrAttribute, krrCurrentRule, &ivWorkingInstances);
+			assert(dLevelUpperBound >= krrCurrentRule->GetLevel() - dEpsilon);
+			if (dLevelUpperBound <= dEpsilon)
+				nPrunedAttributeNumber++;
+			else
+				OptimizeRuleAttribute(krrAttribute, nInBodyObjectRank, krrCurrentRule, &ivWorkingInstances);
 			// DDD Attention a ne pas changer le nb d'attributs informatifs lors de l'optimisation
 			//krrCurrentRule->Write(cout);
 		}
+
+		// Abandon de la relance si aucun attribut ne peut rendre la regle informative: la regle est inchangee
+		if (nbAttributes > 0 and nPrunedAttributeNumber == nbAttributes)
+		{
+			nPrunedRestartNumber++;
+			bPruned = true;
+			break;
+		}
+		RemoveNonInformativeAttributesFromCounters(krrCurrentRule);
 		krrCurrentRule->DeleteNonInformativeAttributes();
-		UpdateAllStatistics(kwdb, krrCurrentRule);
+		UpdateAllStatistics(krrCurrentRule);
+		ensure(CheckObjectCounters(krrCurrentRule));
 
-		if (krrCurrentRule->GetLevel() <= dMinLevel or krrCurrentRule->GetInformativeAttributeNumber() == 0)
+		// Arret si convergence, ou si le corps d'une regle deja extraite est atteint
+		if (krrCurrentRule->GetLevel() <= dMinLevel or krrCurrentRule->GetInformativeAttributeNumber() == 0 or IsMiningTimeExhausted() or
+		    (odMinedRuleBodies.GetCount() > 0 and odMinedRuleBodies.Lookup(krrCurrentRule->ComputeBodyKey()) != NULL))
 		{
 			/*cout << "Convergence : no more level improvement\n";
 			cout << "Nombre d'attributs : " << krrCurrentRule->GetAttributeNumber() << endl;*/
@@ -2277,6 +2799,10 @@ double KRRuleOptimizer::OptimizeRule(KWDatabase* kwdb, KWObject* kwoInBody, KRRu
 		}
 	}
 
+	// Suivi du nombre de boucles d'optimisation effectuees
+	nOptimizationLoopNumber += min(nOptimizationDepth, nMaxOptimizationDepth);
+	nOptimizedRuleNumber++;
+
 	//Debug
 	/*for (nIndex = 0; nIndex < krrCurrentRule->GetAttributeNumber(); nIndex++)
 	{
@@ -2298,6 +2824,19 @@ double KRRuleOptimizer::OptimizeRule(KWDatabase* kwdb, KWObject* kwoInBody, KRRu
 	}
 	krrCurrentRule->DeleteNonInformativeAttributes();*/
 
+	// Affinage sur toutes les instances des bornes numeriques optimisees sur l'echantillon
+	if (IsSampleOptimizationUsed(krrCurrentRule) and not bPruned)
+	{
+		for (nIndex = 0; nIndex < krrCurrentRule->GetAttributeNumber(); nIndex++)
+		{
+			if (IsMiningTimeExhausted())
+				break;
+			krrAttribute = krrCurrentRule->GetAttributeAt(nIndex);
+			if (krrAttribute->GetAttributeType() == KWType::Continuous and krrAttribute->GetPartNumber() > 1)
+				RefineContinuousAttributeBounds(krrAttribute, nInBodyObjectRank, krrCurrentRule);
+		}
+	}
+
 	// Remise a zero des compteurs d'objets apres l'optimisation de la regle pour la nouvelle regle
 	krocCounters.ResetCounters();
 	//cout << krocCounters << endl;
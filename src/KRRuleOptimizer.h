@@ -9,7 +9,10 @@
 #include "KRRule.h"
 #include "KRRuleCosts.h"
 #include "KRPreprocessedAttribute.h"
+#include "KRAttributeColumn.h"
 #include "KRObjectCounters.h"
+#include "KRRuleCoveragePlan.h"
+#include "KRPreprocessingTask.h"
 
 //////////////////////////////////////////////////////////////////////////////////
 // Classe KRRuleOptimizer
@@ -26,10 +29,41 @@ public:
 	void SetMaxRuleNumber(int nNumber);
 	const int GetMaxRuleNumber() const;
 
-	// Parametrage du nombre de regles voulu en sortie
+	// Parametrage du temps alloue a l'extraction des regles, en secondes (0: pas de limite)
+	// Le temps est controle y compris pendant l'optimisation d'une regle: une fois depasse,
+	// les regles deja extraites sont conservees et le nombre de relances achevees est signale
 	void SetTimeAllowed(int nNumber);
 	const int GetTimeAllowed() const;
 
+	// Parametrage de la taille de l'echantillon stratifie par classe sur lequel sont optimisees les bornes
+	// des attributs numeriques (0: toutes les instances, -1: taille automatique; defaut: 0)
+	// Les bornes retenues sont affinees sur toutes les instances, dans la cellule de la grille de l'echantillon
+	// qui les entoure, et les regles sont evaluees sur toutes les instances
+	// Utilise en classification uniquement; a parametrer avant le pretraitement
+	void SetOptimizationSampleSize(int nValue);
+	int GetOptimizationSampleSize() const;
+
+	// Parametrage de la granularite des bornes candidates des attributs numeriques (0: toutes les valeurs; defaut: 0)
+	// Si elle est non nulle, les bornes ne sont recherchees qu'entre les intervalles de la discretisation univariee
+	// de l'attribut (cf. KWClassStats), redecoupee en intervalles de frequence au plus egale au nombre d'instances
+	// divise par la granularite (cf. KRPreprocessedContinuousAttribute::InitializeCandidateIntervals)
+	// A parametrer avant le pretraitement
+	void SetBoundaryCandidateGranularity(int nValue);
+	int GetBoundaryCandidateGranularity() const;
+
+	// Parametrage de l'initialisation des regles a partir des partitions univariees (defaut: false)
+	// Le corps initial de chaque attribut est alors la partie de la partition univariee de l'attribut
+	// (cf. KWClassStats) contenant l'objet de reference, etendue au hasard a des parties voisines pour
+	// la diversite des relances; sinon, les bornes et les groupes de valeurs sont tires au hasard
+	void SetUnivariateInitialization(boolean bValue);
+	boolean GetUnivariateInitialization() const;
+
+	// Parametrage du repertoire du cache des ordres de tri du pretraitement (vide: pas de cache; defaut: vide)
+	// Les ordres de tri des attributs sont relus du cache s'ils correspondent a la base, sinon recalcules
+	// puis memorises dans le cache (cf. KRPreprocessingCache)
+	void SetPreprocessingCacheDirectory(const ALString& sValue);
+	const ALString& GetPreprocessingCacheDirectory() const;
+
 	// Parametrage par des statistiques sur le probleme d'apprentissage
 	// Permet l'utilisation des statistiques univariees pour optimiser les regles
 	// Memoire: les specifications sont referencees et destinee a etre partagees
@@ -57,18 +91,24 @@ public:
 	KRPreprocessedAttribute* LookUpPreprocessedAttribute(const ALString& sName) const;
 
 	//Initialisation des compteurs d'objets a partir d'une regle initialisee
-	void InitializeObjectsCounters(KWDatabase* kwdb, KRRule* rule);
+	// Appele uniquement en debut d'optimisation d'une regle: les compteurs sont ensuite
+	// tenus a jour lors de chaque modification du corps d'un attribut
+	void InitializeObjectsCounters(KRRule* rule);
 
 	// verification de la coherence des compteurs avec une regle
-	boolean CheckObjectCounters(KWDatabase* kwdb, KRRule* rule);
+	boolean CheckObjectCounters(KRRule* rule);
 
 	// Algorithme d'extraction de regles MODL Bayes-optimales
 	// En sortie, on obtient un tableau de KRRules optimisees
 	// voir les details de l'algorithme dans le rapport/article
-	void OptimizeRuleSet(KWDatabase* kwdb, ObjectArray* oaRuleSet);
+	void OptimizeRuleSet(ObjectArray* oaRuleSet);
 
 	// Initialisation/Pretraitement des structures necessaires a l'optimisation
-	void Preprocess(KWDatabase* kwdb);
+	// La base est lue en une seule passe, chaque objet etant detruit des que les valeurs de ses attributs
+	// sont memorisees par rang (cf. KRAttributeColumn): l'optimisation n'exploite ensuite que les attributs
+	// pretraites, sans objet en memoire
+	// Renvoie false en cas d'erreur de lecture ou d'interruption utilisateur
+	boolean Preprocess(KWDatabase* kwdb);
 
 	// Affichage des donnees de pretraitement
 	void WritePreprocessing(ostream& ost);
@@ -81,81 +121,218 @@ protected:
 	// Selection aleatoire d'un sous-ensemble de min(numberOfAttributes , log2(numberOfObjects) + 1)
 	// d'indices d'attributs
 	// Utilise pour l'optimisation d'une regle dont le corps est construit sur ces attributs
-	void RandomAttributeSubsetSelection(KWDatabase* kwdb, ObjectArray* oaAttributes);
+	void RandomAttributeSubsetSelection(ObjectArray* oaAttributes);
 
 	// Initialisation d'une regle a partir d'un sous-ensemble d'attributs
-	// et qui couvre un objet de la base. Le level de la regle est renvoye
-	double InitializeRule(KWDatabase* kwdb,
-		ObjectArray* oaAttributes,
-		KWObject* kwoInBody,
+	// et qui couvre un objet de la base, designe par son rang. Le level de la regle est renvoye
+	double InitializeRule(ObjectArray* oaAttributes,
+		int nInBodyObjectRank,
 		KRRule* krrInitRule);
-	void InitAttributeIntervals(KWDatabase* database, KWObject* kwoRandomObject, KWAttribute* kwaAttribute, KRRAttribute* krrAttribute);
-	void InitAttributeValueSets(KWDatabase* database, KWObject* kwoRandomObject, KWAttribute* kwaAttribute, KRRAttribute* krrAttribute);
+	void InitAttributeIntervals(int nRandomObjectRank, KWAttribute* kwaAttribute, KRRAttribute* krrAttribute);
+	void InitAttributeValueSets(int nRandomObjectRank, KWAttribute* kwaAttribute, KRRAttribute* krrAttribute);
+
+	// Initialisation des intervalles d'un attribut a partir de sa discretisation univariee (cf. SetUnivariateInitialization)
+	// Renvoie false, sans modifier l'attribut, si la discretisation n'est pas disponible ou si la valeur est manquante
+	boolean InitAttributeIntervalsFromUnivariatePartition(KRPreprocessedContinuousAttribute* krpcaAttribute,
+		Continuous cRandomObjectValue, KRRAttribute* krrAttribute);
 
 	// Mise a jour des statistiques
 	// Mise a jour totale/globale de la regle
-	void UpdateAllStatistics(KWDatabase* database, KRRule* krrInitRule);
-	// Mise a jour seulement sur la sous base construite
-	void UpdateSubStatistics(ObjectArray* oaWorkingInstances, KRRule* krrInitRule);
-	// Mise a jour de la partie corps et exterieur
-	void UpdateBodyStatistics(KWDatabase* database, KRRule* krrInitRule, IntVector* ivTargetValuesFrequencyDiff);
+	void UpdateAllStatistics(KRRule* krrInitRule);
+	// Mise a jour seulement sur la sous base construite, donnee par les rangs de ses objets
+	void UpdateSubStatistics(const IntVector* ivWorkingObjectRanks, KRRule* krrInitRule);
+	// Mise a jour de la partie corps et exterieur, a partir des differentielles d'effectifs par classe
+	// des instances entrant (positives) ou sortant (negatives) du corps, en O(J)
+	// Les bornes ou groupes de valeurs de la regle doivent deja etre positionnes
+	void UpdateBodyStatistics(KRRule* krrInitRule, IntVector* ivTargetValuesFrequencyDiff);
+	// Mise a jour des couts lors d'un changement de structure (nombre de parties), effectifs du corps inchanges
+	void UpdateStructureStatistics(KRRule* krrInitRule);
+	// Verification des effectifs du corps par parcours complet de la base (classification uniquement)
+	boolean CheckBodyStatistics(KRRule* krrInitRule);
 	// Mise a jour de la partie locale attribut en cours d'optimisation (lorsque le nb de parties change)
-	void UpdateAttributeStatistics(KWDatabase* database, KRRule* krrInitRule, KRRAttribute* attribute);
+	void UpdateAttributeStatistics(KRRule* krrInitRule, KRRAttribute* attribute);
 	// Mise a jour de la partie locale Rule (lorsque le nombre d'attributs change)
-	void UpdateRuleStatistics(KWDatabase* database, KRRule* krrInitRule);
+	void UpdateRuleStatistics(KRRule* krrInitRule);
+
+	double ComputeRuleLevel(KRRule* krrInitRule);
 
-	double ComputeRuleLevel(KWDatabase* database, KRRule* krrInitRule);
+	// Plan de couverture de la regle en cours d'optimisation, conserve d'un appel a l'autre et synchronise
+	// avec la regle: il n'est recompile qu'en cas de changement de regle ou de ses attributs
+	KRRuleCoveragePlan* GetRuleCoveragePlan(const KRRule* rule);
 
 	// Services temproraires
-	boolean IsInBody(KWObject* kwoOject, KRRule* rule);
+	boolean IsInBody(int nObjectRank, KRRule* rule);
+
+	// Index de la valeur cible d'un objet de rang donne (classe ou partie de l'attribut cible en regression)
+	int ComputeObjectTargetIndex(int nObjectRank, KRRule* rule) const;
+
+	// Lecture de la base objet par objet, avec memorisation des valeurs de chaque objet dans un tableau
+	// de colonnes (KRAttributeColumn) puis destruction de l'objet; le rang d'un objet est son index de lecture
+	// Renvoie false en cas d'erreur de lecture, d'interruption, ou si le nombre d'objets depasse INT_MAX
+	boolean ReadDatabaseColumns(KWDatabase* kwdb, ObjectArray* oaColumns, int& nObjectNumber);
+
+	// Pretraitement d'un attribut a partir de son ordre de tri memorise dans le cache, s'il est valide
+	// Renvoie true si l'ordre de tri du cache a ete utilise, false si l'attribut reste a trier
+	// La colonne des valeurs de l'attribut et le cache ne sont pas modifies
+	boolean PreprocessAttributeFromCache(const KRAttributeColumn* column, KRPreprocessedAttribute* krpaAttribute,
+					     const KRPreprocessingCache* preprocessingCache);
+
+	// Calcul par rang d'objet des codes des classes cibles (classification), a partir de la colonne
+	// de l'attribut cible, ou des rangs des valeurs cibles parmi les valeurs distinctes (regression,
+	// a partir de l'attribut cible pretraite, sans colonne), et construction des bitmaps de tous les objets
+	// et de chaque classe cible
+	void BuildObjectTargetCodes(const KRAttributeColumn* targetColumn);
+
+	// Construction de l'echantillon stratifie par classe cible (cf. SetOptimizationSampleSize)
+	void BuildStratifiedSample();
+
+	// Indique si les bornes des attributs numeriques d'une regle sont optimisees sur l'echantillon
+	boolean IsSampleOptimizationUsed(const KRRule* rule) const;
+
+	// Effectif estime sur toutes les instances d'une classe, a partir de son effectif dans l'echantillon
+	int EstimateTargetFrequency(int nTarget, int nSampleFrequency) const;
+
+	// Increment de l'effectif d'une classe lors de l'entree dans le corps d'une instance de travail de la classe:
+	// 1 sur toutes les instances, difference d'effectifs estimes lors d'une optimisation sur l'echantillon,
+	// les effectifs de l'echantillon entres dans le corps etant alors tenus a jour
+	int ComputeFrequencyIncrement(int nTarget, IntVector* ivSampleFrequencies) const;
+
+	// Affinage sur toutes les instances des bornes d'un attribut numerique optimisees sur l'echantillon:
+	// chaque borne est deplacee au mieux entre les deux valeurs de l'echantillon qui l'entourent
+	void RefineContinuousAttributeBounds(KRRAttribute* krrAttribute, int nInBodyObjectRank,
+		KRRule* krrCurrentRule);
+
+	// Index de la partie de l'attribut cible de la regle pour chaque rang de valeur cible (regression)
+	void ComputeTargetRankPartIndexes(KRRule* rule, IntVector* ivTargetRankPartIndexes) const;
+
+	// Differentielle des effectifs par classe entre le corps courant et un corps couvrant les valeurs distinctes
+	// d'index nFirstGroup a nLastGroup, calculee a partir des effectifs cumules par valeur (une ligne par valeur)
+	void ComputeGroupRangeFrequencyDiff(KRRule* rule, const IntVector* ivCumulatedFrequencies,
+		int nFirstGroup, int nLastGroup, IntVector* ivTargetValuesFrequencyDiff) const;
+
+	// Differentielle des effectifs par classe (+1 ou -1 par objet selon nDelta) des objets d'une valeur symbolique
+	// dont le compteur de corps vaut nBodyCount, obtenue par parcours de la plage d'index de la valeur
+	void ComputeSymbolValueFrequencyDiff(KRPreprocessedSymbolAttribute* krpsaAttribute, Symbol sValue,
+		int nBodyCount, int nDelta, KRRule* rule, IntVector* ivTargetValuesFrequencyDiff);
+
+	// Mise a jour des compteurs d'objets suite a la modification du corps d'un attribut numerique,
+	// a partir des bornes du corps initial (sans borne inf si le corps est la premiere partie)
+	// Seuls les objets situes entre les anciennes et les nouvelles bornes sont parcourus
+	void UpdateContinuousObjectsCounters(KRRAttribute* krrAttribute, boolean bInitialWithLowerBound,
+		Continuous cInitialLowerBound, Continuous cInitialUpperBound);
+
+	// Deplacement d'une valeur symbolique d'un attribut a deux parties vers l'exterieur (ou l'interieur) du corps,
+	// accepte uniquement s'il ameliore strictement le level minimal donne, a partir de la differentielle
+	// d'effectifs par classe du deplacement
+	// Renvoie le level de la regle si le deplacement est accepte, le level minimal sinon
+	double TrySymbolValueMove(KRRule* krrCurrentRule, KRRAttribute* krrAttribute,
+		KRPreprocessedSymbolAttribute* krpsaAttribute, Symbol sValue, boolean bToOutBody,
+		double dMinLevel, IntVector* ivTargetValuesFrequencyDiff);
+
+	// Mise a jour des compteurs des objets d'une valeur symbolique entrant (+1) ou sortant (-1) du corps
+	void UpdateSymbolValueObjectsCounters(KRPreprocessedSymbolAttribute* krpsaAttribute, Symbol sValue, int nDelta);
+
+	// Retrait des compteurs d'objets de la contribution des attributs non informatifs, avant leur destruction
+	void RemoveNonInformativeAttributesFromCounters(KRRule* rule);
 
 	// Optimisation d'un attribut de la regle. La regle appelee est la regle optimisee en sortie.
 	// Le level de la regle optimisee est renvoye
-	double OptimizeRuleAttribute(KWDatabase* kwdb,
-		KRRAttribute* krrAttribute,
-		KWObject* kwoInBody,
-		KRRule* krrCurrentRule);
+	// Les instances de travail de l'attribut sur toutes les instances (cf. PrepareWorkingInstances) sont fournies
+	// par l'appelant; elles ne sont exploitees que pour un attribut numerique optimise hors echantillon
+	double OptimizeRuleAttribute(KRRAttribute* krrAttribute,
+		int nInBodyObjectRank,
+		KRRule* krrCurrentRule,
+		const IntVector* ivAllWorkingInstances);
 
 	// Optimisation d'un attribut numrique
-	double OptimizeContinuousAttribute(KWDatabase* kwdb,
-		KRRAttribute* krrAttribute,
-		KWObject* kwoInBody,
-		KRRule* krrCurrentRule);
+	double OptimizeContinuousAttribute(KRRAttribute* krrAttribute,
+		int nInBodyObjectRank,
+		KRRule* krrCurrentRule,
+		const IntVector* ivAllWorkingInstances);
 
 	// Attribut numrique  2 parties
-	void Optimize2PartsContinuousAttribute(KWDatabase* kwdb,
-		KRRAttribute* krrAttribute,
-		KWObject* kwoInBody,
-		KRRule* krrCurrentRule);
+	void Optimize2PartsContinuousAttribute(KRRAttribute* krrAttribute,
+		int nInBodyObjectRank,
+		KRRule* krrCurrentRule,
+		const IntVector* ivAllWorkingInstances);
 
 	// Attribut numrique  3 parties
-	void Optimize3PartsContinuousAttribute(KWDatabase* kwdb,
-		KRRAttribute* krrAttribute,
-		KWObject* kwoInBody,
-		KRRule* krrCurrentRule);
+	void Optimize3PartsContinuousAttribute(KRRAttribute* krrAttribute,
+		int nInBodyObjectRank,
+		KRRule* krrCurrentRule,
+		const IntVector* ivAllWorkingInstances);
 
 	// Attribut categoriel
-	double OptimizeSymbolAttribute(KWDatabase* kwdb,
-		KRRAttribute* krrAttribute,
-		KWObject* kwoInBody,
+	double OptimizeSymbolAttribute(KRRAttribute* krrAttribute,
+		int nInBodyObjectRank,
 		KRRule* krrCurrentRule);
 	// changement de partie pour un valeur symbolique
 	void ChangeValuePart(Symbol sValue,
 		KRRPart* krrpOrigin, KRRPart* krrpDestination) const;
 
+	// Majorant optimiste du level atteignable par l'optimisation d'un attribut de la regle (cf. KRRuleCosts),
+	// a partir des effectifs par classe de ses instances de travail sur toutes les instances
+	double ComputeAttributeLevelUpperBound(KRRAttribute* krrAttribute, KRRule* krrCurrentRule,
+		const IntVector* ivWorkingInstances);
+
 	// Optimisation d'uen regle. La regle appelee est laregle optimisee en sortie
+	// L'optimisation s'arrete des que la regle atteint le corps d'une regle deja extraite
+	// L'optimisation d'un attribut est elaguee si son majorant optimiste ne depasse pas le seuil de conservation
+	// des regles, et la relance est abandonnee si tous les attributs d'une passe sont elagues
 	// Le level de la regle optimisee est renvoye
-	double OptimizeRule(KWDatabase* kwdb, KWObject* kwoInBody, KRRule* krrCurrentRule);
+	double OptimizeRule(int nInBodyObjectRank, KRRule* krrCurrentRule);
+
+	// Relance aleatoire: initialisation d'une regle a partir d'un objet et d'attributs tires au hasard,
+	// puis optimisation de la regle, renvoyee en sortie (a detruire par l'appelant)
+	KRRule* MineRandomRule();
+
+	// Test de depassement du temps alloue a l'extraction des regles
+	boolean IsMiningTimeExhausted();
 
 	//Attributs
 	int nMaxRuleNumber; // par defaut 10
 	int nTimeAllowed; // par defaut 600
+	Timer tMiningTimer;
+	boolean bMiningTimeExhausted;
+	// Regles deja extraites, indexees par la cle canonique de leur corps (cf. KRRule::ComputeBodyKey)
+	ObjectDictionary odMinedRuleBodies;
+	// Nombre de relances abandonnees par elagage
+	int nPrunedRestartNumber;
+	int nOptimizationSampleSize; // par defaut 0
+	int nBoundaryCandidateGranularity; // par defaut 0
+	boolean bUnivariateInitialization; // par defaut false
+	// Nombre total de boucles d'optimisation et nombre de regles optimisees, pour le suivi de la convergence
+	int nOptimizationLoopNumber;
+	int nOptimizedRuleNumber;
+	ALString sPreprocessingCacheDirectory;
+	// Echantillon stratifie: bitmap des rangs des objets (vide si pas d'echantillon),
+	// effectifs par classe dans l'echantillon et sur toutes les instances
+	KRCoverageBitmap bmSampleObjects;
+	IntVector ivSampleTargetFrequencies;
+	IntVector ivTargetFrequencies;
+	// Optimisation en cours sur l'echantillon, les effectifs du corps de la regle etant alors estimes
+	boolean bSampleSweep;
 	KWClassStats* classStats;
 	KRRuleCosts* ruleCosts;
 	ObjectArray oaPreprocessedAttributes;
 	ObjectDictionary odPreprocessedAttributes;
 	boolean bIsIndexed;
 	KRObjectCounters krocCounters;
+	// Pool des valeurs des regles en cours d'optimisation, recyclees d'une relance a l'autre
+	// Les regles conservees en sont recopiees, afin de ne pas dependre du pool
+	KRRValuePool krvpValuePool;
+	// Index de la classe cible de chaque objet, par rang d'objet (classification uniquement)
+	IntVector ivObjectTargetCodes;
+	// Rang de la valeur cible de chaque objet parmi les valeurs cibles distinctes, par rang d'objet,
+	// et valeurs cibles distinctes triees (regression uniquement)
+	IntVector ivObjectTargetRanks;
+	ContinuousVector cvTargetValues;
+	// Bitmap des rangs de tous les objets de la base, et bitmaps des rangs des objets de chaque classe
+	// cible (KRCoverageBitmap, classification uniquement), pour le calcul des effectifs du corps
+	KRCoverageBitmap bmAllObjects;
+	ObjectArray oaTargetClassBitmaps;
+	// Plan de couverture de la regle en cours d'optimisation (cf. GetRuleCoveragePlan)
+	KRRuleCoveragePlan rulePlan;
 	double dEpsilon;
 };
 
@@ -20,6 +20,9 @@ KRRuleParameters::KRRuleParameters()
     nRuleOptimizationLoops = 0;
     nContinuousOptimizationLoops = 0;
     nSymbolOptimizationLoops = 0;
+    nOptimizationSampleSize = 0;
+    nBoundaryCandidateGranularity = 0;
+    bUnivariateInitialization = false;
 
     //## Custom constructor
 
@@ -49,6 +52,10 @@ void KRRuleParameters::CopyFrom(const KRRuleParameters* aSource)
     nRuleOptimizationLoops = aSource->nRuleOptimizationLoops;
     nContinuousOptimizationLoops = aSource->nContinuousOptimizationLoops;
     nSymbolOptimizationLoops = aSource->nSymbolOptimizationLoops;
+    nOptimizationSampleSize = aSource->nOptimizationSampleSize;
+    nBoundaryCandidateGranularity = aSource->nBoundaryCandidateGranularity;
+    bUnivariateInitialization = aSource->bUnivariateInitialization;
+    sPreprocessingCacheDirectory = aSource->sPreprocessingCacheDirectory;
     sSubPredictor = aSource->sSubPredictor;
 
     //## Custom copyfrom
@@ -80,6 +87,10 @@ void KRRuleParameters::Write(ostream& ost) const
     ost << "Number of optimization loops over the attributes of the rule\t" << GetRuleOptimizationLoops() << "\n";
     ost << "Number of optimization loops over a continuous attribute\t" << GetContinuousOptimizationLoops() << "\n";
     ost << "Number of optimization loops over a categorical attribute\t" << GetSymbolOptimizationLoops() << "\n";
+    ost << "Sample size for rule optimization\t" << GetOptimizationSampleSize() << "\n";
+    ost << "Granularity of numerical boundary candidates\t" << GetBoundaryCandidateGranularity() << "\n";
+    ost << "Initialization of rules from univariate partitions\t" << BooleanToString(GetUnivariateInitialization()) << "\n";
+    ost << "Preprocessing cache directory\t" << GetPreprocessingCacheDirectory() << "\n";
     ost << "End predictor\t" << GetSubPredictor() << "\n";
 }
 
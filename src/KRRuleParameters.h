@@ -66,6 +66,22 @@ public:
     int GetSymbolOptimizationLoops() const;
     void SetSymbolOptimizationLoops(int nValue);
 
+    // Sample size for rule optimization
+    int GetOptimizationSampleSize() const;
+    void SetOptimizationSampleSize(int nValue);
+
+    // Granularity of numerical boundary candidates
+    int GetBoundaryCandidateGranularity() const;
+    void SetBoundaryCandidateGranularity(int nValue);
+
+    // Initialization of rules from univariate partitions
+    boolean GetUnivariateInitialization() const;
+    void SetUnivariateInitialization(boolean bValue);
+
+    // Preprocessing cache directory
+    const ALString& GetPreprocessingCacheDirectory() const;
+    void SetPreprocessingCacheDirectory(const ALString& sValue);
+
     // End predictor
     const ALString& GetSubPredictor() const;
     void SetSubPredictor(const ALString& sValue);
@@ -97,6 +113,10 @@ protected:
     int nRuleOptimizationLoops;
     int nContinuousOptimizationLoops;
     int nSymbolOptimizationLoops;
+    int nOptimizationSampleSize;
+    int nBoundaryCandidateGranularity;
+    boolean bUnivariateInitialization;
+    ALString sPreprocessingCacheDirectory;
     ALString sSubPredictor;
 
     //## Custom implementation
@@ -181,6 +201,46 @@ inline void KRRuleParameters::SetSymbolOptimizationLoops(int nValue)
     nSymbolOptimizationLoops = nValue;
 }
 
+inline int KRRuleParameters::GetOptimizationSampleSize() const
+{
+    return nOptimizationSampleSize;
+}
+
+inline void KRRuleParameters::SetOptimizationSampleSize(int nValue)
+{
+    nOptimizationSampleSize = nValue;
+}
+
+inline int KRRuleParameters::GetBoundaryCandidateGranularity() const
+{
+    return nBoundaryCandidateGranularity;
+}
+
+inline void KRRuleParameters::SetBoundaryCandidateGranularity(int nValue)
+{
+    nBoundaryCandidateGranularity = nValue;
+}
+
+inline boolean KRRuleParameters::GetUnivariateInitialization() const
+{
+    return bUnivariateInitialization;
+}
+
+inline void KRRuleParameters::SetUnivariateInitialization(boolean bValue)
+{
+    bUnivariateInitialization = bValue;
+}
+
+inline const ALString& KRRuleParameters::GetPreprocessingCacheDirectory() const
+{
+    return sPreprocessingCacheDirectory;
+}
+
+inline void KRRuleParameters::SetPreprocessingCacheDirectory(const ALString& sValue)
+{
+    sPreprocessingCacheDirectory = sValue;
+}
+
 inline const ALString& KRRuleParameters::GetSubPredictor() const
 {
     return sSubPredictor;
@@ -20,6 +20,10 @@ KRRuleParametersView::KRRuleParametersView()
 	AddIntField("RuleOptimizationLoops", "Number of optimization loops over the attributes of the rule", 0);
 	AddIntField("ContinuousOptimizationLoops", "Number of optimization loops over a continuous attribute", 0);
 	AddIntField("SymbolOptimizationLoops", "Number of optimization loops over a categorical attribute", 0);
+	AddIntField("OptimizationSampleSize", "Sample size for rule optimization", 0);
+	AddIntField("BoundaryCandidateGranularity", "Granularity of numerical boundary candidates", 0);
+	AddBooleanField("UnivariateInitialization", "Initialization of rules from univariate partitions", false);
+	AddStringField("PreprocessingCacheDirectory", "Preprocessing cache directory", "");
 	AddStringField("SubPredictor", "End predictor", "");
 
 	// Parametrage des styles;
@@ -30,17 +34,34 @@ KRRuleParametersView::KRRuleParametersView()
 	GetFieldAt("RuleOptimizationLoops")->SetStyle("Spinner");
 	GetFieldAt("ContinuousOptimizationLoops")->SetStyle("Spinner");
 	GetFieldAt("SymbolOptimizationLoops")->SetStyle("Spinner");
+	GetFieldAt("OptimizationSampleSize")->SetStyle("Spinner");
+	GetFieldAt("BoundaryCandidateGranularity")->SetStyle("Spinner");
+	GetFieldAt("UnivariateInitialization")->SetStyle("CheckBox");
+	GetFieldAt("PreprocessingCacheDirectory")->SetStyle("DirectoryChooser");
 	GetFieldAt("SubPredictor")->SetStyle("ComboBox");
 
 	//## Custom constructor
 
 	// Parametrage avance des styles
 	cast(UIIntElement*, GetFieldAt("TimeAllowed"))->SetMinValue(0);
+	cast(UIIntElement*, GetFieldAt("OptimizationSampleSize"))->SetMinValue(-1);
+	cast(UIIntElement*, GetFieldAt("BoundaryCandidateGranularity"))->SetMinValue(0);
 	GetFieldAt("SubPredictor")->SetParameters("SNB\nNB\nBU");
 
 	// Info-bulles
 	GetFieldAt("MaxRuleNumber")->SetHelpText("Max number of rules to build\n"
 						 "New line");
+	GetFieldAt("OptimizationSampleSize")->SetHelpText("Size of the stratified sample used to optimize the numerical bounds of the rules\n"
+							  "0: all instances, -1: automatic size\n"
+							  "The bounds are refined and the rules are evaluated on all instances");
+	GetFieldAt("BoundaryCandidateGranularity")->SetHelpText("Number of equal frequency sub-intervals used to refine the univariate discretizations\n"
+								"of the numerical variables: the bounds of the rules are searched among their cut points only\n"
+								"0: all the values are candidate bounds");
+	GetFieldAt("UnivariateInitialization")->SetHelpText("Each variable of a rule starts from the part of its univariate partition\n"
+							    "that contains the seed instance, randomly extended to neighbouring parts,\n"
+							    "instead of random bounds and value groups");
+	GetFieldAt("PreprocessingCacheDirectory")->SetHelpText("Directory where the sort orders of the preprocessed variables are kept\n"
+							       "between trainings on the same data file and dictionary (empty: no cache)");
 
 	// Inactivation des parametres non utilises
 	/*DDD MB
@@ -76,6 +97,10 @@ void KRRuleParametersView::EventUpdate(Object* object)
 	editedObject->SetRuleOptimizationLoops(GetIntValueAt("RuleOptimizationLoops"));
 	editedObject->SetContinuousOptimizationLoops(GetIntValueAt("ContinuousOptimizationLoops"));
 	editedObject->SetSymbolOptimizationLoops(GetIntValueAt("SymbolOptimizationLoops"));
+	editedObject->SetOptimizationSampleSize(GetIntValueAt("OptimizationSampleSize"));
+	editedObject->SetBoundaryCandidateGranularity(GetIntValueAt("BoundaryCandidateGranularity"));
+	editedObject->SetUnivariateInitialization(GetBooleanValueAt("UnivariateInitialization"));
+	editedObject->SetPreprocessingCacheDirectory(GetStringValueAt("PreprocessingCacheDirectory"));
 	editedObject->SetSubPredictor(GetStringValueAt("SubPredictor"));
 
 	//## Custom update
@@ -97,6 +122,10 @@ void KRRuleParametersView::EventRefresh(Object* object)
 	SetIntValueAt("RuleOptimizationLoops", editedObject->GetRuleOptimizationLoops());
 	SetIntValueAt("ContinuousOptimizationLoops", editedObject->GetContinuousOptimizationLoops());
 	SetIntValueAt("SymbolOptimizationLoops", editedObject->GetSymbolOptimizationLoops());
+	SetIntValueAt("OptimizationSampleSize", editedObject->GetOptimizationSampleSize());
+	SetIntValueAt("BoundaryCandidateGranularity", editedObject->GetBoundaryCandidateGranularity());
+	SetBooleanValueAt("UnivariateInitialization", editedObject->GetUnivariateInitialization());
+	SetStringValueAt("PreprocessingCacheDirectory", editedObject->GetPreprocessingCacheDirectory());
 	SetStringValueAt("SubPredictor", editedObject->GetSubPredictor());
 
 	//## Custom refresh
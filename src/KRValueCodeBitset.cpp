@@ -0,0 +1,77 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#include "KRValueCodeBitset.h"
+
+KRValueCodeBitset::KRValueCodeBitset()
+{
+	puiWords = NULL;
+	nWordNumber = 0;
+	nSize = 0;
+}
+
+KRValueCodeBitset::~KRValueCodeBitset()
+{
+	if (puiWords != NULL)
+		delete[] puiWords;
+}
+
+void KRValueCodeBitset::SetSize(int nValue)
+{
+	require(nValue >= 0);
+
+	// Reallocation des mots de bits
+	if (puiWords != NULL)
+		delete[] puiWords;
+	puiWords = NULL;
+	nSize = nValue;
+	nWordNumber = (nSize + nWordBitNumber - 1) / nWordBitNumber;
+	if (nWordNumber > 0)
+		puiWords = new unsigned int[nWordNumber];
+	Reset();
+}
+
+int KRValueCodeBitset::GetSize() const
+{
+	return nSize;
+}
+
+void KRValueCodeBitset::Reset()
+{
+	if (nWordNumber > 0)
+		memset(puiWords, 0, nWordNumber * sizeof(unsigned int));
+}
+
+void KRValueCodeBitset::CopyFrom(const KRValueCodeBitset* aSource)
+{
+	require(aSource != NULL);
+
+	if (nSize != aSource->nSize)
+		SetSize(aSource->nSize);
+	if (nWordNumber > 0)
+		memcpy(puiWords, aSource->puiWords, nWordNumber * sizeof(unsigned int));
+}
+
+boolean KRValueCodeBitset::Equals(const KRValueCodeBitset* aSource) const
+{
+	require(aSource != NULL);
+
+	if (nSize != aSource->nSize)
+		return false;
+	return nWordNumber == 0 or memcmp(puiWords, aSource->puiWords, nWordNumber * sizeof(unsigned int)) == 0;
+}
+
+int KRValueCodeBitset::GetCount() const
+{
+	int nCount;
+	int nCode;
+
+	nCount = 0;
+	for (nCode = 0; nCode < nSize; nCode++)
+	{
+		if (Contains(nCode))
+			nCount++;
+	}
+	return nCount;
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2023-2025 Orange. All rights reserved.
+// This software is distributed under the BSD 3-Clause-clear License, the text of which is available
+// at https://spdx.org/licenses/BSD-3-Clause-Clear.html or see the "LICENSE" file for more details.
+
+#ifndef KRVALUECODEBITSET_H
+#define KRVALUECODEBITSET_H
+
+#include "Object.h"
+
+////////////////////////////////////////////////////////////////////
+// Classe KRValueCodeBitset
+// Ensemble de codes de valeurs (entiers de 0 a GetSize()-1), memorise sous forme de bits
+// Test d'appartenance et modification en O(1), sans allocation
+class KRValueCodeBitset : public Object
+{
+public:
+	// Constructeur
+	KRValueCodeBitset();
+	~KRValueCodeBitset();
+
+	// Nombre de codes possibles; l'ensemble est vide apres retaillage
+	void SetSize(int nValue);
+	int GetSize() const;
+
+	// Vidage de l'ensemble
+	void Reset();
+
+	// Copie d'un ensemble, avec sa taille
+	void CopyFrom(const KRValueCodeBitset* aSource);
+
+	// Test d'egalite avec un ensemble (meme taille et memes codes)
+	boolean Equals(const KRValueCodeBitset* aSource) const;
+
+	// Ajout, suppression, inversion et test d'un code
+	void Add(int nCode);
+	void Remove(int nCode);
+	void Flip(int nCode);
+	boolean Contains(int nCode) const;
+
+	// Nombre de codes presents
+	int GetCount() const;
+
+	///////////////////////////////////////////////////////
+	///// Implementation
+protected:
+	// Nombre de bits par mot
+	static const int nWordBitNumber = 32;
+
+	// Mots de bits, et nombre de codes
+	unsigned int* puiWords;
+	int nWordNumber;
+	int nSize;
+};
+
+///// Methode en inline
+
+inline void KRValueCodeBitset::Add(int nCode)
+{
+	require(0 <= nCode and nCode < nSize);
+	puiWords[nCode / nWordBitNumber] |= (1u << (nCode % nWordBitNumber));
+}
+
+inline void KRValueCodeBitset::Remove(int nCode)
+{
+	require(0 <= nCode and nCode < nSize);
+	puiWords[nCode / nWordBitNumber] &= ~(1u << (nCode % nWordBitNumber));
+}
+
+inline void KRValueCodeBitset::Flip(int nCode)
+{
+	require(0 <= nCode and nCode < nSize);
+	puiWords[nCode / nWordBitNumber] ^= (1u << (nCode % nWordBitNumber));
+}
+
+inline boolean KRValueCodeBitset::Contains(int nCode) const
+{
+	require(0 <= nCode and nCode < nSize);
+	return (puiWords[nCode / nWordBitNumber] & (1u << (nCode % nWordBitNumber))) != 0;
+}
+
+#endif // KRVALUECODEBITSET_H